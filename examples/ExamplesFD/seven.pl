@@ -0,0 +1,46 @@
+/*-------------------------------------------------------------------------*/
+/* Benchmark (Finite Domain)                                               */
+/*                                                                         */
+/* Name           : seven.pl                                               */
+/* Title          : the 7-11 problem                                       */
+/* Original Source: classical puzzle                                       */
+/*                                                                         */
+/* A customer buys 4 items in a 7-11 store. The cashier multiplies the     */
+/* prices (instead of adding them) and asks for $7.11. The customer        */
+/* notices the error but, adding the prices, the total is also $7.11.      */
+/* Find the prices (in cents, A =< B =< C =< D).                           */
+/*                                                                         */
+/* This exercises the propagation of nonlinear products on large domains. */
+/*                                                                         */
+/* Solution:                                                               */
+/*  [A,B,C,D]                                                              */
+/*  [120,125,150,316]                                                      */
+/*-------------------------------------------------------------------------*/
+
+q :-
+	statistics(runtime, _),
+	seven(L),
+	statistics(runtime, [_, Y]),
+	write(L),
+	nl,
+	write('time : '),
+	write(Y),
+	nl.
+
+
+
+
+seven(L) :-
+	L = [A, B, C, D],
+	fd_domain(L, 1, 711),
+	A + B + C + D #= 711,
+	A * B * C * D #= 711000000,
+	A #=< B,
+	B #=< C,
+	C #=< D,
+	fd_labelingff(L).
+
+
+
+
+:-	initialization(q).
@@ -0,0 +1,83 @@
+% call/N microbenchmark
+%
+%   call_n
+%
+%   Throughput of meta-calls: call/1, call/2 and call/3 with closures
+%   only known at run-time (monomorphic and polymorphic call sites).
+
+
+call_n(ShowResult) :-
+	Closures = [inc, add(2), add3(1, 2)],
+	loop1(100000, 0, R1),
+	loop2(100000, non_neg, 0, R2),
+	loop3(100000, add(3), 0, R3),
+	loop_poly(Closures, 30000, 0, R4),
+	(   ShowResult = true ->
+	    write(call_n(R1, R2, R3, R4)), nl
+	;   true).
+
+
+loop1(0, R, R) :-
+	!.
+
+loop1(N, R0, R) :-
+	call(true),
+	call(inc(R0, R1)),
+	N1 is N - 1,
+	loop1(N1, R1, R).
+
+
+loop2(0, _, R, R) :-
+	!.
+
+loop2(N, G, R0, R) :-
+	call(G, R0),
+	R1 is R0 + 1,
+	N1 is N - 1,
+	loop2(N1, G, R1, R).
+
+
+loop3(0, _, R, R) :-
+	!.
+
+loop3(N, G, R0, R) :-
+	call(G, R0, R1),
+	N1 is N - 1,
+	loop3(N1, G, R1, R).
+
+
+loop_poly(_, 0, R, R) :-
+	!.
+
+loop_poly(Gs, N, R0, R) :-
+	apply_all(Gs, R0, R1),
+	N1 is N - 1,
+	loop_poly(Gs, N1, R1, R).
+
+
+apply_all([], R, R).
+
+apply_all([G|Gs], R0, R) :-
+	call(G, R0, R1),
+	apply_all(Gs, R1, R).
+
+
+non_neg(X) :-
+	X >= 0.
+
+inc(X, Y) :-
+	Y is X + 1.
+
+add(K, X, Y) :-
+	Y is X + K.
+
+add3(K1, K2, X, Y) :-
+	Y is X + K1 + K2.
+
+
+% benchmark interface
+
+benchmark(ShowResult) :-
+	call_n(ShowResult).
+
+:- include(common).
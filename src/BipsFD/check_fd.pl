@@ -0,0 +1,274 @@
+/*-------------------------------------------------------------------------*
+ * GNU Prolog                                                              *
+ *                                                                         *
+ * Part  : FD constraint solver buit-in predicates                         *
+ * File  : check_fd.pl                                                     *
+ * Descr.: regression checks (run by make check)                           *
+ *                                                                         *
+ * Copyright (C) 1999-2023 Daniel Diaz                                     *
+ *                                                                         *
+ * This file is part of GNU Prolog                                         *
+ *                                                                         *
+ * GNU Prolog is free software: you can redistribute it and/or             *
+ * modify it under the terms of either:                                    *
+ *                                                                         *
+ *   - the GNU Lesser General Public License as published by the Free      *
+ *     Software Foundation; either version 3 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or                                                                      *
+ *                                                                         *
+ *   - the GNU General Public License as published by the Free             *
+ *     Software Foundation; either version 2 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or both in parallel, as here.                                           *
+ *                                                                         *
+ * GNU Prolog is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ * General Public License for more details.                                *
+ *                                                                         *
+ * You should have received copies of the GNU General Public License and   *
+ * the GNU Lesser General Public License along with this program.  If      *
+ * not, see http://www.gnu.org/licenses/.                                  *
+ *-------------------------------------------------------------------------*/
+
+/* Each check/1 clause must succeed (once). */
+
+:-	initialization(main).
+
+
+
+
+main :-
+	findall(Name, (clause(check(Name), _), \+ run(Name)), Failed),
+	(   Failed = [] ->
+	    halt
+	;   write('FD checks failed: '),
+	    write(Failed),
+	    nl,
+	    halt(1)
+	).
+
+
+run(Name) :-
+	catch(check(Name), E, (write(Name = E), nl, fail)), !.
+
+
+
+
+:-	dynamic(check/1).
+
+	% n-ary linear sums whose bound saturates (fallback to the chain)
+
+check(linear_fresh) :-
+	Y #= X + Z + W + V,
+	fd_domain([X, Z, W, V], 0, 3),
+	fd_labeling([X, Z, W, V]),
+	Y =:= X + Z + W + V.
+
+check(linear_large) :-
+	M is 10 ^ 18,
+	fd_domain([X, Z, W, V], 0, M),
+	Y #= X + Z + W + V,
+	X = M, Z = 1, W = 2, V = 3,
+	Y =:= M + 6.
+
+check(linear_coef) :-
+	Y #= 2000000 * X + 3 * Z + W + V,
+	X = 5, Z = 1, W = 2, V = 3,
+	Y =:= 10000008.
+
+	% errors on labeling options report fd_labeling/2 (not an arithmetic test)
+
+check(labeling_option_culprit) :-
+	catch(fd_labeling([_], [restart(luby(0))]), error(_, fd_labeling / 2), true),
+	catch(fd_labeling([_], [restart(geometric(1, 0.5))]), error(_, fd_labeling / 2), true),
+	catch(fd_labeling([_], [recomputation(0)]), error(_, fd_labeling / 2), true).
+
+	% the limits of fd_minimize_lns/4 apply to a labeling with restarts
+	% (11 pigeons in 10 holes: only stopped by the time limit)
+
+check(lns_restart_limit) :-
+	length(L, 11),
+	fd_domain(L, 1, 10),
+	fd_all_different(L),
+	L = [C|_],
+	real_time(T0),
+	\+ fd_minimize_lns(fd_labeling(L, [restart(luby(50))]), C, L,
+			   [time_limit(100)]),
+	real_time(T1),
+	T1 - T0 < 5000.
+
+	% fd_circuit/1 and fd_subcircuit/1 vs. a labeling-based check of the
+	% successor cycle (exhaustive on random graphs with n =< 6)
+
+check(circuit) :-
+	set_seed(48),
+	\+ ( between(2, 6, N), between(1, 5, _),
+	     random_graph(N, G),
+	     \+ same_solutions(circuit(G), circuit_decomp(G))
+	   ).
+
+check(subcircuit) :-
+	set_seed(48),
+	\+ ( between(1, 6, N), between(1, 5, _),
+	     random_graph(N, G),
+	     \+ same_solutions(subcircuit(G), subcircuit_decomp(G))
+	   ).
+
+	% fd_global_cardinality/3 vs. reified counts (fd_cardinality/2) on
+	% random instances with fixed and FD variable counts
+
+check(global_cardinality) :-
+	set_seed(49),
+	\+ ( between(1, 5, N), between(1, 8, _),
+	     random_gcc(N, Doms, Spec),
+	     \+ ( same_solutions(gcc(Doms, Spec, bounds), gcc_decomp(Doms, Spec)),
+		  same_solutions(gcc(Doms, Spec, domain), gcc_decomp(Doms, Spec))
+		)
+	   ).
+
+
+random_graph(N, G) :-
+	findall(Succs, (between(1, N, _), random_succs(N, Succs)), G).
+
+
+random_succs(N, Succs) :-
+	findall(J, (between(1, N, J), random(0, 10, R), R < 7), Succs).
+
+
+random_gcc(N, Doms, Spec) :-
+	findall(D, (between(1, N, _), random_values(5, 7, D)), Doms),
+	random_values(4, 8, Keys),
+	findall(K - C, (member(K, Keys), random_count(N, C)), Spec).
+
+
+random_values(N, P, Vs) :-
+	findall(V, (between(1, N, V), random(0, 10, R), R < P), Vs).
+
+
+random_count(N, C) :-		% fixed(C) or range(L, U) for an FD variable
+	random(0, 4, F),
+	(   F =:= 0 ->
+	    random(0, 3, C1),
+	    C = fixed(C1)
+	;   random(0, 2, L),
+	    U0 is N + 1,
+	    random(L, U0, U),
+	    C = range(L, U)
+	).
+
+
+same_solutions(P1, P2) :-
+	solutions(P1, S),
+	solutions(P2, S).
+
+
+solutions(P, S) :-
+	findall(L, solution(P, L), S1),
+	sort(S1, S).
+
+
+solution(circuit(G), L) :-
+	graph_vars(G, L),
+	fd_circuit(L),
+	fd_labeling(L).
+
+solution(circuit_decomp(G), L) :-
+	graph_vars(G, L),
+	fd_all_different(L),
+	fd_labeling(L),
+	length(L, N),
+	cycle_length(L, 1, 1, K),
+	K =:= N.
+
+solution(subcircuit(G), L) :-
+	graph_vars(G, L),
+	fd_subcircuit(L),
+	fd_labeling(L).
+
+solution(subcircuit_decomp(G), L) :-
+	graph_vars(G, L),
+	fd_all_different(L),
+	fd_labeling(L),
+	findall(I, (nth(I, L, S), S =\= I), Moved),
+	(   Moved = [] ->
+	    true
+	;   Moved = [I|_],
+	    cycle_length(L, I, I, K),
+	    length(Moved, K)
+	).
+
+solution(gcc(Doms, Spec, Cons), Vars - Counts) :-
+	gcc_vars(Doms, Spec, Vars, Pairs, _, Counts),
+	fd_global_cardinality(Vars, Pairs, [consistency(Cons)]),
+	fd_labeling(Vars),
+	fd_labeling(Counts).
+
+solution(gcc_decomp(Doms, Spec), Vars - Counts) :-
+	gcc_vars(Doms, Spec, Vars, Pairs, Keys, Counts),
+	fd_domain(Vars, Keys),
+	gcc_counts(Pairs, Vars),
+	fd_labeling(Vars),
+	fd_labeling(Counts).
+
+
+graph_vars(G, L) :-
+	length(G, N),
+	length(L, N),
+	fd_domain(L, 1, N),
+	graph_vars1(G, L).
+
+graph_vars1([], []).
+
+graph_vars1([Succs|G], [X|L]) :-
+	fd_domain(X, Succs),
+	graph_vars1(G, L).
+
+
+cycle_length(L, I, Start, K) :-
+	nth(I, L, J),
+	(   J =:= Start ->
+	    K = 1
+	;   cycle_length(L, J, Start, K1),
+	    K is K1 + 1
+	).
+
+
+
+
+gcc_vars(Doms, Spec, Vars, Pairs, Keys, Counts) :-
+	gcc_vars1(Doms, Vars),
+	gcc_pairs(Spec, Pairs, Keys, Counts).
+
+gcc_vars1([], []).
+
+gcc_vars1([D|Doms], [X|Vars]) :-
+	fd_domain(X, D),
+	gcc_vars1(Doms, Vars).
+
+
+gcc_pairs([], [], [], []).
+
+gcc_pairs([K - fixed(C)|Spec], [K - C|Pairs], [K|Keys], [C|Counts]) :-
+	gcc_pairs(Spec, Pairs, Keys, Counts).
+
+gcc_pairs([K - range(L, U)|Spec], [K - C|Pairs], [K|Keys], [C|Counts]) :-
+	fd_domain(C, L, U),
+	gcc_pairs(Spec, Pairs, Keys, Counts).
+
+
+gcc_counts([], _).
+
+gcc_counts([K - C|Pairs], Vars) :-
+	gcc_reif(Vars, K, Cstrs),
+	fd_cardinality(Cstrs, C),
+	gcc_counts(Pairs, Vars).
+
+
+gcc_reif([], _, []).
+
+gcc_reif([X|Vars], K, [X #= K|Cstrs]) :-
+	gcc_reif(Vars, K, Cstrs).
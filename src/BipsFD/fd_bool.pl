@@ -110,15 +110,15 @@ fd_cardinality(List, Count) :-
 
 '$fd_cardinality'(List, Count) :-
 	'$check_list'(List),
-	'$fd_cardinality1'(List, Count).
+	'$fd_cardinality1'(List, LB),
+	'$call_c_test'('Pl_Fd_Cardinality_2'(LB, Count)).
 
 
-'$fd_cardinality1'([], 0).
+'$fd_cardinality1'([], []).
 
-'$fd_cardinality1'([C|List], Count1) :-
-	'$fd_cardinality1'(List, Count),
+'$fd_cardinality1'([C|List], [B|LB]) :-
 	'$truth_of'(C, B),
-	Count1 #= Count + B.
+	'$fd_cardinality1'(List, LB).
 
 
 
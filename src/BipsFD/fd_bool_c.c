@@ -86,6 +86,25 @@
 #define NB_OF_OP                   ZERO
 
 
+#define CLAUSE_NB_LIT              0 /* A frame of a clause */
+#define CLAUSE_CF                  1
+#define CLAUSE_WATCH1              2 /* the 2 watched literals (index) */
+#define CLAUSE_WATCH2              3
+#define CLAUSE_LITS                4
+
+
+#define CARD_NB_BOOL               0 /* A frame of a cardinality */
+#define CARD_COUNT                 1
+#define CARD_NB_TRUE               2 /* nb of booleans counted as 1 */
+#define CARD_NB_FREE               3 /* nb of booleans not yet counted */
+#define CARD_BOOLS                 4
+
+#define CARD_B_AF                  0 /* a boolean: the A frame of the */
+#define CARD_B_FDV                 1 /* cstr, B and if it is counted  */
+#define CARD_B_COUNTED             2
+#define CARD_B_SIZE                3
+
+
 
 
 /*---------------------------------*
@@ -107,6 +126,11 @@ static WamWord *vars_sp;
 
 static Bool (*func_tbl[NB_OF_OP + 2]) (WamWord *exp, int result, WamWord *load_word);
 
+static WamWord *clause_lit;	/* literals of the clauses being loaded */
+static int clause_size;
+static int clause_top;
+static Bool clause_true;	/* a literal is true (constant 1) */
+
 
 
 
@@ -155,6 +179,33 @@ static Bool Set_Zero(WamWord *exp, int result, WamWord *load_word);
 
 static Bool Set_One(WamWord *exp, int result, WamWord *load_word);
 
+static Bool Load_Clause(WamWord *exp, int sign);
+
+static Bool Collect_Literals(WamWord *exp, int sign);
+
+static void Clause_Push(WamWord lit);
+
+static Bool Post_Clause(WamWord *lit, int n);
+
+static PlLong Clause_Propagate(WamWord *AF);
+
+static PlLong Card_Bool_Propagate(WamWord *t);
+
+static PlLong Card_Filter(WamWord *AF);
+
+static void Card_Count(WamWord *AF, WamWord *t);
+
+
+
+#define Lit_Make(fdv_adr, sign)    ((WamWord) (fdv_adr) | (1 - (sign)))
+
+#define Lit_Fdv(lit)               ((WamWord *) ((lit) & ~(WamWord) 1))
+
+#define Lit_Value(lit)             ((int) (1 - ((lit) & 1))) /* value if true */
+
+#define Lit_Is_False(lit)					\
+  (Fd_Variable_Is_Ground(Lit_Fdv(lit)) && Min(Lit_Fdv(lit)) != Lit_Value(lit))
+
 
 
 #ifdef DEBUG
@@ -1111,16 +1162,13 @@ Set_Imply(WamWord *exp, int result, WamWord *load_word)
     return Load_Bool_Into_Word((WamWord *) (exp[1]), 1, &load_l) &&
       Load_Bool_Into_Word((WamWord *) (exp[2]), 0, &load_r);
 
+  if (result == 1)		/* L ==> R is true: clause ~L \/ R */
+    return Load_Clause(exp, 1);
+
   if (!Load_Bool_Into_Word((WamWord *) (exp[1]), 2, &load_l) ||
       !Load_Bool_Into_Word((WamWord *) (exp[2]), 2, &load_r))
     return FALSE;
 
-  if (result == 1)		/* L ==> R is true */
-    {
-      BOOL_CSTR_2(pl_x_imply_y_eq_1, load_l, load_r);
-      return TRUE;
-    }
-
 				/* L ==> R = B */
   *load_word = Tag_REF(Pl_Fd_New_Bool_Variable());
   BOOL_CSTR_3(pl_x_imply_y_eq_b, load_l, load_r, *load_word);
@@ -1139,6 +1187,9 @@ Set_Nimply(WamWord *exp, int result, WamWord *load_word)
 {
   WamWord load_l, load_r;
 
+  if (result == 0)		/* L ~==> R is false: clause ~L \/ R */
+    return Load_Clause(exp, 0);
+
   if (result <= 1)		/* L ~==> R is true or false */
     return Set_Imply(exp, 1 - result, load_word);
 
@@ -1168,16 +1219,13 @@ Set_And(WamWord *exp, int result, WamWord *load_word)
     return Load_Bool_Into_Word((WamWord *) (exp[1]), 1, NULL) &&
       Load_Bool_Into_Word((WamWord *) (exp[2]), 1, NULL);
 
+  if (result == 0)		/* L /\ R is false: clause ~L \/ ~R */
+    return Load_Clause(exp, 0);
+
   if (!Load_Bool_Into_Word((WamWord *) (exp[1]), 2, &load_l) ||
       !Load_Bool_Into_Word((WamWord *) (exp[2]), 2, &load_r))
     return FALSE;
 
-  if (result == 0)		/* L /\ R is false */
-    {
-      BOOL_CSTR_2(pl_x_and_y_eq_0, load_l, load_r);
-      return TRUE;
-    }
-
 				/* L /\ R = B */
   *load_word = Tag_REF(Pl_Fd_New_Bool_Variable());
   BOOL_CSTR_3(pl_x_and_y_eq_b, load_l, load_r, *load_word);
@@ -1196,6 +1244,9 @@ Set_Nand(WamWord *exp, int result, WamWord *load_word)
 {
   WamWord load_l, load_r;
 
+  if (result == 1)		/* L ~/\ R is true: clause ~L \/ ~R */
+    return Load_Clause(exp, 1);
+
   if (result <= 1)		/* L ~/\ R is true or false */
     return Set_And(exp, 1 - result, load_word);
 
@@ -1225,16 +1276,13 @@ Set_Or(WamWord *exp, int result, WamWord *load_word)
     return Load_Bool_Into_Word((WamWord *) (exp[1]), 0, NULL) &&
       Load_Bool_Into_Word((WamWord *) (exp[2]), 0, NULL);
 
+  if (result == 1)		/* L \/ R is true: clause L \/ R */
+    return Load_Clause(exp, 1);
+
   if (!Load_Bool_Into_Word((WamWord *) (exp[1]), 2, &load_l) ||
       !Load_Bool_Into_Word((WamWord *) (exp[2]), 2, &load_r))
     return FALSE;
 
-  if (result == 1)		/* L \/ R is true */
-    {
-      BOOL_CSTR_2(pl_x_or_y_eq_1, load_l, load_r);
-      return TRUE;
-    }
-
 				/* L \/ R = B */
   *load_word = Tag_REF(Pl_Fd_New_Bool_Variable());
   BOOL_CSTR_3(pl_x_or_y_eq_b, load_l, load_r, *load_word);
@@ -1253,6 +1301,9 @@ Set_Nor(WamWord *exp, int result, WamWord *load_word)
 {
   WamWord load_l, load_r;
 
+  if (result == 0)		/* L ~\/ R is false: clause L \/ R */
+    return Load_Clause(exp, 0);
+
   if (result <= 1)		/* L ~\/ R is true or false */
     return Set_Or(exp, 1 - result, load_word);
 
@@ -1269,6 +1320,220 @@ Set_Nor(WamWord *exp, int result, WamWord *load_word)
 
 
 
+/*-------------------------------------------------------------------------*
+ * LOAD_CLAUSE                                                             *
+ *                                                                         *
+ * Loads exp (if sign = 1) or ~exp (if sign = 0) as a clause: the nested   *
+ * disjunctions (\/, ==>, ~/\, ...) are flattened into a disjunction of    *
+ * literals X or ~X. The other sub-expressions are loaded into a boolean   *
+ * variable (i.e. via a reified constraint) which gives a literal. The     *
+ * clause is a single constraint (see Post_Clause) instead of a tree of    *
+ * gates with one intermediate boolean variable per gate.                  *
+ *-------------------------------------------------------------------------*/
+static Bool
+Load_Clause(WamWord *exp, int sign)
+{
+  int base = clause_top;	/* can be nested via Collect_Literals */
+  Bool save_clause_true = clause_true;
+  Bool ret;
+
+  clause_true = FALSE;
+  ret = Collect_Literals(exp, sign);
+  if (ret && !clause_true)
+    ret = Post_Clause(clause_lit + base, clause_top - base);
+
+  clause_top = base;
+  clause_true = save_clause_true;
+
+  return ret;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * COLLECT_LITERALS                                                        *
+ *                                                                         *
+ * Pushes literals whose disjunction is exp (if sign = 1) or ~exp (if      *
+ * sign = 0).                                                              *
+ *-------------------------------------------------------------------------*/
+static Bool
+Collect_Literals(WamWord *exp, int sign)
+{
+  WamWord word, tag_mask;
+  WamWord load_word;
+  PlULong op = *exp;
+
+  switch (op)
+    {
+    case ZERO:
+    case ONE:
+      if (op == (sign ? ONE : ZERO))
+	clause_true = TRUE;
+      return TRUE;
+
+    case NOT:
+      return Collect_Literals(exp + 1, 1 - sign);
+
+    case OR:
+    case NOR:
+      if ((op == OR) != sign)
+	break;
+      return Collect_Literals((WamWord *) exp[1], 1) &&
+	Collect_Literals((WamWord *) exp[2], 1);
+
+    case IMPLY:
+    case NIMPLY:
+      if ((op == IMPLY) != sign)
+	break;
+      return Collect_Literals((WamWord *) exp[1], 0) &&
+	Collect_Literals((WamWord *) exp[2], 1);
+
+    case AND:
+    case NAND:
+      if ((op == NAND) != sign)
+	break;
+      return Collect_Literals((WamWord *) exp[1], 0) &&
+	Collect_Literals((WamWord *) exp[2], 0);
+    }
+
+  if (op > ONE)			/* a variable */
+    load_word = *exp;
+  else if (!Load_Bool_Into_Word(exp, 2, &load_word))
+    return FALSE;
+
+  if (!Pl_Fd_Check_For_Bool_Var(load_word))
+    return FALSE;
+
+  DEREF(load_word, word, tag_mask);
+  if (tag_mask == TAG_INT_MASK)
+    {
+      if (UnTag_INT(word) == sign)
+	clause_true = TRUE;
+      return TRUE;
+    }
+
+  Clause_Push(Lit_Make(UnTag_FDV(word), sign));
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CLAUSE_PUSH                                                             *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Clause_Push(WamWord lit)
+{
+  if (clause_top == clause_size)
+    {
+      clause_size = (clause_size == 0) ? 1024 : 2 * clause_size;
+      clause_lit = (WamWord *) Realloc(clause_lit, clause_size * sizeof(WamWord));
+    }
+
+  clause_lit[clause_top++] = lit;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * POST_CLAUSE                                                             *
+ *                                                                         *
+ * The clause is propagated with 2 watched literals: the constraint only   *
+ * depends on the variables of 2 non-false literals. When one becomes      *
+ * false, another non-false literal is watched (its dependency is added,   *
+ * the one of the false literal can be kept: its variable is ground). If   *
+ * there is none the other watched literal must be true.                   *
+ *-------------------------------------------------------------------------*/
+static Bool
+Post_Clause(WamWord *lit, int n)
+{
+  WamWord *AF, *CF;
+  int i;
+
+  if (n == 0)
+    return FALSE;
+
+  if (n == 1)
+    return Pl_Get_Integer(Lit_Value(lit[0]), Tag_REF(Lit_Fdv(lit[0])));
+
+  AF = CS;
+  CS += CLAUSE_LITS + n;
+
+  AF[CLAUSE_NB_LIT] = n;
+  AF[CLAUSE_WATCH1] = 0;
+  AF[CLAUSE_WATCH2] = 1;
+  for (i = 0; i < n; i++)
+    AF[CLAUSE_LITS + i] = lit[i];
+
+  Fd_Cstr_Type(fd_clause);
+  Pl_Fd_Before_Add_Cstr();
+
+  CF = Pl_Fd_Create_C_Frame(Clause_Propagate, AF, NULL, FALSE, FD_PRIO_CHEAP);
+  AF[CLAUSE_CF] = (WamWord) CF;
+  Pl_Fd_Add_Dependency(Lit_Fdv(lit[0]), CHAIN_NB_VAL, CF);
+  Pl_Fd_Add_Dependency(Lit_Fdv(lit[1]), CHAIN_NB_VAL, CF);
+
+  /* the loading of the literals can have fixed some of them */
+  return Pl_Fd_After_Add_Cstr(Clause_Propagate(AF));
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CLAUSE_PROPAGATE                                                        *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static PlLong
+Clause_Propagate(WamWord *AF)
+{
+  int n = (int) AF[CLAUSE_NB_LIT];
+  WamWord *lit = AF + CLAUSE_LITS;
+  int k, w, o, i, j = 0;
+
+  for (k = CLAUSE_WATCH1; k <= CLAUSE_WATCH2; k++)
+    {
+      w = (int) AF[k];
+      if (!Lit_Is_False(lit[w]))
+	continue;
+
+      o = (int) AF[CLAUSE_WATCH1 + CLAUSE_WATCH2 - k];
+      for (i = 1; i < n; i++)	/* look for another non-false literal */
+	{
+	  j = (w + i) % n;
+	  if (j != o && !Lit_Is_False(lit[j]))
+	    break;
+	}
+
+      if (i < n)
+	{
+	  FD_Bind_OV(AF + k, j);
+	  Pl_Fd_Add_Dependency(Lit_Fdv(lit[j]), CHAIN_NB_VAL,
+			       (WamWord *) AF[CLAUSE_CF]);
+	  continue;
+	}
+
+      /* unit: the other watched literal must be true */
+      if (Lit_Is_False(lit[o]))
+	return FALSE;
+
+      if (!Fd_Variable_Is_Ground(Lit_Fdv(lit[o])) &&
+	  !Pl_Fd_Tell_Value(Lit_Fdv(lit[o]), Lit_Value(lit[o])))
+	return FALSE;
+
+      return TRUE;
+    }
+
+  return TRUE;
+}
+
+
+
+
 
 
 
@@ -1577,13 +1842,13 @@ Pl_Fd_Reified_In(WamWord x_word, WamWord l_word, WamWord u_word, WamWord b_word)
   WamWord *adr, *fdv_adr;
   PlLong x;
   PlLong b = -1;		/* a var */
-  int min, max;
-  int x_min, x_max;
+  PlLong min, max;
+  PlLong x_min, x_max;
   Range *r;
  
   //  Bool pl_fd_domain(WamWord x_word, WamWord l_word, WamWord u_word);
   /* from fd_values_c.c (optimized version) */
-  Bool Pl_Fd_Domain_Interval(WamWord x_word, int min, int max);
+  Bool Pl_Fd_Domain_Interval(WamWord x_word, PlLong min, PlLong max);
 
   /* from fd_values_fd.fd */
   Bool pl_fd_not_domain(WamWord x_word, WamWord l_word, WamWord u_word);
@@ -1663,3 +1928,176 @@ Pl_Fd_Reified_In(WamWord x_word, WamWord l_word, WamWord u_word, WamWord b_word)
 
   return TRUE;
 }
+
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_CARDINALITY_2                                                     *
+ *                                                                         *
+ * Count is the number of booleans of the list equal to 1. The booleans    *
+ * are counted incrementally: each one has its own constraint frame (only  *
+ * triggered when it becomes ground) which updates the counters in O(1).   *
+ * The free booleans are only scanned when Count reaches a bound of its    *
+ * possible values (they are all set to 0 or all set to 1).                *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Cardinality_2(WamWord list_word, WamWord count_word)
+{
+  WamWord word, tag_mask;
+  WamWord save_list_word = list_word;
+  WamWord *lst_adr;
+  WamWord *AF, *CF, *t;
+  WamWord *fdv_adr, *count_adr;
+  int n = 0, m = 0;
+  int nb_true = 0;
+  int i;
+
+  for (;;)
+    {
+      DEREF(list_word, word, tag_mask);
+      if (tag_mask != TAG_LST_MASK)
+	break;
+      lst_adr = UnTag_LST(word);
+      n++;
+      list_word = Cdr(lst_adr);
+    }
+
+  AF = CS;
+  CS += CARD_BOOLS + n * CARD_B_SIZE;
+
+  for (list_word = save_list_word; n > 0; n--)
+    {
+      DEREF(list_word, word, tag_mask);
+      lst_adr = UnTag_LST(word);
+      list_word = Cdr(lst_adr);
+
+      if (!Pl_Fd_Check_For_Bool_Var(Car(lst_adr)))
+	return FALSE;
+
+      DEREF(Car(lst_adr), word, tag_mask);
+      if (tag_mask == TAG_INT_MASK)
+	{
+	  nb_true += (int) UnTag_INT(word);
+	  continue;
+	}
+
+      t = AF + CARD_BOOLS + m * CARD_B_SIZE;
+      t[CARD_B_AF] = (WamWord) AF;
+      t[CARD_B_FDV] = (WamWord) UnTag_FDV(word);
+      t[CARD_B_COUNTED] = FALSE;
+      m++;
+    }
+
+  count_adr = Pl_Fd_Prolog_To_Fd_Var(count_word, TRUE);
+
+  AF[CARD_NB_BOOL] = m;
+  AF[CARD_COUNT] = (WamWord) count_adr;
+  AF[CARD_NB_TRUE] = nb_true;
+  AF[CARD_NB_FREE] = m;
+
+  Fd_Cstr_Type(fd_cardinality);
+  Pl_Fd_Before_Add_Cstr();
+
+  for (i = 0, t = AF + CARD_BOOLS; i < m; i++, t += CARD_B_SIZE)
+    {
+      fdv_adr = (WamWord *) t[CARD_B_FDV];
+      if (Fd_Variable_Is_Ground(fdv_adr)) /* fixed by a later Check_For_Bool */
+	{
+	  Card_Count(AF, t);
+	  continue;
+	}
+
+      CF = Pl_Fd_Create_C_Frame(Card_Bool_Propagate, t, fdv_adr, FALSE,
+				FD_PRIO_CHEAP);
+      Pl_Fd_Add_Dependency(fdv_adr, CHAIN_NB_VAL, CF);
+    }
+
+  CF = Pl_Fd_Create_C_Frame(Card_Filter, AF, count_adr, FALSE, FD_PRIO_CHEAP);
+  Pl_Fd_Add_Dependency(count_adr, CHAIN_NB_MIN_MAX, CF);
+
+  return Pl_Fd_After_Add_Cstr(Card_Filter(AF));
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CARD_BOOL_PROPAGATE                                                     *
+ *                                                                         *
+ * Constraint of a boolean t of a cardinality (t has become ground).       *
+ *-------------------------------------------------------------------------*/
+static PlLong
+Card_Bool_Propagate(WamWord *t)
+{
+  WamWord *AF = (WamWord *) t[CARD_B_AF];
+
+  Card_Count(AF, t);
+
+  return Card_Filter(AF);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CARD_COUNT                                                              *
+ *                                                                         *
+ * Counts the (ground) boolean t if not yet done.                          *
+ *-------------------------------------------------------------------------*/
+static void
+Card_Count(WamWord *AF, WamWord *t)
+{
+  if (t[CARD_B_COUNTED])
+    return;
+
+  FD_Bind_OV(t + CARD_B_COUNTED, TRUE);
+  FD_Bind_OV(AF + CARD_NB_FREE, AF[CARD_NB_FREE] - 1);
+  if (Min((WamWord *) t[CARD_B_FDV]) == 1)
+    FD_Bind_OV(AF + CARD_NB_TRUE, AF[CARD_NB_TRUE] + 1);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CARD_FILTER                                                             *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static PlLong
+Card_Filter(WamWord *AF)
+{
+  int m = (int) AF[CARD_NB_BOOL];
+  WamWord *count_adr = (WamWord *) AF[CARD_COUNT];
+  WamWord *t, *end = AF + CARD_BOOLS + m * CARD_B_SIZE;
+  WamWord *fdv_adr;
+  int lo, hi, value;
+
+  for (;;)
+    {
+      lo = (int) AF[CARD_NB_TRUE];
+      hi = lo + (int) AF[CARD_NB_FREE];
+
+      if (!Pl_Fd_Tell_Interval(count_adr, lo, hi))
+	return FALSE;
+
+      if (lo == hi || (Max(count_adr) > lo && Min(count_adr) < hi))
+	return TRUE;
+
+      value = (Max(count_adr) == lo) ? 0 : 1;
+
+      for (t = AF + CARD_BOOLS; t < end; t += CARD_B_SIZE)
+	{
+	  if (t[CARD_B_COUNTED])
+	    continue;
+
+	  fdv_adr = (WamWord *) t[CARD_B_FDV];
+	  if (!Fd_Variable_Is_Ground(fdv_adr) &&
+	      !Pl_Fd_Tell_Value(fdv_adr, value))
+	    return FALSE;
+
+	  Card_Count(AF, t);
+	}
+    }
+}
@@ -105,3 +105,71 @@ fd_has_vector(Fdv) :-
 fd_use_vector(Fdv) :-
 	set_bip_name(fd_use_vector, 1),
 	'$call_c_test'('Pl_Fd_Use_Vector_1'(Fdv)).
+
+
+
+
+fd_wakeups(Counters) :-
+	set_bip_name(fd_wakeups, 1),
+	'$call_c_test'('Pl_Fd_Wakeups_1'(Counters)).
+
+
+fd_reset_wakeups :-
+	'$call_c'('Pl_Fd_Reset_Wakeups_0').
+
+
+fd_constraint_wakeups(Fdv, Counters) :-
+	set_bip_name(fd_constraint_wakeups, 2),
+	'$call_c_test'('Pl_Fd_Constraint_Wakeups_2'(Fdv, Counters)).
+
+
+
+
+fd_statistics :-
+	set_bip_name(fd_statistics, 0),
+	'$call_c'('Pl_Fd_Statistics_0').
+
+
+fd_statistics(Key, Value) :-
+	set_bip_name(fd_statistics, 2),
+	(   var(Key) ->
+	    true
+	;   '$fd_stat_key'(Key) ->
+	    true
+	;   atom(Key) ->
+	    '$pl_err_domain'(fd_statistics_key, Key)
+	;   '$pl_err_type'(atom, Key)
+	),
+	'$fd_stat_key'(Key),
+	'$call_c_test'('Pl_Fd_Statistics_2'(Key, Value)).
+
+
+'$fd_stat_key'(propagations).
+'$fd_stat_key'(failures).
+'$fd_stat_key'(reductions).
+'$fd_stat_key'(backtracks).
+'$fd_stat_key'(constraints).
+'$fd_stat_key'(variables).
+'$fd_stat_key'(constraint_types).
+
+
+
+
+fd_reset_statistics :-
+	'$call_c'('Pl_Fd_Reset_Statistics_0').
+
+
+
+
+fd_trace_start(Size) :-
+	set_bip_name(fd_trace_start, 1),
+	'$call_c'('Pl_Fd_Trace_Start_1'(Size)).
+
+
+fd_trace_stop :-
+	'$call_c'('Pl_Fd_Trace_Stop_0').
+
+
+fd_trace_dump(File) :-
+	set_bip_name(fd_trace_dump, 1),
+	'$call_c_test'('Pl_Fd_Trace_Dump_1'(File)).
@@ -36,11 +36,17 @@
  *-------------------------------------------------------------------------*/
 
 
+#include <limits.h>
+#include <string.h>
+
+#define OBJ_INIT Fd_Infos_Initializer
+
 #include "engine_pl.h"
 #include "engine_fd.h"
 
 #include "bips_pl.h"
 #include "bips_fd.h"
+#include "fd_trace.h"
 
 
 /*---------------------------------*
@@ -55,11 +61,50 @@
  * Global Variables                *
  *---------------------------------*/
 
+static int prio_atom[FD_NB_PRIO];	/* names of the priorities */
+
+static int atom_propagations;		/* keys of fd_statistics/2 */
+static int atom_failures;
+static int atom_reductions;
+static int atom_backtracks;
+static int atom_constraints;
+static int atom_variables;
+static int atom_constraint_types;
+static int atom_stats;
+
 
 /*---------------------------------*
  * Function Prototypes             *
  *---------------------------------*/
 
+static Bool Unify_Wakeups(WamWord *list_word, int prio, PlULong n);
+
+static Bool Unify_Cstr_Types(WamWord list_word);
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * FD_INFOS_INITIALIZER                                                    *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Fd_Infos_Initializer(void)
+{
+  prio_atom[FD_PRIO_CHEAP] = Pl_Create_Atom("cheap");
+  prio_atom[FD_PRIO_LINEAR] = Pl_Create_Atom("linear");
+  prio_atom[FD_PRIO_EXPENSIVE] = Pl_Create_Atom("expensive");
+
+  atom_propagations = Pl_Create_Atom("propagations");
+  atom_failures = Pl_Create_Atom("failures");
+  atom_reductions = Pl_Create_Atom("reductions");
+  atom_backtracks = Pl_Create_Atom("backtracks");
+  atom_constraints = Pl_Create_Atom("constraints");
+  atom_variables = Pl_Create_Atom("variables");
+  atom_constraint_types = Pl_Create_Atom("constraint_types");
+  atom_stats = Pl_Create_Atom("stats");
+}
+
 
 
 
@@ -160,8 +205,10 @@ Pl_Fd_Dom_2(WamWord fdv_word, WamWord list_word)
   WamWord word, tag_mask;
   WamWord *fdv_adr;
   PlLong x;
-  int end;
+  PlLong end;
   int vec_elem;
+  PlLong *il;
+  int i;
 
   Pl_Check_For_Un_List(list_word);
 
@@ -189,6 +236,21 @@ Pl_Fd_Dom_2(WamWord fdv_word, WamWord list_word)
 	      list_word = Pl_Unify_Variable();
 	    }
 	}
+      else if (Is_IList(Range(fdv_adr)))
+	{
+	  il = IList_Of(Range(fdv_adr));
+	  for (i = 0; i < IList_Nb_Interv(il); i++)
+	    {
+	      end = IList_Max(il, i);
+	      for (x = IList_Min(il, i); x <= end; x++)
+		{
+		  if (!Pl_Get_List(list_word) || !Pl_Unify_Integer(x))
+		    return FALSE;
+
+		  list_word = Pl_Unify_Variable();
+		}
+	    }
+	}
       else
 	{
 	  VECTOR_BEGIN_ENUM(Vec(fdv_adr), vec_elem);
@@ -277,3 +339,313 @@ Pl_Fd_Use_Vector_1(WamWord fdv_word)
 
   return tag_mask == TAG_INT_MASK || Pl_Fd_Use_Vector(UnTag_FDV(word));
 }
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_WAKEUPS_1                                                         *
+ *                                                                         *
+ * Unifies list_word with [cheap-N0, linear-N1, expensive-N2] where Ni is  *
+ * the number of constraint executions of each priority.                   *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Wakeups_1(WamWord list_word)
+{
+  int prio;
+
+  Pl_Check_For_Un_List(list_word);
+
+  for (prio = 0; prio < FD_NB_PRIO; prio++)
+    if (!Unify_Wakeups(&list_word, prio, pl_fd_nb_wakeups[prio]))
+      return FALSE;
+
+  return Pl_Get_Nil(list_word);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_RESET_WAKEUPS_0                                                   *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Reset_Wakeups_0(void)
+{
+  int prio;
+
+  for (prio = 0; prio < FD_NB_PRIO; prio++)
+    pl_fd_nb_wakeups[prio] = 0;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_CONSTRAINT_WAKEUPS_2                                              *
+ *                                                                         *
+ * Unifies list_word with the list of Priority-N for each constraint       *
+ * depending on the FD var (N is its number of executions). A constraint   *
+ * present in several chains is marked (with its queue link, the queues   *
+ * are empty here) to be given only once.                                  *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Constraint_Wakeups_2(WamWord fdv_word, WamWord list_word)
+{
+  WamWord word, tag_mask;
+  WamWord *fdv_adr;
+  WamWord **chain_adr;
+  WamWord *record_adr;
+  WamWord *CF;
+  Bool ret = TRUE;
+  int pass, i;
+
+  Pl_Check_For_Un_List(list_word);
+
+  Fd_Deref_Check_Fd_Var(fdv_word, word, tag_mask);
+  if (tag_mask == TAG_INT_MASK)
+    return Pl_Get_Nil(list_word);
+
+  fdv_adr = UnTag_FDV(word);
+
+  for (pass = 0; pass < 2; pass++) /* pass 0: unify and mark, 1: unmark */
+    for (i = 0, chain_adr = &Chain_Min(fdv_adr); i <= CHAIN_NB_VAL; i++, chain_adr++)
+      for (record_adr = *chain_adr; record_adr != NULL; record_adr = Next_Chain(record_adr))
+	{
+	  CF = CF_Pointer(record_adr);
+	  if (pass == 1)
+	    Cstr_Next_In_Queue(CF) = NULL;
+	  else if (Cstr_Next_In_Queue(CF) == NULL)
+	    {
+	      Cstr_Next_In_Queue(CF) = CF;
+	      ret = ret && Unify_Wakeups(&list_word, Cstr_Priority(CF), Cstr_Nb_Wakeups(CF));
+	    }
+	}
+
+  return ret && Pl_Get_Nil(list_word);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_STATISTICS_0                                                      *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Statistics_0(void)
+{
+  StmInf *pstm = pl_stm_tbl[pl_stm_stdout];
+  FdCstrType *t;
+  PlULong c = 0, p = 0, f = 0, r = 0;
+  int w = 24;			/* width of the type column */
+  int i;
+
+  for (i = 0, t = pl_fd_cstr_type; i < pl_fd_nb_cstr_type; i++, t++)
+    {
+      w = math_max(w, (int) strlen(t->name));
+      c += t->nb_post;
+      p += t->nb_propag;
+      f += t->nb_fail;
+      r += t->nb_reduc;
+    }
+
+  Pl_Stream_Printf(pstm, "%-*s constraints   variables  backtracks\n\n",
+		   w + 3, "FD solver");
+  Pl_Stream_Printf(pstm, "   %-*s %12" PL_FMT_d "%12" PL_FMT_d "%12" PL_FMT_d
+		   "\n\n", w, "", (PlLong) c, (PlLong) pl_fd_nb_var,
+		   (PlLong) pl_fd_nb_bckt);
+
+  Pl_Stream_Printf(pstm, "%-*s constraints propagations    failures"
+		   "  reductions\n\n", w + 3, "Constraint type");
+
+  for (i = 0, t = pl_fd_cstr_type; i < pl_fd_nb_cstr_type; i++, t++)
+    {
+      if (t->nb_post == 0 && t->nb_propag == 0 && t->nb_reduc == 0 &&
+	  t->nb_fail == 0)
+	continue;
+
+      Pl_Stream_Printf(pstm, "   %-*s %12" PL_FMT_d " %12" PL_FMT_d
+		       "%12" PL_FMT_d "%12" PL_FMT_d "\n", w, t->name,
+		       (PlLong) t->nb_post, (PlLong) t->nb_propag,
+		       (PlLong) t->nb_fail, (PlLong) t->nb_reduc);
+    }
+
+  Pl_Stream_Printf(pstm, "   %-*s %12" PL_FMT_d " %12" PL_FMT_d
+		   "%12" PL_FMT_d "%12" PL_FMT_d "\n", w, "total",
+		   (PlLong) c, (PlLong) p, (PlLong) f, (PlLong) r);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_STATISTICS_2                                                      *
+ *                                                                         *
+ * The totals are the sums of the counters of the constraint types.        *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Statistics_2(WamWord key_word, WamWord value_word)
+{
+  int key = Pl_Rd_Atom_Check(key_word);
+  FdCstrType *t;
+  PlULong n = 0;
+  int i;
+
+  if (key == atom_constraint_types)
+    return Unify_Cstr_Types(value_word);
+
+  if (key == atom_variables)
+    n = pl_fd_nb_var;
+  else if (key == atom_backtracks)
+    n = pl_fd_nb_bckt;
+  else
+    for (i = 0, t = pl_fd_cstr_type; i < pl_fd_nb_cstr_type; i++, t++)
+      if (key == atom_propagations)
+	n += t->nb_propag;
+      else if (key == atom_failures)
+	n += t->nb_fail;
+      else if (key == atom_reductions)
+	n += t->nb_reduc;
+      else if (key == atom_constraints)
+	n += t->nb_post;
+
+  return Pl_Un_Integer_Check((PlLong) n, value_word);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * UNIFY_CSTR_TYPES                                                        *
+ *                                                                         *
+ * Unifies list_word with the list of Name-stats(Constraints, Propagations,*
+ * Failures, Reductions) for each constraint type used since the last     *
+ * reset.                                                                  *
+ *-------------------------------------------------------------------------*/
+static Bool
+Unify_Cstr_Types(WamWord list_word)
+{
+  WamWord head_word, stats_word;
+  FdCstrType *t;
+  int i;
+
+  Pl_Check_For_Un_List(list_word);
+
+  for (i = 0, t = pl_fd_cstr_type; i < pl_fd_nb_cstr_type; i++, t++)
+    {
+      if (t->nb_post == 0 && t->nb_propag == 0 && t->nb_reduc == 0 &&
+	  t->nb_fail == 0)
+	continue;
+
+      if (!Pl_Get_List(list_word))
+	return FALSE;
+
+      head_word = Pl_Unify_Variable();
+      list_word = Pl_Unify_Variable();
+
+      if (!Pl_Get_Structure(ATOM_CHAR('-'), 2, head_word) ||
+	  !Pl_Unify_Atom(Pl_Create_Atom(t->name)))
+	return FALSE;
+
+      stats_word = Pl_Unify_Variable();
+      if (!Pl_Get_Structure(atom_stats, 4, stats_word) ||
+	  !Pl_Unify_Integer((PlLong) t->nb_post) ||
+	  !Pl_Unify_Integer((PlLong) t->nb_propag) ||
+	  !Pl_Unify_Integer((PlLong) t->nb_fail) ||
+	  !Pl_Unify_Integer((PlLong) t->nb_reduc))
+	return FALSE;
+    }
+
+  return Pl_Get_Nil(list_word);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_RESET_STATISTICS_0                                                *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Reset_Statistics_0(void)
+{
+  Pl_Fd_Reset_Statistics();
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_TRACE_START_1                                                     *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Trace_Start_1(WamWord size_word)
+{
+  PlLong size = Pl_Rd_Positive_Check(size_word);
+
+  if (size == 0)
+    Pl_Fd_Trace_Stop();
+  else
+    Pl_Fd_Trace_Start((int) math_min(size, INT_MAX / (int) sizeof(FdTraceRec)));
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_TRACE_STOP_0                                                      *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Trace_Stop_0(void)
+{
+  Pl_Fd_Trace_Stop();
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_TRACE_DUMP_1                                                      *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Trace_Dump_1(WamWord path_word)
+{
+  char *path;
+
+  path = Pl_Rd_String_Check(path_word);
+  if ((path = Pl_M_Absolute_Path_Name(path)) == NULL)
+    Pl_Err_Domain(pl_domain_os_path, path_word);
+
+  Os_Test_Error(Pl_Fd_Trace_Dump(path));
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * UNIFY_WAKEUPS                                                           *
+ *                                                                         *
+ * Unifies the head of *list_word with Priority-N and updates *list_word   *
+ * with the tail.                                                          *
+ *-------------------------------------------------------------------------*/
+static Bool
+Unify_Wakeups(WamWord *list_word, int prio, PlULong n)
+{
+  WamWord head_word;
+
+  if (!Pl_Get_List(*list_word))
+    return FALSE;
+
+  head_word = Pl_Unify_Variable();
+  *list_word = Pl_Unify_Variable();
+
+  return Pl_Get_Structure(ATOM_CHAR('-'), 2, head_word) &&
+    Pl_Unify_Atom(prio_atom[prio]) && Pl_Unify_Integer((PlLong) n);
+}
@@ -44,40 +44,499 @@
 :- meta_predicate(fd_minimize(0, ?)).
 
 fd_minimize(Goal, Var) :-
+	'$fd_optim'(restart, min, Goal, Var, fd_minimize, 2).
+
+
+
+
+:- meta_predicate(fd_minimize(0, ?, +)).
+
+fd_minimize(Goal, Var, Options) :-
+	set_bip_name(fd_minimize, 3),
+	'$get_optim_options'(Options, Mode),
+	'$fd_optim'(Mode, min, Goal, Var, fd_minimize, 3).
+
+
+
+
+:- meta_predicate(fd_maximize(0, ?)).
+
+fd_maximize(Goal, Var) :-
+	'$fd_optim'(restart, max, Goal, Var, fd_maximize, 2).
+
+
+
+
+:- meta_predicate(fd_maximize(0, ?, +)).
+
+fd_maximize(Goal, Var, Options) :-
+	set_bip_name(fd_maximize, 3),
+	'$get_optim_options'(Options, Mode),
+	'$fd_optim'(Mode, max, Goal, Var, fd_maximize, 3).
+
+
+
+
+:- meta_predicate(fd_minimize_lns(0, ?, ?, +)).
+
+fd_minimize_lns(Goal, Var, Vars, Options) :-
+	set_bip_name(fd_minimize_lns, 4),
+	'$fd_optim_lns'(min, Goal, Var, Vars, Options, fd_minimize_lns, 4).
+
+
+
+
+:- meta_predicate(fd_maximize_lns(0, ?, ?, +)).
+
+fd_maximize_lns(Goal, Var, Vars, Options) :-
+	set_bip_name(fd_maximize_lns, 4),
+	'$fd_optim_lns'(max, Goal, Var, Vars, Options, fd_maximize_lns, 4).
+
+
+
+
+:- meta_predicate(fd_minimize_parallel(0, ?, ?, +)).
+
+fd_minimize_parallel(Goal, Var, Vars, Options) :-
+	set_bip_name(fd_minimize_parallel, 4),
+	'$fd_optim_parallel'(min, Goal, Var, Vars, Options, fd_minimize_parallel, 4).
+
+
+
+
+:- meta_predicate(fd_maximize_parallel(0, ?, ?, +)).
+
+fd_maximize_parallel(Goal, Var, Vars, Options) :-
+	set_bip_name(fd_maximize_parallel, 4),
+	'$fd_optim_parallel'(max, Goal, Var, Vars, Options, fd_maximize_parallel, 4).
+
+
+
+
+% restart: each time Goal succeeds the computation restarts with a tighter
+% bound, when it fails the last solution is recomputed since it is optimal.
+
+'$fd_optim'(restart, min, Goal, Var, Name, Arity) :-
 	fd_max_integer(Inf),
 	g_assign('$cur_min', Inf),
 	repeat,
 	g_read('$cur_min', B),
 	B1 is B - 1,
-	set_bip_name(fd_minimize, 2),
+	set_bip_name(Name, Arity),
 	(   '$fd_domain'(Var, 0, B1),
-	    '$call'(Goal, fd_minimize, 2, true) ->
+	    '$call'(Goal, Name, Arity, true) ->
 	    fd_min(Var, C),
 	    g_assign('$cur_min', C),
 	    fail
 	;   !,
 	    Var = B,
-	    '$call'(Goal, fd_minimize, 2, true)
+	    '$call'(Goal, Name, Arity, true)
 	).
 
-
-
-
-:- meta_predicate(fd_maximize(0, ?)).
-
-fd_maximize(Goal, Var) :-
+'$fd_optim'(restart, max, Goal, Var, Name, Arity) :-
 	fd_max_integer(Inf),
 	g_assign('$cur_max', 0),
 	repeat,
 	g_read('$cur_max', B),
 	B1 is B + 1,
-	set_bip_name(fd_maximize, 2),
+	set_bip_name(Name, Arity),
 	(   '$fd_domain'(Var, B1, Inf),
-	    '$call'(Goal, fd_maximize, 2, true) ->
+	    '$call'(Goal, Name, Arity, true) ->
 	    fd_max(Var, C),
 	    g_assign('$cur_max', C),
 	    fail
 	;   !,
 	    Var = B,
-	    '$call'(Goal, fd_maximize, 2, true)
+	    '$call'(Goal, Name, Arity, true)
 	).
+
+
+% incremental: a single search, at each solution the bound of Var is
+% tightened in place (told at each propagation, see Pl_Fd_Push_Bound) and
+% the search goes on from the current node. The search stops if the best
+% possible value is reached. The last solution is then restored (it is
+% copied if ground, else recomputed).
+
+'$fd_optim'(incremental, Dir, Goal, Var, Name, Arity) :-
+	'$fd_optim_start'(Dir, Var, Best, _, Depth),
+	number_atom(Depth, A),		% a global var per nesting level
+	atom_concat('$fd_optim_sol', A, Sol),
+	g_assign(Sol, none),
+	(   catch('$fd_optim_search'(Dir, Goal, Var, Best, Sol, Goal, Name, Arity), Err,
+		  ('$fd_optim_pop', throw(Err))) ->
+	    true
+	;   true
+	),
+	'$fd_optim_pop',
+	g_read(Sol, Last),
+	g_assign(Sol, none),
+	Last = sol(Goal1, C),
+	(   ground(Goal1) ->
+	    Var = C,
+	    Goal = Goal1
+	;   Var = C,
+	    '$call'(Goal, Name, Arity, true)
+	).
+
+
+% anytime: like incremental but each solution is returned as soon as it is
+% found. On backtracking the search resumes with the tighter bound, so the
+% optimality of the last solution is proved when fd_minimize/3 fails.
+
+'$fd_optim'(anytime, Dir, Goal, Var, Name, Arity) :-
+	'$fd_optim_start'(Dir, Var, Best, Offset, _),
+	(   catch('$call'(Goal, Name, Arity, true), Err,
+		  ('$fd_optim_pop', throw(Err))),
+	    '$fd_optim_solution'(Dir, Var, Min, Max, C),
+	    '$fd_optim_pop',
+	    (   C =:= Best ->
+	        !
+	    ;   true
+	    ;   '$call_c'('Pl_Fd_Resume_Bound_3'(Offset, Min, Max)),
+	        fail
+	    )
+	;   '$fd_optim_pop',
+	    fail
+	).
+
+
+
+
+'$fd_optim_start'(Dir, Var, Best, Offset, Depth) :-
+	fd_max_integer(Inf),
+	'$fd_domain'(Var, 0, Inf),
+	(   Dir = min ->
+	    fd_min(Var, Best)
+	;   fd_max(Var, Best)
+	),
+	'$call_c_test'('Pl_Fd_Push_Bound_5'(Var, 0, Inf, Offset, Depth)).
+
+
+
+
+'$fd_optim_pop' :-
+	'$call_c'('Pl_Fd_Pop_Bound_0').
+
+
+
+
+% records Template at each solution (in the global var Sol)
+
+'$fd_optim_search'(Dir, Goal, Var, Best, Sol, Template, Name, Arity) :-
+	'$call'(Goal, Name, Arity, true),
+	'$fd_optim_solution'(Dir, Var, Min, Max, C),
+	g_assign(Sol, sol(Template, C)),
+	'$call_c'('Pl_Fd_Set_Bound_2'(Min, Max)),
+	C =:= Best.
+
+
+
+
+'$fd_optim_solution'(min, Var, 0, Max, C) :-
+	fd_min(Var, C),
+	Max is C - 1.
+
+'$fd_optim_solution'(max, Var, Min, Inf, C) :-
+	fd_max(Var, C),
+	Min is C + 1,
+	fd_max_integer(Inf).
+
+
+
+
+% Large Neighbourhood Search: after a first solution, repeatedly fixes the
+% variables of Vars to their values in the best solution except a fraction
+% of them (the neighbourhood) and searches for a better solution under a
+% backtrack limit. The bound on Var is the one of the incremental mode.
+% The size of the neighbourhood adapts: it grows when the neighbourhood
+% has been fully explored without improvement, it shrinks when the limit
+% has been reached without improvement. The search stops at the time
+% limit or after the given number of iterations (or if the solution is
+% proved optimal). The best solution is then recomputed.
+
+'$fd_optim_lns'(Dir, Goal, Var, Vars, Options, Name, Arity) :-
+	'$check_list'(Vars),
+	'$get_lns_options'(Options, Time, Fails, Iters, Relax, Neighbour, Name, Arity),
+	real_time(T0),
+	Deadline is T0 + Time,
+	'$fd_optim_start'(Dir, Var, Best, _, Depth),
+	number_atom(Depth, A),
+	atom_concat('$fd_optim_sol', A, Sol),
+	atom_concat('$fd_lns_state', A, State),
+	g_assign(Sol, none),
+	(   catch('$fd_optim_lns1'(Dir, Goal, Var, Vars, Best, Sol, State,
+				   Deadline, Fails, Iters, Relax, Neighbour,
+				   Name, Arity), Err,
+		  ('$fd_lns_end', throw(Err))) ->
+	    true
+	;   true
+	),
+	'$fd_lns_end',
+	g_read(Sol, Last),
+	g_assign(Sol, none),
+	Last = sol(Vals, C), !,
+	Var = C,
+	Vars = Vals,
+	'$call'(Goal, Name, Arity, true), !.
+
+
+'$fd_optim_lns1'(Dir, Goal, Var, Vars, Best, Sol, State, Deadline,
+		 Fails, Iters, Relax, Neighbour, Name, Arity) :-
+	\+ \+ '$fd_lns_first'(Dir, Goal, Var, Vars, Sol, Deadline, Name, Arity),
+	g_read(Sol, sol(_, C0)),
+	(   C0 =:= Best ->
+	    Stop0 = true
+	;   Stop0 = false
+	),
+	g_assign(State, lns(Relax, 0, Stop0)),
+	length(Vars, N),
+	repeat,
+	g_read(State, lns(Relax1, I, Stop)),
+	real_time(T),
+	(   ( Stop = true ; I =:= Iters ; T >= Deadline ) ->
+	    !
+	;   I1 is I + 1,
+	    g_read(Sol, sol(Vals, C)),
+	    '$call_c'('Pl_Fd_Set_Search_Limit_2'(0, 0)),
+	    (   '$fd_lns_fix'(Neighbour, Vars, Vals, N, Relax1),
+	        '$fd_lns_search'(Dir, Goal, Var, Vars, Best, Sol, Deadline, Fails,
+				 Name, Arity) ->
+	        Res = optimal
+	    ;   '$call_c_test'('Pl_Fd_Search_Limit_Reached_0') ->
+	        Res = limit
+	    ;   Res = exhausted
+	    ),
+	    g_read(Sol, sol(_, C1)),
+	    '$fd_lns_adapt'(Res, C1, C, Relax1, Relax2, Stop1),
+	    g_assign(State, lns(Relax2, I1, Stop1)),
+	    fail
+	).
+
+
+
+
+'$fd_lns_first'(Dir, Goal, Var, Vars, Sol, Deadline, Name, Arity) :-
+	real_time(T),
+	Time is max(Deadline - T, 1),
+	'$call_c'('Pl_Fd_Set_Search_Limit_2'(0, Time)),
+	'$call'(Goal, Name, Arity, true),
+	'$fd_optim_solution'(Dir, Var, Min, Max, C),
+	g_assign(Sol, sol(Vars, C)),
+	'$call_c'('Pl_Fd_Set_Bound_2'(Min, Max)), !.
+
+
+
+
+% succeeds if the search has stopped because the best value is reached,
+% fails otherwise (see Pl_Fd_Search_Limit_Reached_0 to know if the limit
+% has been reached)
+
+'$fd_lns_search'(Dir, Goal, Var, Vars, Best, Sol, Deadline, Fails, Name, Arity) :-
+	real_time(T),
+	Time is max(Deadline - T, 1),
+	'$call_c'('Pl_Fd_Set_Search_Limit_2'(Fails, Time)),
+	'$fd_optim_search'(Dir, Goal, Var, Best, Sol, Vars, Name, Arity).
+
+
+
+
+'$fd_lns_end' :-
+	'$call_c'('Pl_Fd_Set_Search_Limit_2'(0, 0)),
+	'$fd_optim_pop'.
+
+
+
+
+% the neighbourhood: Relax % of the variables are not fixed, either chosen
+% at random or a block of consecutive variables (starting at random)
+
+'$fd_lns_fix'(random, Vars, Vals, _, Relax) :-
+	'$fd_lns_fix_random'(Vars, Vals, Relax).
+
+'$fd_lns_fix'(block, Vars, Vals, N, Relax) :-
+	K is max(1, N * Relax // 100),
+	random(0, N, Start),
+	End is Start + K,
+	End1 is End - N,
+	'$fd_lns_fix_block'(Vars, Vals, 0, Start, End, End1).
+
+
+'$fd_lns_fix_random'([], [], _).
+
+'$fd_lns_fix_random'([X|Vars], [V|Vals], Relax) :-
+	random(0, 100, R),
+	(   R < Relax ->
+	    true
+	;   X = V
+	),
+	'$fd_lns_fix_random'(Vars, Vals, Relax).
+
+
+'$fd_lns_fix_block'([], [], _, _, _, _).
+
+'$fd_lns_fix_block'([X|Vars], [V|Vals], I, Start, End, End1) :-
+	(   ( I >= Start, I < End ; I < End1 ) ->
+	    true
+	;   X = V
+	),
+	I1 is I + 1,
+	'$fd_lns_fix_block'(Vars, Vals, I1, Start, End, End1).
+
+
+
+
+'$fd_lns_adapt'(optimal, _, _, Relax, Relax, true) :-
+	!.			% best value reached
+
+'$fd_lns_adapt'(_, C1, C, Relax, Relax, false) :-
+	C1 =\= C, !.		% improved: keep the size
+
+'$fd_lns_adapt'(exhausted, _, _, Relax, Relax1, Stop) :-
+	!,			% fully explored: enlarge
+	(   Relax >= 100 ->	% the whole search space: optimal
+	    Relax1 = 100,
+	    Stop = true
+	;   Relax1 is min(100, Relax + 10),
+	    Stop = false
+	).
+
+'$fd_lns_adapt'(limit, _, _, Relax, Relax1, false) :-
+	Relax1 is max(1, Relax - 5).	% limit reached: shrink
+
+
+
+
+% Parallel optimization: the search tree is split on a prefix of Vars and
+% the subtrees are explored by worker processes (see '$fd_par'/4). In each
+% subtree the worker uses the incremental mode, starting with the bound of
+% the best solution known by the master when the path is handed out.
+
+'$fd_optim_parallel'(Dir, Goal, Var, Vars, Options, Name, Arity) :-
+	'$check_list'(Vars),
+	'$get_parallel_options'(Options, NbWorkers, Others, Name, Arity),
+	(   Others = [X|_] ->
+	    (   var(X) ->
+		'$pl_err_instantiation'
+	    ;   '$pl_err_domain'(fd_parallel_option, X)
+	    )
+	;   true
+	),
+	fd_max_integer(Inf),
+	'$fd_domain'(Var, 0, Inf),
+	(   Dir = min ->
+	    fd_min(Var, Best)
+	;   fd_max(Var, Best)
+	),
+	'$fd_par'(optim(Dir, Goal, Var, Vars, Best, Name, Arity), Vars, [], NbWorkers).
+
+
+
+
+'$fd_par_optim_task'(Dir, Goal, Var, Vars, Name, Arity, Prefix, Path, Bound, Res) :-
+	findall(sol(Vars, C),
+		(   Prefix = Path,
+		    '$fd_par_optim_bound'(Bound, Dir, Var),
+		    '$fd_optim'(incremental, Dir, Goal, Var, Name, Arity), !,
+		    C = Var
+		), L),
+	(   L = [Res] ->
+	    true
+	;   Res = none
+	).
+
+
+
+
+'$fd_par_optim_bound'(none, _, _) :-
+	!.
+
+'$fd_par_optim_bound'(B, min, Var) :-
+	B1 is B - 1,
+	'$fd_domain'(Var, 0, B1).
+
+'$fd_par_optim_bound'(B, max, Var) :-
+	fd_max_integer(Inf),
+	B1 is B + 1,
+	'$fd_domain'(Var, B1, Inf).
+
+
+
+
+'$get_optim_options'(Options, Mode) :-
+	'$check_list'(Options),
+	'$get_optim_options1'(Options, restart, Mode).
+
+
+'$get_optim_options1'([], Mode, Mode).
+
+'$get_optim_options1'([X|Options], Mode0, Mode) :-
+	'$get_optim_options2'(X, Mode0, Mode1), !,
+	'$get_optim_options1'(Options, Mode1, Mode).
+
+
+'$get_optim_options2'(X, _, _) :-
+	var(X),
+	'$pl_err_instantiation'.
+
+'$get_optim_options2'(mode(X), _, X) :-
+	'$check_nonvar'(X),
+	(   X = restart
+	;   X = incremental
+	;   X = anytime
+	).
+
+'$get_optim_options2'(X, _, _) :-
+	'$pl_err_domain'(fd_optim_option, X).
+
+
+
+
+'$get_lns_options'(Options, Time, Fails, Iters, Relax, Neighbour, Name, Arity) :-
+	'$check_list'(Options),
+	'$get_lns_options1'(Options, lns(10000, 100, -1, 30, random),
+			    lns(Time, Fails, Iters, Relax, Neighbour), Name, Arity),
+	set_bip_name(Name, Arity).
+
+
+'$get_lns_options1'([], Lns, Lns, _, _).
+
+'$get_lns_options1'([X|Options], Lns0, Lns, Name, Arity) :-
+	(   nonvar(X),
+	    '$get_lns_options2'(X, Lns0, Lns1) ->
+	    true
+	;   set_bip_name(Name, Arity),	% reset by arithmetic
+	    (   var(X) ->
+		'$pl_err_instantiation'
+	    ;   '$pl_err_domain'(fd_lns_option, X)
+	    )
+	),
+	'$get_lns_options1'(Options, Lns1, Lns, Name, Arity).
+
+
+'$get_lns_options2'(time_limit(X), lns(_, F, I, R, N), lns(X, F, I, R, N)) :-
+	integer(X),
+	X > 0.
+
+'$get_lns_options2'(fail_limit(X), lns(T, _, I, R, N), lns(T, X, I, R, N)) :-
+	integer(X),
+	X > 0.
+
+'$get_lns_options2'(iterations(X), lns(T, F, _, R, N), lns(T, F, X, R, N)) :-
+	integer(X),
+	X >= 0.
+
+'$get_lns_options2'(relax(X), lns(T, F, I, _, N), lns(T, F, I, X, N)) :-
+	integer(X),
+	X >= 1,
+	X =< 100.
+
+'$get_lns_options2'(neighbourhood(X), lns(T, F, I, R, _), lns(T, F, I, R, X)) :-
+	(   X == random
+	;   X == block
+	).
+
+'$get_lns_options2'(seed(X), Lns, Lns) :-
+	integer(X),
+	X >= 0,
+	set_seed(X).
+
@@ -0,0 +1,133 @@
+/*-------------------------------------------------------------------------*
+ * GNU Prolog                                                              *
+ *                                                                         *
+ * Part  : FD constraint solver buit-in predicates                         *
+ * File  : fd_optim_c.c                                                    *
+ * Descr.: optimization predicate management - C part                      *
+ * Author: Daniel Diaz                                                     *
+ *                                                                         *
+ * Copyright (C) 1999-2023 Daniel Diaz                                     *
+ *                                                                         *
+ * This file is part of GNU Prolog                                         *
+ *                                                                         *
+ * GNU Prolog is free software: you can redistribute it and/or             *
+ * modify it under the terms of either:                                    *
+ *                                                                         *
+ *   - the GNU Lesser General Public License as published by the Free      *
+ *     Software Foundation; either version 3 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or                                                                      *
+ *                                                                         *
+ *   - the GNU General Public License as published by the Free             *
+ *     Software Foundation; either version 2 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or both in parallel, as here.                                           *
+ *                                                                         *
+ * GNU Prolog is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ * General Public License for more details.                                *
+ *                                                                         *
+ * You should have received copies of the GNU General Public License and   *
+ * the GNU Lesser General Public License along with this program.  If      *
+ * not, see http://www.gnu.org/licenses/.                                  *
+ *-------------------------------------------------------------------------*/
+
+
+#include "engine_pl.h"
+#include "engine_fd.h"
+
+#include "bips_pl.h"
+#include "bips_fd.h"
+
+
+/*---------------------------------*
+ * Constants                       *
+ *---------------------------------*/
+
+/*---------------------------------*
+ * Type Definitions                *
+ *---------------------------------*/
+
+/*---------------------------------*
+ * Global Variables                *
+ *---------------------------------*/
+
+
+/*---------------------------------*
+ * Function Prototypes             *
+ *---------------------------------*/
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_PUSH_BOUND_5                                                      *
+ *                                                                         *
+ * Pushes the bound min..max of the objective fdv_word (see fd_inst.c).    *
+ * Unifies offset_word with the offset of its FD var in the constraint     *
+ * stack (to push it again with Pl_Fd_Resume_Bound_3) and depth_word with  *
+ * the number of bounds in the stack.                                      *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Push_Bound_5(WamWord fdv_word, WamWord min_word, WamWord max_word,
+		   WamWord offset_word, WamWord depth_word)
+{
+  WamWord *fdv_adr = Pl_Fd_Prolog_To_Fd_Var(fdv_word, TRUE);
+  PlLong min = Pl_Rd_Integer_Check(min_word);
+  PlLong max = Pl_Rd_Integer_Check(max_word);
+  int depth;
+
+  depth = Pl_Fd_Push_Bound(fdv_adr, min, max);
+
+  return Pl_Un_Integer_Check(Cstr_Offset(fdv_adr), offset_word) &&
+    Pl_Un_Integer_Check(depth, depth_word);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_RESUME_BOUND_3                                                    *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Resume_Bound_3(WamWord offset_word, WamWord min_word, WamWord max_word)
+{
+  WamWord *fdv_adr = Cstr_Stack + Pl_Rd_Integer_Check(offset_word);
+  PlLong min = Pl_Rd_Integer_Check(min_word);
+  PlLong max = Pl_Rd_Integer_Check(max_word);
+
+  Pl_Fd_Push_Bound(fdv_adr, min, max);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_POP_BOUND_0                                                       *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Pop_Bound_0(void)
+{
+  Pl_Fd_Pop_Bound();
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_SET_BOUND_2                                                       *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Set_Bound_2(WamWord min_word, WamWord max_word)
+{
+  PlLong min = Pl_Rd_Integer_Check(min_word);
+  PlLong max = Pl_Rd_Integer_Check(max_word);
+
+  Pl_Fd_Set_Bound(min, max);
+}
@@ -41,9 +41,72 @@
 '$use_fd_symbolic'.
 
 
-fd_all_different(L) :-
+fd_all_different(List) :-
 	set_bip_name(fd_all_different, 1),
-	'$call_c_test'('Pl_Fd_All_Different_1'(L, L)).
+	'$fd_all_different'(List, value).
+
+
+fd_all_different(List, Options) :-
+	set_bip_name(fd_all_different, 2),
+	'$get_all_different_options'(Options, Consistency),
+	'$fd_all_different'(List, Consistency).
+
+
+'$fd_all_different'(List, Consistency) :-
+	'$fd_all_different_work'(List, Work),
+	'$fd_all_different1'(Consistency, List, Work).
+
+
+'$fd_all_different1'(value, List, Work) :-
+	fd_tell(pl_fd_all_different_value(List, Work)).
+
+'$fd_all_different1'(bounds, List, Work) :-
+	fd_tell(pl_fd_all_different_bounds(List, Work)).
+
+'$fd_all_different1'(domain, List, Work) :-
+	fd_tell(pl_fd_all_different_domain(List, Work)).
+
+
+
+
+% The work list is copied in the constraint frame and is used by the C part
+% (see fd_symbolic_c.c): 1 cell for a stamp + 1 cell per variable.
+
+'$fd_all_different_work'(List, [0|Work]) :-
+	nonvar(List),
+	List = [_|List1], !,
+	'$fd_all_different_work'(List1, Work).
+
+'$fd_all_different_work'(_, [0]).
+
+
+
+
+'$get_all_different_options'(Options, Consistency) :-
+	'$check_list'(Options),
+	'$get_all_different_options1'(Options, value, Consistency).
+
+
+'$get_all_different_options1'([], Consistency, Consistency).
+
+'$get_all_different_options1'([X|Options], Consistency0, Consistency) :-
+	'$get_all_different_options2'(X, Consistency0, Consistency1), !,
+	'$get_all_different_options1'(Options, Consistency1, Consistency).
+
+
+'$get_all_different_options2'(X, _, _) :-
+	var(X),
+	'$pl_err_instantiation'.
+
+'$get_all_different_options2'(consistency(X), _, X) :-
+	'$check_nonvar'(X),
+	(   X = value
+	;   X = bounds
+	;   X = domain
+	).
+
+'$get_all_different_options2'(X, _, _) :-
+	'$pl_err_domain'(fd_all_different_option, X).
 
 
 
@@ -53,7 +116,7 @@ fd_element(I, List, V) :-
 
 
 '$fd_element'(I, List, V) :-
-	fd_tell(pl_fd_element(I, List, V)).
+	'$call_c_test'('Pl_Fd_Element_3'(I, List, V)).
 
 
 
@@ -67,21 +130,21 @@ fd_element_var(I, List, V) :-
 
 fd_atmost(N, List, V) :-
 	set_bip_name(fd_atmost, 3),
-	fd_tell(pl_fd_atmost(N, List, V)).
+	'$call_c_test'('Pl_Fd_Count_4'(N, List, V, 0)).
 
 
 
 
 fd_atleast(N, List, V) :-
 	set_bip_name(fd_atleast, 3),
-	fd_tell(pl_fd_atleast(N, List, V)).
+	'$call_c_test'('Pl_Fd_Count_4'(N, List, V, 1)).
 
 
 
 
 fd_exactly(N, List, V) :-
 	set_bip_name(fd_exactly, 3),
-	fd_tell(pl_fd_exactly(N, List, V)).
+	'$call_c_test'('Pl_Fd_Count_4'(N, List, V, 2)).
 
 
 
@@ -90,8 +153,14 @@ fd_relation(Tuples, Vars) :-
 	set_bip_name(fd_relation, 2),
 	'$check_list'(Tuples),
 	'$check_list_or_partial_list'(Vars),
-	'$lines_to_columns'(Tuples, CTuples),
-	'$fd_relationc1'(CTuples, Vars, _).
+	(   Tuples = [Tuple|_] ->
+	    '$check_list'(Tuple),
+	    length(Tuple, N),
+	    length(Vars, N)
+	;   true
+	),
+	'$call_c_test'('Pl_Fd_Relation_3'(Tuples, Vars, 0)).
+
 
 
 
@@ -99,31 +168,186 @@ fd_relationc(CTuples, Vars) :-
 	set_bip_name(fd_relationc, 2),
 	'$check_list'(CTuples),
 	'$check_list_or_partial_list'(Vars),
-	'$fd_relationc1'(CTuples, Vars, _).
+	length(CTuples, N),
+	length(Vars, N),
+	'$call_c_test'('Pl_Fd_Relation_3'(CTuples, Vars, 1)).
+
+
+
+
+fd_cumulative(Starts, Durations, Demands, Capacity) :-
+	set_bip_name(fd_cumulative, 4),
+	'$fd_cumulative'(Starts, Durations, Demands, Capacity, fd_cumulative/4).
+
+
+fd_disjunctive(Starts, Durations) :-
+	set_bip_name(fd_disjunctive, 2),
+	'$check_list'(Durations),
+	'$fd_cumulative_ones'(Durations, Demands),
+	'$fd_cumulative'(Starts, Durations, Demands, 1, fd_disjunctive/2).
+
+
+'$fd_cumulative'(Starts, Durations, Demands, Capacity, Bip) :-
+	'$check_list'(Starts),
+	'$check_list'(Durations),
+	'$check_list'(Demands),
+	'$fd_cumulative_check'(Durations, Bip),
+	'$fd_cumulative_check'(Demands, Bip),
+	'$fd_cumulative_check'([Capacity], Bip),
+	Bip = Name / Arity,
+	set_bip_name(Name, Arity),
+	length(Starts, N),
+	length(Durations, N),
+	length(Demands, N),
+	fd_tell(pl_fd_cumulative(Starts, Durations, Demands, Capacity, [0])).
+
+
+
+
+'$fd_cumulative_ones'([], []).
+
+'$fd_cumulative_ones'([_|L], [1|L1]) :-
+	'$fd_cumulative_ones'(L, L1).
+
+
+
+
+% the arithmetic test changes the bip name, restore it for the errors
+
+'$fd_cumulative_check'([], _).
+
+'$fd_cumulative_check'([X|L], Bip) :-
+	(   integer(X),
+	    X >= 0 ->
+	    '$fd_cumulative_check'(L, Bip)
+	;   Bip = Name / Arity,
+	    set_bip_name(Name, Arity),
+	    '$check_nonvar'(X),
+	    (   integer(X) ->
+	        '$pl_err_domain'(not_less_than_zero, X)
+	    ;   '$pl_err_type'(integer, X)
+	    )
+	).
+
+
+
+
+fd_circuit(List) :-
+	set_bip_name(fd_circuit, 1),
+	'$fd_circuit'(List, 0).
+
+
+fd_subcircuit(List) :-
+	set_bip_name(fd_subcircuit, 1),
+	'$fd_circuit'(List, 1).
+
+
+'$fd_circuit'(List, Sub) :-
+	'$check_list'(List),
+	length(List, N),
+	'$call_c_test'('Pl_Fd_Domain_3'(List, 1, N)),
+	'$fd_all_different'(List, domain),
+	fd_tell(pl_fd_circuit(List, Sub, [0])).
+
+
+
+
+fd_global_cardinality(Vars, Pairs) :-
+	set_bip_name(fd_global_cardinality, 2),
+	'$fd_global_cardinality'(Vars, Pairs, domain).
+
+
+fd_global_cardinality(Vars, Pairs, Options) :-
+	set_bip_name(fd_global_cardinality, 3),
+	'$get_global_cardinality_options'(Options, Consistency),
+	'$fd_global_cardinality'(Vars, Pairs, Consistency).
+
+
+'$fd_global_cardinality'(Vars, Pairs, Consistency) :-
+	'$check_list'(Vars),
+	'$check_list'(Pairs),
+	'$fd_gcc_check_pairs'(Pairs),
+	'$sys_var_write'(0, 2),                     % keysort (keeps the bip name)
+	'$call_c_test'('Pl_Sort_List_2'(Pairs, Pairs1)),
+	'$fd_gcc_keys'(Pairs1, Keys, Counts),
+	length(Vars, N),
+	'$call_c_test'('Pl_Fd_Domain_2'(Vars, Keys)),
+	'$call_c_test'('Pl_Fd_Domain_3'(Counts, 0, N)),
+	'$fd_gcc_sum'(Counts, Sum),
+	Sum #= N,
+	'$fd_all_different_work'(Vars, Work),
+	'$fd_global_cardinality1'(Consistency, Vars, Keys, Counts, Work).
+
+
+'$fd_global_cardinality1'(bounds, Vars, Keys, Counts, Work) :-
+	fd_tell(pl_fd_global_cardinality_bounds(Vars, Keys, Counts, Work)).
+
+'$fd_global_cardinality1'(domain, Vars, Keys, Counts, Work) :-
+	fd_tell(pl_fd_global_cardinality_domain(Vars, Keys, Counts, Work)).
+
+
+
+
+'$fd_gcc_check_pairs'([]).
+
+'$fd_gcc_check_pairs'([P|Pairs]) :-
+	'$check_nonvar'(P),
+	(   P = Key - _ ->
+	    '$check_nonvar'(Key),
+	    (   integer(Key) ->
+	        true
+	    ;   '$pl_err_type'(integer, Key)
+	    )
+	;   '$pl_err_type'(pair, P)
+	),
+	'$fd_gcc_check_pairs'(Pairs).
+
+
+
+
+% a key given several times: all its counts are equal
+
+'$fd_gcc_keys'([], [], []).
+
+'$fd_gcc_keys'([Key - Count, Key - Count1|Pairs], Keys, Counts) :- !,
+	Count #= Count1,
+	'$fd_gcc_keys'([Key - Count|Pairs], Keys, Counts).
+
+'$fd_gcc_keys'([Key - Count|Pairs], [Key|Keys], [Count|Counts]) :-
+	'$fd_gcc_keys'(Pairs, Keys, Counts).
+
 
 
 
+'$fd_gcc_sum'([], 0).
 
-'$fd_relationc1'([], [], _).
+'$fd_gcc_sum'([Count|Counts], Count + Sum) :-
+	'$fd_gcc_sum'(Counts, Sum).
 
-'$fd_relationc1'([C|CTuples], [X|Vars], R) :-
-	'$fd_element'(R, C, X),
-	'$fd_relationc1'(CTuples, Vars, R).
 
 
 
+'$get_global_cardinality_options'(Options, Consistency) :-
+	'$check_list'(Options),
+	'$get_global_cardinality_options1'(Options, domain, Consistency).
 
-'$lines_to_columns'([[]|_], []) :-
-	!.
 
-'$lines_to_columns'(Tuples, [Column|Columns]) :-
-	'$create_column'(Tuples, Column, Tuples1),
-	'$lines_to_columns'(Tuples1, Columns).
+'$get_global_cardinality_options1'([], Consistency, Consistency).
 
+'$get_global_cardinality_options1'([X|Options], Consistency0, Consistency) :-
+	'$get_global_cardinality_options2'(X, Consistency0, Consistency1), !,
+	'$get_global_cardinality_options1'(Options, Consistency1, Consistency).
 
 
+'$get_global_cardinality_options2'(X, _, _) :-
+	var(X),
+	'$pl_err_instantiation'.
 
-'$create_column'([], [], []).
+'$get_global_cardinality_options2'(consistency(X), _, X) :-
+	'$check_nonvar'(X),
+	(   X = bounds
+	;   X = domain
+	).
 
-'$create_column'([[X|L]|Tuples], [X|Column], [L|Tuples1]) :-
-	'$create_column'(Tuples, Column, Tuples1).
+'$get_global_cardinality_options2'(X, _, _) :-
+	'$pl_err_domain'(fd_global_cardinality_option, X).
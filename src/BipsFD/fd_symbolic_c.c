@@ -36,6 +36,9 @@
  *-------------------------------------------------------------------------*/
 
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "engine_pl.h"
 #include "bips_pl.h"
 
@@ -49,329 +52,3256 @@
  * Constants                       *
  *---------------------------------*/
 
+	  /* fd_all_different work array (see fd_symbolic.pl) */
+
+#define ALL_DIFF_STAMP             1 /* size stamp at the last fix-point */
+#define ALL_DIFF_CELLS             2 /* 1 cell per var: done flag / mate */
+
+	  /* fd_cumulative work array (see fd_symbolic.pl) */
+
+#define CUMUL_STAMP                1 /* bounds stamp at the last fix-point */
+
+	  /* fd_circuit/fd_subcircuit work array (see fd_symbolic.pl) */
+
+#define CIRCUIT_STAMP              1 /* size stamp at the last fix-point */
+
+#define CIRCUIT_HAS_PRED           1 /* marks of a node (Circuit_Chains) */
+#define CIRCUIT_VISITED            2
+#define CIRCUIT_CYCLE              4
+
+	  /* fd_global_cardinality work array (see fd_symbolic.pl) */
+
+#define GCC_STAMP                  1 /* size stamp at the last fix-point */
+#define GCC_CELLS                  2 /* 1 cell per var: 1 + key of its mate */
+
+	  /* fd_atmost/fd_atleast/fd_exactly A frame */
+
+#define COUNT_NB_VAR               0
+#define COUNT_VALUE                1
+#define COUNT_LOW                  2 /* bounds of the nb of vars = value */
+#define COUNT_HIGH                 3
+#define COUNT_NB_FIXED             4 /* trailed: nb of vars = value */
+#define COUNT_NB_POSSIBLE          5 /* trailed: nb of vars which can be = */
+#define COUNT_VARS                 6
+
+#define COUNT_V_AF                 0 /* a variable: the A frame of the */
+#define COUNT_V_FDV                1 /* cstr, the FD var and its state */
+#define COUNT_V_STATE              2
+#define COUNT_V_SIZE               3
+
+#define COUNT_POSSIBLE             0 /* states of a variable */
+#define COUNT_FIXED                1
+#define COUNT_EXCLUDED             2
+
+
+
+
 /*---------------------------------*
  * Type Definitions                *
  *---------------------------------*/
 
+typedef struct			/* an interval for the bounds filtering */
+{
+  WamWord *fdv_adr;
+  PlLong min, max;
+  int min_rank, max_rank;
+}
+AllDiffInterv;
+
+
+
+
+typedef struct			/* a value of a variable in a relation */
+{
+  PlLong value;
+  int residue;			/* last word found with a support */
+  VecWord *support;		/* tuples (bitset) having this value */
+}
+RelVal;
+
+
+typedef struct			/* a variable of a relation */
+{
+  int nb_val;
+  RelVal *val;			/* sorted by value */
+}
+RelVar;
+
+
+typedef struct			/* a relation (Compact-Table propagator) */
+{
+  int nb_var;
+  int nb_word;
+  WamWord limit;		/* trailed: nb of non-zero words (in index) */
+  WamWord *cur;			/* current tuples: (stamp, word) for each word */
+  int *index;			/* sparse set: the non-zero words first */
+  WamWord *last_size;		/* trailed: domain size at the last call */
+  RelVar *var;
+}
+Relation;
+
+
+
+
+typedef struct			/* a task of a cumulative resource */
+{
+  WamWord *fdv_adr;
+  PlLong dur;
+  PlLong dem;
+  PlLong energy;		/* dur * dem */
+  PlLong est;			/* time window (possibly mirrored) */
+  PlLong lct;
+  PlLong new_est;		/* deduced earliest start */
+  PlLong dupd;			/* edge-finding updates */
+  PlLong slupd;
+  PlLong e_cut;
+}
+CumulTask;
+
+
+typedef struct			/* a start or end of a compulsory part */
+{
+  PlLong time;
+  PlLong delta;
+}
+CumulEvent;
+
+
+
+
+typedef struct			/* an fd_element/3 constraint */
+{
+  WamWord *i_adr;
+  WamWord *v_adr;
+  int n;
+  int nb_val;
+  PlLong *val;			/* the distinct values (sorted) */
+  int *val_no;			/* value number of each index (from 1) */
+  int *first;			/* indices of value k: occ[first[k]..] */
+  int *occ;
+  WamWord *count;		/* trailed: nb of indices in I of value k */
+  int *i_set;			/* sparse set: indices of I first */
+  WamWord i_limit;		/* trailed */
+  int *v_set;			/* sparse set: value numbers of V first */
+  WamWord v_limit;		/* trailed */
+}
+Element;
+
+
+
+
 /*---------------------------------*
  * Global Variables                *
  *---------------------------------*/
 
+static int ad_nb_var;		/* size of the per var work arrays */
+static int ad_nb_val;		/* size of the per value work arrays */
+
+static AllDiffInterv *ad_interv;
+static AllDiffInterv **ad_min_sorted;
+static AllDiffInterv **ad_max_sorted;
+static PlLong *ad_bounds;	/* these 4 arrays have 2 * n + 2 elements */
+static int *ad_t;
+static PlLong *ad_d;
+static int *ad_h;
+
+static int ad_val_min;		/* values are stored as value - ad_val_min */
+static int *ad_val_to_var;	/* variable matched to a value (or -1) */
+static int *ad_val_visit;	/* visit marks for augmenting paths */
+static int ad_visit_stamp;
+static int *ad_mate;		/* value matched to a variable */
+static int *ad_index;		/* Tarjan's SCC (on variables) */
+static int *ad_low;
+static int *ad_stack;
+static int ad_stack_top;
+static int *ad_order;		/* vars grouped by SCC (completion order) */
+static int ad_nb_order;
+static int ad_index_counter;
+static int *ad_comp;
+static int ad_nb_comp;
+static Bool *ad_comp_free;	/* SCC can reach a free value ? */
+
+static int el_size;		/* size of el_buff */
+static PlLong *el_buff;		/* values to remove (fd_element) */
+
+static int rel_nb_word;		/* size of rel_mask */
+static VecWord *rel_mask;
+
+static int cu_nb_task;		/* size of the per task work arrays */
+static CumulTask *cu_task;
+static CumulTask **cu_by_est;
+static CumulTask **cu_by_lct;
+static CumulEvent *cu_event;	/* these 4 arrays have 2 * n elements */
+static PlLong *cu_seg_start;	/* time-table profile: segments with */
+static PlLong *cu_seg_end;	/* a non-zero height */
+static PlLong *cu_seg_height;
+static int cu_nb_seg;
+
+static int ci_nb_node;		/* size of the per node work arrays */
+static int ci_nb_arc;		/* size of the arc arrays */
+static int *ci_next;		/* fixed successor of a node (or -1) */
+static int *ci_mark;
+static int *ci_out_beg;		/* the graph (without self loops) as */
+static int *ci_out;		/* successor and predecessor lists */
+static int *ci_in_beg;		/* (ci_xxx_beg arrays have n + 1 elements) */
+static int *ci_in;
+static int *ci_index;		/* Tarjan's SCC */
+static int *ci_low;
+static int *ci_stack;
+static int ci_stack_top;
+static int ci_index_counter;
+static int *ci_comp;
+static int ci_nb_comp;
+static int *ci_order;		/* dominators: nodes in DFS postorder */
+static int *ci_po_num;		/* postorder number (or -1 if unreachable) */
+static int *ci_idom;		/* immediate dominator (or -1) */
+static int *ci_child;		/* dominator tree: first child/next sibling */
+static int *ci_sibling;
+static int *ci_pre;		/* dominator tree: pre/post numbers */
+static int *ci_post;
+static int ci_counter;
+
+static int gc_nb_var;		/* size of the per var work arrays */
+static int gc_nb_key;		/* size of the per key work arrays */
+static WamWord **gc_array;	/* the current constraint: */
+static PlLong *gc_key;		/* vars, sorted keys (values) */
+static int gc_n;		/* and their number */
+static int gc_m;
+static Bool gc_bounds;		/* keys of a var: all those in min..max ? */
+static int *gc_mate;		/* the flow: key of a var (or -1) */
+static int *gc_next;		/* doubly linked list of the vars of a key */
+static int *gc_prev;
+static int *gc_first;
+static int *gc_flow;		/* nb of vars of a key */
+static PlLong *gc_low;		/* bounds of the count of a key */
+static PlLong *gc_up;
+static int *gc_visit;		/* visit marks of keys (augmenting paths) */
+static int gc_visit_stamp;
+static int *gc_fixed;		/* count filtering */
+static int *gc_possible;
+static int *gc_index;		/* Tarjan's SCC on vars, keys and the sink */
+static int *gc_low_link;
+static int *gc_stack;
+static int gc_stack_top;
+static int gc_index_counter;
+static int *gc_comp;
+static int gc_nb_comp;
+
+
+
+
 /*---------------------------------*
  * Function Prototypes             *
  *---------------------------------*/
 
-static Bool Fd_All_Different_Rec(WamWord list_word, PlLong x_tag, WamWord x_word,
-				 WamWord save_list_word);
+static void All_Diff_Alloc(int n, int nb_val);
+
+static PlLong All_Diff_Stamp(WamWord **array, int n, Bool bounds_only,
+			     PlLong *val_min, PlLong *val_max);
+
+static Bool All_Diff_Filter_Bounds(WamWord **array, int n);
+
+static int All_Diff_Cmp_Min(const void *p1, const void *p2);
+
+static int All_Diff_Cmp_Max(const void *p1, const void *p2);
+
+static void All_Diff_Sort(int n, int *nb_bounds);
+
+static Bool All_Diff_Filter_Lower(int n, int nb_bounds);
+
+static Bool All_Diff_Filter_Upper(int n, int nb_bounds);
+
+static Bool All_Diff_Filter_Domain(WamWord **array, int n, WamWord *mate);
+
+static Bool All_Diff_Augment(WamWord **array, int x);
+
+static void All_Diff_Scc(WamWord **array, int x);
+
+static int Element_Find_Val(Element *elem, PlLong value);
+
+static PlLong Element_Propagate(WamWord *AF);
+
+static Bool Element_Remove(WamWord *fdv_adr, PlLong *val, int nb);
+
+static int Count_State(WamWord *fdv_adr, PlLong v);
+
+static void Count_Update(WamWord *AF, WamWord *t);
+
+static PlLong Count_Var_Propagate(WamWord *t);
+
+static PlLong Count_Filter(WamWord *AF);
+
+static int Relation_Read_Table(WamWord tuples_word, int nb_var, Bool by_column,
+			       PlLong *table);
+
+static void *Cs_Alloc(int size);
+
+static Relation *Relation_Create(WamWord **array, int nb_tuple, PlLong *table);
+
+static int Relation_Cmp_Int(const void *p1, const void *p2);
+
+static RelVal *Relation_Find_Val(RelVar *rv, PlLong value);
+
+static PlLong Relation_Propagate(WamWord *AF);
+
+static Bool Relation_Update_Table(Relation *rel, WamWord *fdv_adr, RelVar *rv);
+
+static Bool Relation_Has_Support(Relation *rel, RelVal *val);
+
+static void Cumul_Alloc(int n);
+
+static PlLong Cumul_Stamp(WamWord **array, int n);
+
+static Bool Cumul_Filter(int nb, PlLong capa, Bool mirror, Bool *changed);
+
+static Bool Cumul_Time_Table(int nb, PlLong capa);
+
+static Bool Cumul_Edge_Finding(int nb, PlLong capa);
+
+static int Cumul_Cmp_Event(const void *p1, const void *p2);
+
+static int Cumul_Cmp_Est(const void *p1, const void *p2);
+
+static int Cumul_Cmp_Lct(const void *p1, const void *p2);
+
+static void Circuit_Alloc(int n, int nb_arc);
+
+static Bool Circuit_Filter(WamWord **array, int n, Bool sub);
+
+static Bool Circuit_Chains(WamWord **array, int n, Bool sub);
+
+static void Circuit_Graph(WamWord **array, int n);
+
+static Bool Circuit_Filter_Scc(WamWord **array, int n, Bool sub);
+
+static void Circuit_Scc(int x);
+
+static Bool Circuit_Filter_Dom(WamWord **array, int n, int root, Bool reverse);
+
+static void Circuit_Dominators(int n, int root, int *succ_beg, int *succ,
+			       int *pred_beg, int *pred);
+
+static void Circuit_Dfs(int x, int *succ_beg, int *succ);
+
+static void Circuit_Dom_Number(int x);
+
+static void Gcc_Alloc(int n, int m);
+
+static Bool Gcc_Filter(WamWord *work, WamWord **counts);
+
+static int Gcc_Next_Key(int x, int k);
+
+static void Gcc_Assign(int x, int k);
+
+static Bool Gcc_Augment_Up(int x);
+
+static Bool Gcc_Augment_Low(int k);
+
+static void Gcc_Scc(int x);
+
+
+#define Ci_Dominates(x, y)						\
+  (ci_pre[x] <= ci_pre[y] && ci_post[y] <= ci_post[x])
+
+
+	  /* is the kth key a possible value of the var x ? */
+
+#define Gcc_Is_Key(x, k)						\
+  (gc_key[k] >= Min(gc_array[x]) && gc_key[k] <= Max(gc_array[x]) &&	\
+   (gc_bounds || Pl_Range_Test_Value(Range(gc_array[x]), gc_key[k])))
+
+
+#define Gcc_New_Visit							\
+  do									\
+    {									\
+      if (++gc_visit_stamp == 0) /* wrap around: reset the marks */	\
+	{								\
+	  memset(gc_visit, 0, gc_nb_key * sizeof(int));			\
+	  gc_visit_stamp = 1;						\
+	}								\
+    }									\
+  while (0)
+
+
+#define Ad_Path_Set(a, start, end, to)		\
+  do						\
+    {						\
+      int l_ = (start), k_;			\
+						\
+      while (l_ != (end))			\
+	{					\
+	  k_ = l_;				\
+	  l_ = a[k_];				\
+	  a[k_] = (to);				\
+	}					\
+    }						\
+  while (0)
+
+
+#define Ad_Path_Min(a, i, res)			\
+  for (res = (i); a[res] < res; res = a[res])
+
+
+#define Ad_Path_Max(a, i, res)			\
+  for (res = (i); a[res] > res; res = a[res])
+
+
+	  /* to enumerate the values of a domain (FD values are >= 0) */
+
+#define Ad_For_Each_Value(r, v)						\
+  for (v = (int) (r)->min; v >= 0 && v <= (r)->max;			\
+       v = (int) Pl_Range_Next_After(r, v))
+
+
+	  /* the current tuples of a relation are a reversible bitset: */
+	  /* a word is trailed once per choice point (like ranges)     */
+
+#define Rel_Cur_Stamp(rel, w)      ((rel)->cur[2 * (w)])
+#define Rel_Cur_Word(rel, w)       ((VecWord) (rel)->cur[2 * (w) + 1])
+
+#define Rel_Set_Cur_Word(rel, w, word)					\
+  do									\
+    {									\
+      WamWord *p_ = (rel)->cur + 2 * (w);				\
+									\
+      if (p_[0] != STAMP)						\
+	{								\
+	  if (FD_Word_Needs_Trailing(p_))				\
+	    Trail_MV(p_, 2);						\
+	  p_[0] = STAMP;						\
+	}								\
+      p_[1] = (WamWord) (word);						\
+    }									\
+  while (0)
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_ALL_DIFFERENT_VALUE                                               *
+ *                                                                         *
+ * Value consistency: when a variable becomes ground its value is removed  *
+ * from the other variables. The work cell of a variable records (trailed) *
+ * that its value has already been removed.                                *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_All_Different_Value(WamWord **array, WamWord *work)
+{
+  int n = (int) (PlLong) *array++;
+  WamWord *done = work + ALL_DIFF_CELLS;
+  int i, j;
+  PlLong v;
+
+  for (i = 0; i < n; i++)
+    {
+      if (!Fd_Variable_Is_Ground(array[i]) || done[i])
+	continue;
+
+      FD_Bind_OV(done + i, 1);
+      v = Min(array[i]);
+
+      for (j = 0; j < n; j++)
+	if (j != i && !Pl_Fd_Tell_Not_Value(array[j], v))
+	  return FALSE;
+    }
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_ALL_DIFFERENT_BOUNDS                                              *
+ *                                                                         *
+ * Bounds consistency (Hall intervals).                                    *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_All_Different_Bounds(WamWord **array, WamWord *work)
+{
+  int n = (int) (PlLong) *array++;
+  PlLong val_min, val_max;
+
+  /* the propagator is woken once per modified variable: nothing to do */
+  /* if no bound has changed since the last fix-point */
+  if (All_Diff_Stamp(array, n, TRUE, &val_min, &val_max) == work[ALL_DIFF_STAMP])
+    return TRUE;
+
+  if (!All_Diff_Filter_Bounds(array, n))
+    return FALSE;
+
+  FD_Bind_OV(work + ALL_DIFF_STAMP,
+	     All_Diff_Stamp(array, n, TRUE, &val_min, &val_max));
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_ALL_DIFFERENT_DOMAIN                                              *
+ *                                                                         *
+ * Domain consistency (Regin's matching-based algorithm). The matching is  *
+ * kept from one call to the next and only repaired. It needs no trailing: *
+ * on backtracking domains grow and the matching remains valid. If a value *
+ * is beyond the vector max the filtering falls back on bounds consistency.*
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_All_Different_Domain(WamWord **array, WamWord *work)
+{
+  int n = (int) (PlLong) *array++;
+  PlLong val_min, val_max;
+  Bool ret;
+
+  if (All_Diff_Stamp(array, n, FALSE, &val_min, &val_max) == work[ALL_DIFF_STAMP])
+    return TRUE;
+
+  if (val_max > pl_vec_max_integer || n <= 1)
+    ret = All_Diff_Filter_Bounds(array, n);
+  else
+    {
+      All_Diff_Alloc(n, (int) (val_max - val_min + 1));
+      ad_val_min = (int) val_min;
+      ret = All_Diff_Filter_Domain(array, n, work + ALL_DIFF_CELLS);
+    }
+
+  if (!ret)
+    return FALSE;
+
+  FD_Bind_OV(work + ALL_DIFF_STAMP,
+	     All_Diff_Stamp(array, n, FALSE, &val_min, &val_max));
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ALL_DIFF_ALLOC                                                          *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+All_Diff_Alloc(int n, int nb_val)
+{
+  if (n > ad_nb_var)
+    {
+      ad_nb_var = n + n / 2;
+      n = ad_nb_var;
+      ad_interv = (AllDiffInterv *) Realloc(ad_interv, n * sizeof(AllDiffInterv));
+      ad_min_sorted = (AllDiffInterv **) Realloc(ad_min_sorted, n * sizeof(AllDiffInterv *));
+      ad_max_sorted = (AllDiffInterv **) Realloc(ad_max_sorted, n * sizeof(AllDiffInterv *));
+      ad_bounds = (PlLong *) Realloc(ad_bounds, (2 * n + 2) * sizeof(PlLong));
+      ad_t = (int *) Realloc(ad_t, (2 * n + 2) * sizeof(int));
+      ad_d = (PlLong *) Realloc(ad_d, (2 * n + 2) * sizeof(PlLong));
+      ad_h = (int *) Realloc(ad_h, (2 * n + 2) * sizeof(int));
+      ad_mate = (int *) Realloc(ad_mate, n * sizeof(int));
+      ad_index = (int *) Realloc(ad_index, n * sizeof(int));
+      ad_low = (int *) Realloc(ad_low, n * sizeof(int));
+      ad_stack = (int *) Realloc(ad_stack, n * sizeof(int));
+      ad_order = (int *) Realloc(ad_order, n * sizeof(int));
+      ad_comp = (int *) Realloc(ad_comp, n * sizeof(int));
+      ad_comp_free = (Bool *) Realloc(ad_comp_free, n * sizeof(Bool));
+    }
+
+  if (nb_val > ad_nb_val)
+    {
+      ad_nb_val = nb_val;
+      ad_val_to_var = (int *) Realloc(ad_val_to_var, nb_val * sizeof(int));
+      ad_val_visit = (int *) Realloc(ad_val_visit, nb_val * sizeof(int));
+      memset(ad_val_visit, 0, nb_val * sizeof(int));
+      ad_visit_stamp = 0;
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ALL_DIFF_STAMP                                                          *
+ *                                                                         *
+ * Returns a number which strictly decreases each time a domain (or only a *
+ * bound if bounds_only) is reduced (never 0, the initial work value).     *
+ * Also computes the smallest and greatest values of the domains.          *
+ *-------------------------------------------------------------------------*/
+static PlLong
+All_Diff_Stamp(WamWord **array, int n, Bool bounds_only,
+	       PlLong *val_min, PlLong *val_max)
+{
+  PlLong stamp = 1;
+  PlLong min = INTERVAL_MAX_INTEGER, max = 0;
+  WamWord *fdv_adr;
+  int i;
+
+  for (i = 0; i < n; i++)
+    {
+      fdv_adr = array[i];
+      stamp += (bounds_only) ? Max(fdv_adr) - Min(fdv_adr) : Nb_Elem(fdv_adr);
+      if (Min(fdv_adr) < min)
+	min = Min(fdv_adr);
+      if (Max(fdv_adr) > max)
+	max = Max(fdv_adr);
+    }
+
+  *val_min = min;
+  *val_max = max;
+
+  return stamp;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ALL_DIFF_FILTER_BOUNDS                                                  *
+ *                                                                         *
+ * Bounds consistency in O(n log n) using Hall intervals, see A. Lopez-    *
+ * Ortiz, C.-G. Quimper, J. Tromp, P. van Beek: "A fast and simple         *
+ * algorithm for bounds consistency of the alldifferent constraint" (2003).*
+ * Iterated until no bound changes.                                        *
+ *-------------------------------------------------------------------------*/
+static Bool
+All_Diff_Filter_Bounds(WamWord **array, int n)
+{
+  AllDiffInterv *iv;
+  int nb_bounds;
+  Bool changed;
+  int i;
+
+  if (n <= 1)
+    return TRUE;
+
+  All_Diff_Alloc(n, 0);
+
+  do
+    {
+      for (i = 0; i < n; i++)
+	{
+	  iv = ad_interv + i;
+	  iv->fdv_adr = array[i];
+	  iv->min = Min(array[i]);
+	  iv->max = Max(array[i]);
+	  ad_min_sorted[i] = ad_max_sorted[i] = iv;
+	}
+
+      All_Diff_Sort(n, &nb_bounds);
+
+      if (!All_Diff_Filter_Lower(n, nb_bounds) ||
+	  !All_Diff_Filter_Upper(n, nb_bounds))
+	return FALSE;
+
+      changed = FALSE;
+      for (i = 0; i < n; i++)
+	{
+	  iv = ad_interv + i;
+	  if (iv->min == Min(iv->fdv_adr) && iv->max == Max(iv->fdv_adr))
+	    continue;
+
+	  if (!Pl_Fd_Tell_Interval(iv->fdv_adr, iv->min, iv->max))
+	    return FALSE;
+	  changed = TRUE;
+	}
+    }
+  while (changed);
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ALL_DIFF_CMP_MIN                                                        *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static int
+All_Diff_Cmp_Min(const void *p1, const void *p2)
+{
+  PlLong m1 = (*(AllDiffInterv **) p1)->min;
+  PlLong m2 = (*(AllDiffInterv **) p2)->min;
+
+  return (m1 > m2) - (m1 < m2);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ALL_DIFF_CMP_MAX                                                        *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static int
+All_Diff_Cmp_Max(const void *p1, const void *p2)
+{
+  PlLong m1 = (*(AllDiffInterv **) p1)->max;
+  PlLong m2 = (*(AllDiffInterv **) p2)->max;
+
+  return (m1 > m2) - (m1 < m2);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ALL_DIFF_SORT                                                           *
+ *                                                                         *
+ * Sorts the intervals by min and by max and computes the ranks of their   *
+ * bounds (min and max + 1) in the sorted array of all bounds.             *
+ *-------------------------------------------------------------------------*/
+static void
+All_Diff_Sort(int n, int *nb_bounds)
+{
+  int i, j, nb;
+  PlLong min, max, last;
+
+  qsort(ad_min_sorted, n, sizeof(AllDiffInterv *), All_Diff_Cmp_Min);
+  qsort(ad_max_sorted, n, sizeof(AllDiffInterv *), All_Diff_Cmp_Max);
+
+  min = ad_min_sorted[0]->min;
+  max = ad_max_sorted[0]->max + 1;
+  last = min - 2;
+  ad_bounds[0] = last;
+  nb = 0;
+  i = j = 0;
+
+  for (;;)
+    {
+      if (i < n && min <= max)
+	{
+	  if (min != last)
+	    ad_bounds[++nb] = last = min;
+	  ad_min_sorted[i]->min_rank = nb;
+	  if (++i < n)
+	    min = ad_min_sorted[i]->min;
+	}
+      else
+	{
+	  if (max != last)
+	    ad_bounds[++nb] = last = max;
+	  ad_max_sorted[j]->max_rank = nb;
+	  if (++j == n)
+	    break;
+	  max = ad_max_sorted[j]->max + 1;
+	}
+    }
+
+  *nb_bounds = nb;
+  ad_bounds[nb + 1] = ad_bounds[nb] + 2;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ALL_DIFF_FILTER_LOWER                                                   *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static Bool
+All_Diff_Filter_Lower(int n, int nb_bounds)
+{
+  int *t = ad_t, *h = ad_h;
+  PlLong *d = ad_d, *bounds = ad_bounds;
+  int i, j, w, x, y, z;
+
+  for (i = 1; i <= nb_bounds + 1; i++)
+    {
+      t[i] = h[i] = i - 1;
+      d[i] = bounds[i] - bounds[i - 1];
+    }
+
+  for (i = 0; i < n; i++)
+    {
+      x = ad_max_sorted[i]->min_rank;
+      y = ad_max_sorted[i]->max_rank;
+      Ad_Path_Max(t, x + 1, z);
+      j = t[z];
+      if (--d[z] == 0)
+	{
+	  t[z] = z + 1;
+	  Ad_Path_Max(t, t[z], z);
+	  t[z] = j;
+	}
+      Ad_Path_Set(t, x + 1, z, z);
+      if (d[z] < bounds[z] - bounds[y])
+	return FALSE;
+
+      if (h[x] > x)
+	{
+	  Ad_Path_Max(h, h[x], w);
+	  ad_max_sorted[i]->min = bounds[w];
+	  Ad_Path_Set(h, x, w, w);
+	}
+
+      if (d[z] == bounds[z] - bounds[y])
+	{
+	  Ad_Path_Set(h, h[y], j - 1, y);
+	  h[y] = j - 1;
+	}
+    }
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ALL_DIFF_FILTER_UPPER                                                   *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static Bool
+All_Diff_Filter_Upper(int n, int nb_bounds)
+{
+  int *t = ad_t, *h = ad_h;
+  PlLong *d = ad_d, *bounds = ad_bounds;
+  int i, j, w, x, y, z;
+
+  for (i = 0; i <= nb_bounds; i++)
+    {
+      t[i] = h[i] = i + 1;
+      d[i] = bounds[i + 1] - bounds[i];
+    }
+
+  for (i = n - 1; i >= 0; i--)
+    {
+      x = ad_min_sorted[i]->max_rank;
+      y = ad_min_sorted[i]->min_rank;
+      Ad_Path_Min(t, x - 1, z);
+      j = t[z];
+      if (--d[z] == 0)
+	{
+	  t[z] = z - 1;
+	  Ad_Path_Min(t, t[z], z);
+	  t[z] = j;
+	}
+      Ad_Path_Set(t, x - 1, z, z);
+      if (d[z] < bounds[y] - bounds[z])
+	return FALSE;
+
+      if (h[x] < x)
+	{
+	  Ad_Path_Min(h, h[x], w);
+	  ad_min_sorted[i]->max = bounds[w] - 1;
+	  Ad_Path_Set(h, x, w, w);
+	}
+
+      if (d[z] == bounds[y] - bounds[z])
+	{
+	  Ad_Path_Set(h, h[y], j + 1, y);
+	  h[y] = j + 1;
+	}
+    }
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ALL_DIFF_FILTER_DOMAIN                                                  *
+ *                                                                         *
+ * Repairs the maximum matching (variables -> values) then removes the     *
+ * values which belong to no maximum matching. In the graph where a var X  *
+ * points to each value V != mate(X) of its domain and a matched value     *
+ * points to its variable, V can be removed from X unless V is free, V's   *
+ * variable is in the same SCC as X or V's variable can reach a free value.*
+ * The SCCs are computed on variables only (X -> variable of V).           *
+ *-------------------------------------------------------------------------*/
+static Bool
+All_Diff_Filter_Domain(WamWord **array, int n, WamWord *mate)
+{
+  Range *r;
+  WamWord *fdv_adr;
+  int i, c, v, y;
+  Bool can_reach;
+
+  for (v = 0; v < ad_nb_val; v++)
+    ad_val_to_var[v] = -1;
+
+  for (i = 0; i < n; i++)	/* keep what remains of the previous matching */
+    {
+      v = (int) mate[i] - ad_val_min;
+      r = Range(array[i]);
+      if (v >= 0 && v < ad_nb_val && ad_val_to_var[v] < 0 &&
+	  Pl_Range_Test_Value(r, v + ad_val_min))
+	{
+	  ad_mate[i] = v;
+	  ad_val_to_var[v] = i;
+	}
+      else
+	ad_mate[i] = -1;
+    }
+
+  for (i = 0; i < n; i++)
+    if (ad_mate[i] < 0)
+      {
+	if (++ad_visit_stamp == 0) /* wrap around: reset the marks */
+	  {
+	    memset(ad_val_visit, 0, ad_nb_val * sizeof(int));
+	    ad_visit_stamp = 1;
+	  }
+	if (!All_Diff_Augment(array, i))
+	  return FALSE;
+      }
+
+  for (i = 0; i < n; i++)
+    {
+      mate[i] = ad_mate[i] + ad_val_min;
+      ad_index[i] = -1;
+    }
+
+  ad_stack_top = 0;
+  ad_nb_order = 0;
+  ad_index_counter = 0;
+  ad_nb_comp = 0;
+  for (i = 0; i < n; i++)
+    if (ad_index[i] < 0)
+      All_Diff_Scc(array, i);
+
+  /* SCCs are numbered in reverse topological order: a successor SCC of */
+  /* c has a smaller number, thus its ad_comp_free is already computed. */
+
+  for (i = 0; i < n; )
+    {
+      c = ad_comp[ad_order[i]];
+      can_reach = FALSE;
+      for (; i < n && ad_comp[ad_order[i]] == c; i++)
+	{
+	  if (can_reach)
+	    continue;
+	  r = Range(array[ad_order[i]]);
+	  Ad_For_Each_Value(r, v)
+	    {
+	      y = ad_val_to_var[v - ad_val_min];
+	      if (y < 0 || (ad_comp[y] != c && ad_comp_free[ad_comp[y]]))
+		{
+		  can_reach = TRUE;
+		  break;
+		}
+	    }
+	}
+      ad_comp_free[c] = can_reach;
+    }
+
+  for (i = 0; i < n; i++)
+    {
+      fdv_adr = array[i];
+      if (Fd_Variable_Is_Ground(fdv_adr))
+	continue;
+
+      /* removing v does not alter the values after v (safe enumeration) */
+      r = Range(fdv_adr);
+      Ad_For_Each_Value(r, v)
+	{
+	  y = ad_val_to_var[v - ad_val_min];
+	  if (y >= 0 && y != i && ad_comp[y] != ad_comp[i] &&
+	      !ad_comp_free[ad_comp[y]] && !Pl_Fd_Tell_Not_Value(fdv_adr, v))
+	    return FALSE;
+	}
+    }
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ALL_DIFF_AUGMENT                                                        *
+ *                                                                         *
+ * Searches an augmenting path from the unmatched variable x.              *
+ *-------------------------------------------------------------------------*/
+static Bool
+All_Diff_Augment(WamWord **array, int x)
+{
+  Range *r = Range(array[x]);
+  int v, w, y;
+
+  Ad_For_Each_Value(r, v)	/* first try a free value */
+    {
+      w = v - ad_val_min;
+      if (ad_val_to_var[w] < 0)
+	goto found;
+    }
+
+  Ad_For_Each_Value(r, v)
+    {
+      w = v - ad_val_min;
+      if (ad_val_visit[w] == ad_visit_stamp)
+	continue;
+
+      ad_val_visit[w] = ad_visit_stamp;
+      y = ad_val_to_var[w];
+      if (All_Diff_Augment(array, y))
+	goto found;
+    }
+
+  return FALSE;
+
+found:
+  ad_mate[x] = w;
+  ad_val_to_var[w] = x;
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ALL_DIFF_SCC                                                            *
+ *                                                                         *
+ * Tarjan's algorithm. The vars of each completed SCC are appended to      *
+ * ad_order.                                                               *
+ *-------------------------------------------------------------------------*/
+static void
+All_Diff_Scc(WamWord **array, int x)
+{
+  Range *r = Range(array[x]);
+  int v, y;
+
+  ad_index[x] = ad_low[x] = ad_index_counter++;
+  ad_comp[x] = -1;		/* -1: on the stack */
+  ad_stack[ad_stack_top++] = x;
+
+  Ad_For_Each_Value(r, v)
+    {
+      y = ad_val_to_var[v - ad_val_min];
+      if (y < 0 || y == x)
+	continue;
+
+      if (ad_index[y] < 0)
+	{
+	  All_Diff_Scc(array, y);
+	  if (ad_low[y] < ad_low[x])
+	    ad_low[x] = ad_low[y];
+	}
+      else if (ad_comp[y] < 0 && ad_index[y] < ad_low[x])
+	ad_low[x] = ad_index[y];
+    }
+
+  if (ad_low[x] == ad_index[x])
+    {
+      do
+	{
+	  y = ad_stack[--ad_stack_top];
+	  ad_comp[y] = ad_nb_comp;
+	  ad_order[ad_nb_order++] = y;
+	}
+      while (y != x);
+
+      ad_nb_comp++;
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_ELEMENT_3                                                         *
+ *                                                                         *
+ * V is the Ith element of the list of integers L (I in 1..N). For each    *
+ * value k of L the number of indices of I giving k is maintained (trailed *
+ * counter): when an index is removed from I only the counter of its value *
+ * is updated (k is removed from V when it reaches 0) and when a value is  *
+ * removed from V only its own indices are removed from I. The indices of  *
+ * I and the values of V are kept in 2 reversible sparse sets to detect    *
+ * the removed elements without scanning the whole list.                   *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Element_3(WamWord i_word, WamWord l_word, WamWord v_word)
+{
+  WamWord *AF, *CF;
+  WamWord *l;
+  Element *elem;
+  PlLong *val;
+  Range range;
+  int n, k, j;
+  Bool ret;
+
+  AF = CS;
+  CS += 1;
+
+  l = Pl_Fd_Prolog_To_Array_Int(l_word);
+  n = (int) *l;
+  if (n == 0)
+    return FALSE;
+
+  elem = (Element *) Cs_Alloc(sizeof(Element));
+  AF[0] = (WamWord) elem;
+  elem->n = n;
+
+  if (n > el_size)
+    {
+      el_size = n;
+      el_buff = (PlLong *) Realloc(el_buff, el_size * sizeof(PlLong));
+    }
+
+  elem->i_adr = Pl_Fd_Prolog_To_Fd_Var(i_word, TRUE);
+  elem->v_adr = Pl_Fd_Prolog_To_Fd_Var(v_word, TRUE);
+
+  val = (PlLong *) Malloc(n * sizeof(PlLong));
+  for (j = 0; j < n; j++)
+    val[j] = l[j + 1];
+
+  qsort(val, n, sizeof(PlLong), Relation_Cmp_Int);
+
+  for (j = k = 1; j < n; j++)
+    if (val[j] != val[k - 1])
+      val[k++] = val[j];
+
+  elem->nb_val = k;
+  elem->val = (PlLong *) Cs_Alloc(k * sizeof(PlLong));
+  memcpy(elem->val, val, k * sizeof(PlLong));
+  Free(val);
+
+  elem->val_no = (int *) Cs_Alloc((n + 1) * sizeof(int));
+  elem->first = (int *) Cs_Alloc((k + 1) * sizeof(int));
+  elem->occ = (int *) Cs_Alloc(n * sizeof(int));
+  elem->count = (WamWord *) Cs_Alloc(k * sizeof(WamWord));
+  elem->i_set = (int *) Cs_Alloc(n * sizeof(int));
+  elem->v_set = (int *) Cs_Alloc(k * sizeof(int));
+  elem->i_limit = n;
+  elem->v_limit = k;
+
+  for (k = 0; k < elem->nb_val; k++)
+    {
+      elem->count[k] = 0;
+      elem->v_set[k] = k;
+    }
+
+  for (j = 1; j <= n; j++)
+    {
+      k = Element_Find_Val(elem, l[j]);
+      elem->val_no[j] = k;
+      elem->count[k]++;
+      elem->i_set[j - 1] = j;
+    }
+
+  elem->first[0] = 0;		/* occ: the indices grouped by value */
+  for (k = 0; k < elem->nb_val; k++)
+    elem->first[k + 1] = elem->first[k] + (int) elem->count[k];
+
+  for (j = n; j >= 1; j--)
+    {
+      k = elem->val_no[j];
+      elem->occ[elem->first[k] + --elem->count[k]] = j;
+    }
+
+  for (j = 1; j <= n; j++)	/* restore the counters */
+    elem->count[elem->val_no[j]]++;
+
+  Fd_Cstr_Type(fd_element);
+  Pl_Fd_Before_Add_Cstr();
+
+  CF = Pl_Fd_Create_C_Frame(Element_Propagate, AF, NULL, FALSE,
+			    FD_PRIO_CHEAP | FD_CSTR_IDEMPOTENT);
+  Pl_Fd_Add_Dependency(elem->i_adr, CHAIN_NB_DOM, CF);
+  Pl_Fd_Add_Dependency(elem->v_adr, CHAIN_NB_DOM, CF);
+
+  range.extra_cstr = FALSE;	/* V in the values of L */
+  range.min = 0;
+  range.vec = NULL;
+  Set_To_Empty(&range);
+  for (k = 0; k < elem->nb_val; k++)
+    Pl_Range_Set_Value(&range, elem->val[k]);
+
+  ret = Pl_Fd_Tell_Interval(elem->i_adr, 1, n) &&
+    Pl_Fd_Tell_Range(elem->v_adr, &range) && Element_Propagate(AF);
+
+  return Pl_Fd_After_Add_Cstr(ret);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ELEMENT_FIND_VAL                                                        *
+ *                                                                         *
+ * Returns the number of a value (which must be a value of L).             *
+ *-------------------------------------------------------------------------*/
+static int
+Element_Find_Val(Element *elem, PlLong value)
+{
+  PlLong *val = elem->val;
+  int lo = 0, hi = elem->nb_val - 1, mid;
+
+  while (lo < hi)
+    {
+      mid = (lo + hi) / 2;
+      if (val[mid] < value)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+
+  return lo;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ELEMENT_PROPAGATE                                                       *
+ *                                                                         *
+ * The sparse sets contain the domains of I and V (they can only be larger *
+ * than them) so nothing has changed while the sizes are equal.            *
+ *-------------------------------------------------------------------------*/
+static PlLong
+Element_Propagate(WamWord *AF)
+{
+  Element *elem = (Element *) AF[0];
+  WamWord *i_adr = elem->i_adr;
+  WamWord *v_adr = elem->v_adr;
+  int *set;
+  int limit, p, j, k, o, nb;
+
+  for (;;)
+    {
+      if (Fd_Variable_Is_Ground(i_adr)) /* entailed once V = L[I] */
+	return Pl_Fd_Tell_Value(v_adr, elem->val[elem->val_no[Min(i_adr)]]);
+
+      limit = (int) elem->i_limit;
+      if (Nb_Elem(i_adr) != limit)
+	{
+	  set = elem->i_set;
+	  nb = 0;
+	  for (p = limit - 1; p >= 0; p--)
+	    {
+	      j = set[p];
+	      if (Pl_Range_Test_Value(Range(i_adr), j))
+		continue;
+
+	      set[p] = set[--limit];
+	      set[limit] = j;
+
+	      k = elem->val_no[j];
+	      FD_Bind_OV(elem->count + k, elem->count[k] - 1);
+	      if (elem->count[k] == 0)
+		el_buff[nb++] = elem->val[k];
+	    }
+	  FD_Bind_OV(&elem->i_limit, limit);
+
+	  if (!Element_Remove(v_adr, el_buff, nb))
+	    return FALSE;
+	}
+
+      limit = (int) elem->v_limit;
+      if (Nb_Elem(v_adr) == limit)
+	return TRUE;
+
+      set = elem->v_set;
+      nb = 0;
+      for (p = limit - 1; p >= 0; p--)
+	{
+	  k = set[p];
+	  if (Pl_Range_Test_Value(Range(v_adr), elem->val[k]))
+	    continue;
+
+	  set[p] = set[--limit];
+	  set[limit] = k;
+
+	  if (elem->count[k] > 0)
+	    for (o = elem->first[k]; o < elem->first[k + 1]; o++)
+	      el_buff[nb++] = elem->occ[o];
+	}
+      FD_Bind_OV(&elem->v_limit, limit);
+
+      if (nb == 0)
+	return TRUE;
+
+      if (!Element_Remove(i_adr, el_buff, nb))
+	return FALSE;
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ELEMENT_REMOVE                                                          *
+ *                                                                         *
+ * Removes nb values from the domain of a variable with a single tell (one *
+ * by one removals would copy the domain each time if it is a list of      *
+ * intervals).                                                             *
+ *-------------------------------------------------------------------------*/
+static Bool
+Element_Remove(WamWord *fdv_adr, PlLong *val, int nb)
+{
+  WamWord *save_CS = CS;
+  Range r, r1;
+
+  int i;
+
+  if (nb <= 1)
+    return nb == 0 || Pl_Fd_Tell_Not_Value(fdv_adr, val[0]);
+
+  r1.vec = NULL;
+  if (Range(fdv_adr)->max <= pl_vec_max_integer) /* vector: reset each value */
+    {
+      Pl_Range_Copy(&r1, Range(fdv_adr));
+      for (i = 0; i < nb; i++)
+	Pl_Range_Reset_Value(&r1, val[i]);
+    }
+  else
+    {
+      r.vec = NULL;
+      Pl_Range_From_Values(&r, val, nb);
+      Pl_Range_Compl(&r);
+
+      CS = save_CS;		/* move the range down */
+      Pl_Range_Copy(&r1, &r);
+    }
+
+  CS = save_CS;			/* see fd_allocate */
+
+  return Pl_Fd_Tell_Range(fdv_adr, &r1);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_ELEMENT_VAR_I                                                     *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Element_Var_I(Range *i, WamWord *l)
+{
+  int n = (int) (*l);			/* I in 1..N in sparse mode */
+
+  Range_Init_Interval(i, 1, n);
+  Pl_Range_Becomes_Sparse(i);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_ELEMENT_VAR_I_TO_V                                                *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Element_Var_I_To_V(Range *v, Range *i, WamWord **l)
+{
+  WamWord *fdv_adr;
+  PlLong j;
+
+  v->extra_cstr = FALSE;
+  v->vec = 0;
+  Set_To_Empty(v);
+
+  /* when I or L changes -> update V */
+
+  if (Is_IList(i))		/* approximated by a vector */
+    Pl_Range_Becomes_Sparse(i);
+
+  if (i->min == i->max || Is_Interval(i))
+    {
+      for (j = i->min; j <= i->max; j++)
+	{
+	  fdv_adr = l[j];
+	  Pl_Range_Union(v, Range(fdv_adr));
+	}
+    }
+  else
+    {
+      VECTOR_BEGIN_ENUM(i->vec, j);
+
+      fdv_adr = l[j];
+      Pl_Range_Union(v, Range(fdv_adr));
+
+      VECTOR_END_ENUM;
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_ELEMENT_VAR_V_TO_I                                                *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Element_Var_V_To_I(Range *i, Range *v, WamWord **l)
+{
+  WamWord *fdv_adr;
+  PlLong n;
+  int j;
+
+  Vector_Allocate(i->vec);
+  Pl_Vector_Empty(i->vec);
+  /* when V or L changes -> update I */
+
+  n = (PlLong) *l;
+
+  for (j = 1; j <= n; j++)
+    {
+      fdv_adr = l[j];
+      if (!Pl_Range_Test_Null_Inter(Range(fdv_adr), v))
+	  Vector_Set_Value(i->vec, j);
+    }
+
+  Pl_Range_From_Vector(i);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_ELEMENT_V_TO_XI                                                   *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Element_V_To_Xi(int i, WamWord **array, Range *v)
+{
+  WamWord *fdv_adr = array[i];
+
+  if (Fd_Variable_Is_Ground(fdv_adr))
+    return Pl_Fd_Tell_Int_Range(fdv_adr, v);
+
+  return Pl_Fd_Tell_Range_Range(fdv_adr, v);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_COUNT_4                                                           *
+ *                                                                         *
+ * Posts fd_atmost/3 (kind = 0), fd_atleast/3 (1) or fd_exactly/3 (2): the *
+ * number of variables of L equal to V is at most/at least/exactly N.      *
+ * Each variable has its own constraint frame which maintains 2 trailed    *
+ * counters in O(1): the nb of variables fixed to V and the nb of ones     *
+ * which can take V. The variables are only scanned when a counter reaches *
+ * a bound (the remaining ones are then all fixed to V or all exclude V).  *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Count_4(WamWord n_word, WamWord l_word, WamWord v_word,
+	      WamWord kind_word)
+{
+  WamWord *AF, *CF, *t, *fdv_adr;
+  WamWord **array;
+  PlLong n, v;
+  int kind, m;
+  int nb_fixed, nb_possible;
+  int i;
+
+  n = Pl_Fd_Prolog_To_Value(n_word);
+  v = Pl_Fd_Prolog_To_Value(v_word);
+  kind = Pl_Rd_Integer(kind_word);
+
+  array = (WamWord **) Pl_Fd_Prolog_To_Array_Fdv(l_word, TRUE);
+  m = (int) (PlLong) *array++;
+
+  AF = CS;
+  CS += COUNT_VARS + m * COUNT_V_SIZE;
+
+  nb_fixed = nb_possible = 0;
+  for (i = 0, t = AF + COUNT_VARS; i < m; i++, t += COUNT_V_SIZE)
+    {
+      t[COUNT_V_AF] = (WamWord) AF;
+      t[COUNT_V_FDV] = (WamWord) array[i];
+      t[COUNT_V_STATE] = Count_State(array[i], v);
+      if (t[COUNT_V_STATE] != COUNT_EXCLUDED)
+	nb_possible++;
+      if (t[COUNT_V_STATE] == COUNT_FIXED)
+	nb_fixed++;
+    }
+
+  AF[COUNT_NB_VAR] = m;
+  AF[COUNT_VALUE] = v;
+  AF[COUNT_LOW] = (kind == 0) ? 0 : n;
+  AF[COUNT_HIGH] = (kind == 1) ? m : n;
+  AF[COUNT_NB_FIXED] = nb_fixed;
+  AF[COUNT_NB_POSSIBLE] = nb_possible;
+
+  Fd_Cstr_Type(fd_count);
+  Pl_Fd_Before_Add_Cstr();
+
+  for (i = 0, t = AF + COUNT_VARS; i < m; i++, t += COUNT_V_SIZE)
+    {
+      if (t[COUNT_V_STATE] != COUNT_POSSIBLE)
+	continue;
+
+      fdv_adr = (WamWord *) t[COUNT_V_FDV];
+      CF = Pl_Fd_Create_C_Frame(Count_Var_Propagate, t, fdv_adr, FALSE,
+				FD_PRIO_CHEAP);
+      Pl_Fd_Add_Dependency(fdv_adr, CHAIN_NB_DOM, CF);
+    }
+
+  return Pl_Fd_After_Add_Cstr(Count_Filter(AF));
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * COUNT_STATE                                                             *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static int
+Count_State(WamWord *fdv_adr, PlLong v)
+{
+  if (!Pl_Range_Test_Value(Range(fdv_adr), v))
+    return COUNT_EXCLUDED;
+
+  return Fd_Variable_Is_Ground(fdv_adr) ? COUNT_FIXED : COUNT_POSSIBLE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * COUNT_UPDATE                                                            *
+ *                                                                         *
+ * Updates the state of the variable t (and the counters) if it changed.   *
+ *-------------------------------------------------------------------------*/
+static void
+Count_Update(WamWord *AF, WamWord *t)
+{
+  int state;
+
+  if (t[COUNT_V_STATE] != COUNT_POSSIBLE)
+    return;
+
+  state = Count_State((WamWord *) t[COUNT_V_FDV], AF[COUNT_VALUE]);
+  if (state == COUNT_POSSIBLE)
+    return;
+
+  FD_Bind_OV(t + COUNT_V_STATE, state);
+  if (state == COUNT_FIXED)
+    FD_Bind_OV(AF + COUNT_NB_FIXED, AF[COUNT_NB_FIXED] + 1);
+  else
+    FD_Bind_OV(AF + COUNT_NB_POSSIBLE, AF[COUNT_NB_POSSIBLE] - 1);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * COUNT_VAR_PROPAGATE                                                     *
+ *                                                                         *
+ * Constraint of a variable t of a counting constraint (t has changed).    *
+ *-------------------------------------------------------------------------*/
+static PlLong
+Count_Var_Propagate(WamWord *t)
+{
+  WamWord *AF = (WamWord *) t[COUNT_V_AF];
+
+  Count_Update(AF, t);
+
+  return Count_Filter(AF);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * COUNT_FILTER                                                            *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static PlLong
+Count_Filter(WamWord *AF)
+{
+  int m = (int) AF[COUNT_NB_VAR];
+  PlLong v = AF[COUNT_VALUE];
+  WamWord *t, *end = AF + COUNT_VARS + m * COUNT_V_SIZE;
+  WamWord *fdv_adr;
+  int nb_fixed, nb_possible;
+  Bool exclude;
+
+  for (;;)
+    {
+      nb_fixed = (int) AF[COUNT_NB_FIXED];
+      nb_possible = (int) AF[COUNT_NB_POSSIBLE];
+
+      if (nb_fixed > AF[COUNT_HIGH] || nb_possible < AF[COUNT_LOW])
+	return FALSE;
+
+      if (nb_fixed == nb_possible)
+	return TRUE;
+
+      if (nb_fixed == AF[COUNT_HIGH])
+	exclude = TRUE;
+      else if (nb_possible == AF[COUNT_LOW])
+	exclude = FALSE;
+      else
+	return TRUE;
+
+      for (t = AF + COUNT_VARS; t < end; t += COUNT_V_SIZE)
+	{
+	  if (t[COUNT_V_STATE] != COUNT_POSSIBLE)
+	    continue;
+
+	  fdv_adr = (WamWord *) t[COUNT_V_FDV];
+	  if (exclude)
+	    {
+	      if (!Pl_Fd_Tell_Not_Value(fdv_adr, v))
+		return FALSE;
+	    }
+	  else if (!Pl_Fd_Tell_Value(fdv_adr, v))
+	    return FALSE;
+
+	  Count_Update(AF, t);
+	}
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_RELATION_3                                                        *
+ *                                                                         *
+ * Posts fd_relation/2 (by_column_word = 0) or fd_relationc/2 (1) as a     *
+ * single Compact-Table constraint: the set of tuples still valid is kept  *
+ * as a reversible sparse bitset and each value of each variable has the   *
+ * bitset of its supporting tuples (see J. Demeulenaere et al. "Compact-   *
+ * Table: efficiently filtering table constraints with reversible sparse   *
+ * bit-sets", CP 2016). This ensures generalized arc consistency.          *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Relation_3(WamWord tuples_word, WamWord vars_word, WamWord by_column_word)
+{
+  Bool by_column = Pl_Rd_Integer_Check(by_column_word);
+  WamWord *AF, *CF;
+  WamWord **array;
+  PlLong *table;
+  int nb_var, nb_tuple;
+  Relation *rel;
+  RelVar *rv;
+  Range range;
+  int i, j;
+  Bool ret;
+
+  AF = CS;
+  CS += 2;
+
+  array = (WamWord **) Pl_Fd_Prolog_To_Array_Fdv(vars_word, TRUE);
+  nb_var = (int) (PlLong) *array;
+  AF[0] = (WamWord) array;
+
+  nb_tuple = Relation_Read_Table(tuples_word, nb_var, by_column, NULL);
+  if (nb_tuple <= 0)
+    return FALSE;
+
+  table = (PlLong *) Malloc(nb_tuple * nb_var * sizeof(PlLong));
+  Relation_Read_Table(tuples_word, nb_var, by_column, table);
+  rel = Relation_Create(array + 1, nb_tuple, table);
+  Free(table);
+
+  if (rel == NULL)
+    return FALSE;
+
+  AF[1] = (WamWord) rel;
+
+  Fd_Cstr_Type(fd_relation);
+  Pl_Fd_Before_Add_Cstr();
+
+  CF = Pl_Fd_Create_C_Frame(Relation_Propagate, AF, NULL, FALSE,
+			    FD_PRIO_EXPENSIVE | FD_CSTR_IDEMPOTENT);
+  Pl_Fd_Add_List_Dependency((WamWord *) array, CHAIN_NB_DOM, CF);
+
+  ret = TRUE;
+  for (i = 0; ret && i < nb_var; i++) /* restrict to the values of the table */
+    {
+      rv = rel->var + i;
+      range.extra_cstr = FALSE;
+      range.min = 0;
+      range.vec = NULL;
+      Set_To_Empty(&range);
+      for (j = 0; j < rv->nb_val; j++)
+	Pl_Range_Set_Value(&range, rv->val[j].value);
+
+      ret = Pl_Fd_Tell_Range(array[i + 1], &range);
+    }
+
+  if (ret)
+    ret = Relation_Propagate(AF);
+
+  return Pl_Fd_After_Add_Cstr(ret);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * RELATION_READ_TABLE                                                     *
+ *                                                                         *
+ * Checks the table and returns its number of tuples (-1 if the tuples do *
+ * not have nb_var elements). If table != NULL stores the tuples in it.   *
+ *-------------------------------------------------------------------------*/
+static int
+Relation_Read_Table(WamWord tuples_word, int nb_var, Bool by_column,
+		    PlLong *table)
+{
+  WamWord word, tag_mask;
+  WamWord save_tuples_word = tuples_word;
+  WamWord elem_word;
+  WamWord *lst_adr, *elem_adr;
+  int nb_tuple = -1;
+  int i, j;
+
+  for (i = 0; ; i++)
+    {
+      DEREF(tuples_word, word, tag_mask);
+      if (tag_mask == TAG_REF_MASK)
+	Pl_Err_Instantiation();
+
+      if (word == NIL_WORD)
+	break;
+
+      if (tag_mask != TAG_LST_MASK)
+	Pl_Err_Type(pl_type_list, save_tuples_word);
+
+      lst_adr = UnTag_LST(word);
+      elem_word = Car(lst_adr);
+      tuples_word = Cdr(lst_adr);
+
+      for (j = 0; ; j++)
+	{
+	  DEREF(elem_word, word, tag_mask);
+	  if (tag_mask == TAG_REF_MASK)
+	    Pl_Err_Instantiation();
+
+	  if (word == NIL_WORD)
+	    break;
+
+	  if (tag_mask != TAG_LST_MASK)
+	    Pl_Err_Type(pl_type_list, Car(lst_adr));
+
+	  elem_adr = UnTag_LST(word);
+	  elem_word = Cdr(elem_adr);
+	  DEREF(Car(elem_adr), word, tag_mask);
+	  if (tag_mask == TAG_REF_MASK)
+	    Pl_Err_Instantiation();
+
+	  if (tag_mask != TAG_INT_MASK)
+	    Pl_Err_Type(pl_type_integer, word);
+
+	  if (table == NULL)
+	    continue;
+
+	  if (by_column)	/* i: column, j: tuple */
+	    table[j * nb_var + i] = UnTag_INT(word);
+	  else
+	    table[i * nb_var + j] = UnTag_INT(word);
+	}
+
+      if (by_column)
+	{
+	  if (nb_tuple >= 0 && j != nb_tuple)
+	    return -1;
+	  nb_tuple = j;
+	}
+      else if (j != nb_var)
+	return -1;
+    }
+
+  if (by_column)
+    return (i == nb_var) ? nb_tuple : -1;
+
+  return i;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CS_ALLOC                                                                *
+ *                                                                         *
+ * Allocates size bytes in the constraint stack.                           *
+ *-------------------------------------------------------------------------*/
+static void *
+Cs_Alloc(int size)
+{
+  WamWord *adr = CS;
+
+  CS += (size + sizeof(WamWord) - 1) / sizeof(WamWord);
+
+  return adr;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * RELATION_CREATE                                                         *
+ *                                                                         *
+ * Builds the relation in the constraint stack. Only tuples whose values   *
+ * belong to the current domains are kept (if none returns NULL).          *
+ *-------------------------------------------------------------------------*/
+static Relation *
+Relation_Create(WamWord **array, int nb_tuple, PlLong *table)
+{
+  Relation *rel;
+  RelVar *rv;
+  RelVal *val;
+  int nb_var = (int) (PlLong) array[-1];
+  PlLong *values;
+  int nb_word;
+  int i, j, k, t;
+
+  for (t = k = 0; t < nb_tuple; t++) /* keep the valid tuples (packed) */
+    {
+      for (i = 0; i < nb_var; i++)
+	if (!Pl_Range_Test_Value(Range(array[i]), table[t * nb_var + i]))
+	  break;
+
+      if (i < nb_var)
+	continue;
+
+      if (k < t)
+	memcpy(table + k * nb_var, table + t * nb_var, nb_var * sizeof(PlLong));
+      k++;
+    }
+
+  nb_tuple = k;
+  if (nb_tuple == 0)
+    return NULL;
+
+  nb_word = (nb_tuple + WORD_SIZE - 1) / WORD_SIZE;
+
+  rel = (Relation *) Cs_Alloc(sizeof(Relation));
+  rel->nb_var = nb_var;
+  rel->nb_word = nb_word;
+  rel->limit = nb_word;
+  rel->cur = (WamWord *) Cs_Alloc(2 * nb_word * sizeof(WamWord));
+  rel->index = (int *) Cs_Alloc(nb_word * sizeof(int));
+  rel->last_size = (WamWord *) Cs_Alloc(nb_var * sizeof(WamWord));
+  rel->var = (RelVar *) Cs_Alloc(nb_var * sizeof(RelVar));
+
+  for (j = 0; j < nb_word; j++)
+    {
+      Rel_Cur_Stamp(rel, j) = STAMP;
+      rel->cur[2 * j + 1] = (WamWord) ~(VecWord) 0;
+      rel->index[j] = j;
+    }
+  if (nb_tuple % WORD_SIZE)
+    rel->cur[2 * nb_word - 1] = (WamWord) (((VecWord) 1 << (nb_tuple % WORD_SIZE)) - 1);
+
+  values = (PlLong *) Malloc(nb_tuple * sizeof(PlLong));
+
+  for (i = 0; i < nb_var; i++)
+    {
+      rel->last_size[i] = 0;	/* 0: forces a first update */
+      rv = rel->var + i;
+
+      for (t = 0; t < nb_tuple; t++)
+	values[t] = table[t * nb_var + i];
+
+      qsort(values, nb_tuple, sizeof(PlLong), Relation_Cmp_Int);
+
+      for (t = k = 1; t < nb_tuple; t++)
+	if (values[t] != values[k - 1])
+	  values[k++] = values[t];
+
+      rv->nb_val = k;
+      rv->val = val = (RelVal *) Cs_Alloc(k * sizeof(RelVal));
+      for (j = 0; j < k; j++, val++)
+	{
+	  val->value = values[j];
+	  val->residue = 0;
+	  val->support = (VecWord *) Cs_Alloc(nb_word * sizeof(VecWord));
+	  memset(val->support, 0, nb_word * sizeof(VecWord));
+	}
+
+      for (t = 0; t < nb_tuple; t++)
+	{
+	  val = Relation_Find_Val(rv, table[t * nb_var + i]);
+	  val->support[Word_No(t)] |= (VecWord) 1 << Bit_No(t);
+	}
+    }
+
+  Free(values);
+
+  return rel;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * RELATION_CMP_INT                                                        *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static int
+Relation_Cmp_Int(const void *p1, const void *p2)
+{
+  PlLong x1 = *(PlLong *) p1;
+  PlLong x2 = *(PlLong *) p2;
+
+  return (x1 > x2) - (x1 < x2);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * RELATION_FIND_VAL                                                       *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static RelVal *
+Relation_Find_Val(RelVar *rv, PlLong value)
+{
+  int low = 0, high = rv->nb_val - 1, mid;
+
+  while (low <= high)
+    {
+      mid = (low + high) / 2;
+      if (rv->val[mid].value == value)
+	return rv->val + mid;
+
+      if (rv->val[mid].value < value)
+	low = mid + 1;
+      else
+	high = mid - 1;
+    }
+
+  return NULL;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * RELATION_PROPAGATE                                                      *
+ *                                                                         *
+ * Removes from the current tuples the ones invalidated by the variables   *
+ * whose domain changed since the last call, then removes the values which *
+ * no longer have a support.                                               *
+ *-------------------------------------------------------------------------*/
+static PlLong
+Relation_Propagate(WamWord *AF)
+{
+  WamWord **array = (WamWord **) AF[0] + 1;
+  Relation *rel = (Relation *) AF[1];
+  WamWord *fdv_adr;
+  RelVar *rv;
+  RelVal *val, *end;
+  int nb_changed = 0, last_changed = -1;
+  int i;
+
+  for (i = 0; i < rel->nb_var; i++)
+    {
+      fdv_adr = array[i];
+      if (Nb_Elem(fdv_adr) == rel->last_size[i])
+	continue;
+
+      nb_changed++;
+      last_changed = i;
+      FD_Bind_OV(rel->last_size + i, Nb_Elem(fdv_adr));
+
+      if (!Relation_Update_Table(rel, fdv_adr, rel->var + i))
+	return FALSE;
+    }
+
+  if (nb_changed == 0)		/* woken by our own reductions */
+    return TRUE;
+
+  for (i = 0; i < rel->nb_var; i++)
+    {
+      /* the values of the only changed variable keep their supports */
+      if (nb_changed == 1 && i == last_changed)
+	continue;
+
+      fdv_adr = array[i];
+      if (Fd_Variable_Is_Ground(fdv_adr))
+	continue;
+
+      rv = rel->var + i;
+      end = rv->val + rv->nb_val;
+      for (val = rv->val; val < end; val++)
+	if (Pl_Range_Test_Value(Range(fdv_adr), val->value) &&
+	    !Relation_Has_Support(rel, val) &&
+	    !Pl_Fd_Tell_Not_Value(fdv_adr, val->value))
+	  return FALSE;
+
+      if (Nb_Elem(fdv_adr) != rel->last_size[i])
+	FD_Bind_OV(rel->last_size + i, Nb_Elem(fdv_adr));
+    }
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * RELATION_UPDATE_TABLE                                                   *
+ *                                                                         *
+ * Intersects the current tuples with the union of the supports of the    *
+ * values in the domain of the variable. Fails if no tuple remains.        *
+ *-------------------------------------------------------------------------*/
+static Bool
+Relation_Update_Table(Relation *rel, WamWord *fdv_adr, RelVar *rv)
+{
+  int limit = (int) rel->limit;
+  int *index = rel->index;
+  RelVal *val, *end = rv->val + rv->nb_val;
+  VecWord *mask;
+  VecWord word;
+  int i, w;
+
+  if (Fd_Variable_Is_Ground(fdv_adr))
+    {
+      val = Relation_Find_Val(rv, Min(fdv_adr));
+      if (val == NULL)
+	return FALSE;
+      mask = val->support;
+    }
+  else
+    {
+      if (rel->nb_word > rel_nb_word)
+	{
+	  rel_nb_word = rel->nb_word;
+	  rel_mask = (VecWord *) Realloc(rel_mask, rel_nb_word * sizeof(VecWord));
+	}
+      mask = rel_mask;
+
+      for (i = 0; i < limit; i++)
+	mask[index[i]] = 0;
+
+      for (val = rv->val; val < end; val++)
+	if (Pl_Range_Test_Value(Range(fdv_adr), val->value))
+	  for (i = 0; i < limit; i++)
+	    {
+	      w = index[i];
+	      mask[w] |= val->support[w];
+	    }
+    }
+
+  for (i = limit - 1; i >= 0; i--)
+    {
+      w = index[i];
+      word = Rel_Cur_Word(rel, w);
+      if ((word & mask[w]) == word)
+	continue;
+
+      word &= mask[w];
+      Rel_Set_Cur_Word(rel, w, word);
+      if (word == 0)		/* swap with the last non-zero word */
+	{
+	  index[i] = index[--limit];
+	  index[limit] = w;
+	}
+    }
+
+  if (limit != rel->limit)
+    FD_Bind_OV(&rel->limit, limit);
+
+  return limit > 0;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * RELATION_HAS_SUPPORT                                                    *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static Bool
+Relation_Has_Support(Relation *rel, RelVal *val)
+{
+  int limit = (int) rel->limit;
+  int i, w;
+
+  w = val->residue;
+  if (Rel_Cur_Word(rel, w) & val->support[w])
+    return TRUE;
+
+  for (i = 0; i < limit; i++)
+    {
+      w = rel->index[i];
+      if (Rel_Cur_Word(rel, w) & val->support[w])
+	{
+	  val->residue = w;
+	  return TRUE;
+	}
+    }
+
+  return FALSE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_CUMULATIVE                                                        *
+ *                                                                         *
+ * Tasks i start at array[i], last dur[i] and use dem[i] units of a        *
+ * resource of capacity capa. The bounds of the starts are filtered by     *
+ * time-tabling (compulsory parts) and edge-finding, in both directions    *
+ * (the latest starts are filtered on the mirrored tasks), until no bound  *
+ * changes. Tasks with a null duration or demand are ignored.              *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Cumulative(WamWord **array, WamWord *dur, WamWord *dem, PlLong capa,
+		 WamWord *work)
+{
+  int n = (int) (PlLong) *array++;
+  PlLong stamp;
+  CumulTask *t;
+  Bool changed;
+  int nb, i;
+
+  /* woken once per modified variable: nothing to do if no bound */
+  /* has changed since the last fix-point */
+  stamp = Cumul_Stamp(array, n);
+  if (stamp == work[CUMUL_STAMP])
+    return TRUE;
+
+  Cumul_Alloc(n);
+
+  nb = 0;
+  for (i = 0; i < n; i++)
+    {
+      if (dur[i + 1] <= 0 || dem[i + 1] <= 0)
+	continue;
+
+      if (dem[i + 1] > capa)
+	return FALSE;
+
+      t = cu_task + nb++;
+      t->fdv_adr = array[i];
+      t->dur = dur[i + 1];
+      t->dem = dem[i + 1];
+      t->energy = Pl_Range_Mul_Sat(t->dur, t->dem);
+    }
+
+  do
+    {
+      changed = FALSE;
+      if (!Cumul_Filter(nb, capa, FALSE, &changed) ||
+	  !Cumul_Filter(nb, capa, TRUE, &changed))
+	return FALSE;
+    }
+  while (changed);
+
+  FD_Bind_OV(work + CUMUL_STAMP, Cumul_Stamp(array, n));
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CUMUL_ALLOC                                                             *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Cumul_Alloc(int n)
+{
+  if (n <= cu_nb_task)
+    return;
+
+  cu_nb_task = n + n / 2;
+  n = cu_nb_task;
+  cu_task = (CumulTask *) Realloc(cu_task, n * sizeof(CumulTask));
+  cu_by_est = (CumulTask **) Realloc(cu_by_est, n * sizeof(CumulTask *));
+  cu_by_lct = (CumulTask **) Realloc(cu_by_lct, n * sizeof(CumulTask *));
+  cu_event = (CumulEvent *) Realloc(cu_event, 2 * n * sizeof(CumulEvent));
+  cu_seg_start = (PlLong *) Realloc(cu_seg_start, 2 * n * sizeof(PlLong));
+  cu_seg_end = (PlLong *) Realloc(cu_seg_end, 2 * n * sizeof(PlLong));
+  cu_seg_height = (PlLong *) Realloc(cu_seg_height, 2 * n * sizeof(PlLong));
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CUMUL_STAMP                                                             *
+ *                                                                         *
+ * Returns a number which strictly decreases each time a bound is reduced  *
+ * (never 0, the initial work value).                                      *
+ *-------------------------------------------------------------------------*/
+static PlLong
+Cumul_Stamp(WamWord **array, int n)
+{
+  PlLong stamp = 1;
+  int i;
+
+  for (i = 0; i < n; i++)
+    stamp += Max(array[i]) - Min(array[i]);
+
+  return stamp;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CUMUL_FILTER                                                            *
+ *                                                                         *
+ * Filters the earliest starts (or the latest starts if mirror: the time   *
+ * window [est, lct) of a task becomes [-lct, -est)). Sets *changed if a   *
+ * bound is updated.                                                       *
+ *-------------------------------------------------------------------------*/
+static Bool
+Cumul_Filter(int nb, PlLong capa, Bool mirror, Bool *changed)
+{
+  CumulTask *t;
+  PlLong min, max;
+  int i;
+
+  for (i = 0; i < nb; i++)
+    {
+      t = cu_task + i;
+      min = Min(t->fdv_adr);
+      max = Max(t->fdv_adr);
+      if (!mirror)
+	{
+	  t->est = min;
+	  t->lct = max + t->dur;
+	}
+      else
+	{
+	  t->est = -(max + t->dur);
+	  t->lct = -min;
+	}
+      t->new_est = t->est;
+    }
+
+  if (!Cumul_Time_Table(nb, capa) || !Cumul_Edge_Finding(nb, capa))
+    return FALSE;
+
+  for (i = 0; i < nb; i++)
+    {
+      t = cu_task + i;
+      if (t->new_est <= t->est)
+	continue;
+
+      if (t->new_est > t->lct - t->dur)
+	return FALSE;
+
+      min = Min(t->fdv_adr);
+      max = Max(t->fdv_adr);
+      if (!mirror)
+	min = t->new_est;
+      else
+	max = -t->new_est - t->dur;
+
+      if (!Pl_Fd_Tell_Interval(t->fdv_adr, min, max))
+	return FALSE;
+
+      *changed = TRUE;
+    }
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CUMUL_TIME_TABLE                                                        *
+ *                                                                         *
+ * Builds the profile of the compulsory parts [lct - dur, est + dur) and   *
+ * pushes each task after the segments where it does not fit.              *
+ *-------------------------------------------------------------------------*/
+static Bool
+Cumul_Time_Table(int nb, PlLong capa)
+{
+  CumulTask *t;
+  PlLong lst, ect, est, height;
+  Bool own;
+  int nb_event = 0;
+  int i, k;
+
+  for (i = 0; i < nb; i++)
+    {
+      t = cu_task + i;
+      lst = t->lct - t->dur;
+      ect = t->est + t->dur;
+      if (lst < ect)
+	{
+	  cu_event[nb_event].time = lst;
+	  cu_event[nb_event++].delta = t->dem;
+	  cu_event[nb_event].time = ect;
+	  cu_event[nb_event++].delta = -t->dem;
+	}
+    }
+
+  if (nb_event == 0)
+    return TRUE;
+
+  qsort(cu_event, nb_event, sizeof(CumulEvent), Cumul_Cmp_Event);
+
+  cu_nb_seg = 0;
+  height = 0;
+  for (k = 0; k < nb_event; k++)
+    {
+      height += cu_event[k].delta;
+      if (k + 1 < nb_event && cu_event[k + 1].time == cu_event[k].time)
+	continue;
+
+      if (height > capa)
+	return FALSE;
+
+      if (height > 0)		/* then k + 1 < nb_event */
+	{
+	  cu_seg_start[cu_nb_seg] = cu_event[k].time;
+	  cu_seg_end[cu_nb_seg] = cu_event[k + 1].time;
+	  cu_seg_height[cu_nb_seg++] = height;
+	}
+    }
+
+  for (i = 0; i < nb; i++)
+    {
+      t = cu_task + i;
+      lst = t->lct - t->dur;
+      ect = t->est + t->dur;
+      est = t->est;
+      for (k = 0; k < cu_nb_seg && cu_seg_start[k] < est + t->dur; k++)
+	{
+	  if (cu_seg_end[k] <= est)
+	    continue;
+				/* a segment is inside or outside the own part */
+	  own = (cu_seg_start[k] >= lst && cu_seg_end[k] <= ect);
+	  height = cu_seg_height[k] - ((own) ? t->dem : 0);
+	  if (height + t->dem > capa)
+	    est = cu_seg_end[k];
+	}
+
+      if (est > t->new_est)
+	t->new_est = est;
+    }
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CUMUL_EDGE_FINDING                                                      *
+ *                                                                         *
+ * Overload checking and edge-finding in O(n^2), see R. Kameugne, L. P.    *
+ * Fotso, J. Scott, Y. Ngo-Kateu: "A quadratic edge-finding filtering      *
+ * algorithm for cumulative resource constraints" (2011). For each task U  *
+ * (by increasing lct) let LCut(U) be the tasks with lct <= lct(U). A task *
+ * i not in LCut(U) is detected to end after lct(U) if it cannot end       *
+ * before, then its est is updated w.r.t. the subsets of LCut(U) (or of a  *
+ * previous LCut) which leave too little room for i.                       *
+ *-------------------------------------------------------------------------*/
+static Bool
+Cumul_Edge_Finding(int nb, PlLong capa)
+{
+  CumulTask *t, *u;
+  PlLong b, energy, max_energy, r_rho, r_tau, min_sl, sl, rest, upd;
+  Bool has_rho;
+  int i, k;
+
+  for (i = 0; i < nb; i++)
+    {
+      t = cu_task + i;
+      cu_by_est[i] = cu_by_lct[i] = t;
+      t->dupd = t->slupd = t->est;
+    }
+
+  qsort(cu_by_est, nb, sizeof(CumulTask *), Cumul_Cmp_Est);
+  qsort(cu_by_lct, nb, sizeof(CumulTask *), Cumul_Cmp_Lct);
+
+  /* the energies below are <= capa * horizon (else overload): skip the */
+  /* edge-finding (time-tabling is enough to be correct) if too large   */
+  if (nb == 0 || Pl_Range_Mul_Sat(capa, cu_by_lct[nb - 1]->lct -
+				  cu_by_est[0]->est) >= RANGE_SAT_MAX)
+    return TRUE;
+
+  for (i = 0; i < nb; i++)
+    {
+      u = cu_by_lct[i];
+      b = u->lct;
+      if (i + 1 < nb && cu_by_lct[i + 1]->lct == b)
+	continue;		/* same LCut for equal lct */
+
+      energy = 0;
+      max_energy = 0;
+      r_rho = 0;
+      has_rho = FALSE;
+      for (k = nb - 1; k >= 0; k--)
+	{
+	  t = cu_by_est[k];
+	  if (t->lct <= b)
+	    {
+	      energy += t->energy;
+	      if (energy > capa * (b - t->est))
+		return FALSE;	/* overload */
+
+	      if (!has_rho || Pl_Range_Mul_Sat(energy, b - r_rho) >
+		  Pl_Range_Mul_Sat(max_energy, b - t->est))
+		{		/* densest task interval */
+		  max_energy = energy;
+		  r_rho = t->est;
+		  has_rho = TRUE;
+		}
+	    }
+	  else if (has_rho)
+	    {
+	      rest = max_energy - (capa - t->dem) * (b - r_rho);
+	      if (rest > 0)
+		{
+		  upd = r_rho + (rest + t->dem - 1) / t->dem;
+		  if (upd > t->dupd)
+		    t->dupd = upd;
+		}
+	    }
+	  t->e_cut = energy;	/* energy of the tasks in [est, b] */
+	}
+
+      min_sl = capa * (b - cu_by_est[0]->est) + 1;
+      r_tau = b;
+      for (k = 0; k < nb; k++)
+	{
+	  t = cu_by_est[k];
+	  sl = capa * (b - t->est) - t->e_cut;
+	  if (t->est < b && sl < min_sl)
+	    {			/* smallest slack in [r_tau, b] */
+	      min_sl = sl;
+	      r_tau = t->est;
+	    }
+
+	  if (t->lct <= b)
+	    continue;
+
+	  rest = t->dem * (b - r_tau) - min_sl;
+	  if (rest > 0)
+	    {
+	      upd = r_tau + (rest + t->dem - 1) / t->dem;
+	      if (upd > t->slupd)
+		t->slupd = upd;
+	    }
+
+	  if (t->est + t->dur >= b || min_sl < t->energy)
+	    {			/* t ends after all tasks of LCut(U) */
+	      upd = (t->dupd > t->slupd) ? t->dupd : t->slupd;
+	      if (upd > t->new_est)
+		t->new_est = upd;
+	    }
+	}
+    }
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CUMUL_CMP_EVENT                                                         *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static int
+Cumul_Cmp_Event(const void *p1, const void *p2)
+{
+  PlLong t1 = ((CumulEvent *) p1)->time;
+  PlLong t2 = ((CumulEvent *) p2)->time;
+
+  return (t1 < t2) ? -1 : (t1 > t2);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CUMUL_CMP_EST                                                           *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static int
+Cumul_Cmp_Est(const void *p1, const void *p2)
+{
+  PlLong t1 = (*(CumulTask **) p1)->est;
+  PlLong t2 = (*(CumulTask **) p2)->est;
+
+  return (t1 < t2) ? -1 : (t1 > t2);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CUMUL_CMP_LCT                                                           *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static int
+Cumul_Cmp_Lct(const void *p1, const void *p2)
+{
+  PlLong t1 = (*(CumulTask **) p1)->lct;
+  PlLong t2 = (*(CumulTask **) p2)->lct;
+
+  return (t1 < t2) ? -1 : (t1 > t2);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_CIRCUIT                                                           *
+ *                                                                         *
+ * The ith variable is the successor (in 1..n) of the node i. If sub is    *
+ * FALSE the successors form a Hamiltonian circuit, else the nodes whose   *
+ * successor is not themselves form a single circuit (possibly empty).     *
+ * fd_symbolic.pl also posts an fd_all_different. The filtering is         *
+ * repeated until the domains no longer change (the constraint is          *
+ * idempotent).                                                            *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Circuit(WamWord **array, PlLong sub, WamWord *work)
+{
+  int n = (int) (PlLong) *array++;
+  PlLong val_min, val_max;
+  PlLong stamp, prev_stamp;
+
+  if (n <= 1)
+    return TRUE;
+
+  stamp = All_Diff_Stamp(array, n, FALSE, &val_min, &val_max);
+  if (stamp == work[CIRCUIT_STAMP])
+    return TRUE;
+
+  do
+    {
+      prev_stamp = stamp;
+      if (!Circuit_Filter(array, n, (Bool) sub))
+	return FALSE;
+      stamp = All_Diff_Stamp(array, n, FALSE, &val_min, &val_max);
+    }
+  while (stamp != prev_stamp);
+
+  FD_Bind_OV(work + CIRCUIT_STAMP, stamp);
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CIRCUIT_ALLOC                                                           *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Circuit_Alloc(int n, int nb_arc)
+{
+  if (n > ci_nb_node)
+    {
+      ci_nb_node = n + n / 2;
+      n = ci_nb_node;
+      ci_next = (int *) Realloc(ci_next, n * sizeof(int));
+      ci_mark = (int *) Realloc(ci_mark, n * sizeof(int));
+      ci_out_beg = (int *) Realloc(ci_out_beg, (n + 1) * sizeof(int));
+      ci_in_beg = (int *) Realloc(ci_in_beg, (n + 1) * sizeof(int));
+      ci_index = (int *) Realloc(ci_index, n * sizeof(int));
+      ci_low = (int *) Realloc(ci_low, n * sizeof(int));
+      ci_stack = (int *) Realloc(ci_stack, n * sizeof(int));
+      ci_comp = (int *) Realloc(ci_comp, n * sizeof(int));
+      ci_order = (int *) Realloc(ci_order, n * sizeof(int));
+      ci_po_num = (int *) Realloc(ci_po_num, n * sizeof(int));
+      ci_idom = (int *) Realloc(ci_idom, n * sizeof(int));
+      ci_child = (int *) Realloc(ci_child, n * sizeof(int));
+      ci_sibling = (int *) Realloc(ci_sibling, n * sizeof(int));
+      ci_pre = (int *) Realloc(ci_pre, n * sizeof(int));
+      ci_post = (int *) Realloc(ci_post, n * sizeof(int));
+    }
+
+  if (nb_arc > ci_nb_arc)
+    {
+      ci_nb_arc = nb_arc + nb_arc / 2;
+      ci_out = (int *) Realloc(ci_out, ci_nb_arc * sizeof(int));
+      ci_in = (int *) Realloc(ci_in, ci_nb_arc * sizeof(int));
+    }
+}
 
 
 
 
 /*-------------------------------------------------------------------------*
- * PL_FD_ALL_DIFFERENT_1                                                   *
+ * CIRCUIT_FILTER                                                          *
  *                                                                         *
+ * One pass of the filtering: subtour prevention on the fixed chains, then *
+ * SCC and dominator filtering on the graph i -> j (j + 1 in dom(Xi) and   *
+ * j != i). The graph is not rebuilt after each removal: the SCCs and the  *
+ * dominators of a graph remain valid deductions for its subgraphs.        *
  *-------------------------------------------------------------------------*/
-Bool
-Pl_Fd_All_Different_1(WamWord list_word, WamWord save_list_word)
+static Bool
+Circuit_Filter(WamWord **array, int n, Bool sub)
 {
-  WamWord word, tag_mask;
-  WamWord *lst_adr;
+  int root;
 
+  Circuit_Alloc(n, 0);
 
-  DEREF(list_word, word, tag_mask);
-  if (tag_mask == TAG_REF_MASK)
-    Pl_Err_Instantiation();
+  if (!Circuit_Chains(array, n, sub))
+    return FALSE;
 
-  if (word == NIL_WORD)
-    return TRUE;
+  Circuit_Graph(array, n);
 
-  if (tag_mask != TAG_LST_MASK)
-    Pl_Err_Type(pl_type_list, save_list_word);
+  if (!Circuit_Filter_Scc(array, n, sub))
+    return FALSE;
 
-  lst_adr = UnTag_LST(word);
-  DEREF(Car(lst_adr), word, tag_mask);
+  /* the root of the dominators must belong to the circuit */
+  for (root = 0; root < n; root++)
+    if (!Pl_Range_Test_Value(Range(array[root]), root + 1))
+      break;
 
-  if (tag_mask != TAG_REF_MASK && tag_mask != TAG_INT_MASK &&
-      tag_mask != TAG_FDV_MASK)
-    Pl_Err_Type(pl_type_fd_variable, word);
+  if (root == n)		/* subcircuit: no node necessarily in it */
+    return TRUE;
 
-  return Fd_All_Different_Rec(Cdr(lst_adr), tag_mask, word, save_list_word) &&
-    Pl_Fd_All_Different_1(Cdr(lst_adr), save_list_word);
+  return Circuit_Filter_Dom(array, n, root, FALSE) &&
+    Circuit_Filter_Dom(array, n, root, TRUE);
 }
 
 
 
 
 /*-------------------------------------------------------------------------*
- * FD_ALL_DIFFERENT_REC                                                    *
+ * CIRCUIT_CHAINS                                                          *
  *                                                                         *
+ * The fixed successors form chains and cycles. A node with a predecessor  *
+ * belongs to the circuit. A chain s -> ... -> e cannot be closed (e -> s) *
+ * while a node outside it must belong to the circuit. A cycle must contain*
+ * all the nodes of the circuit (the others are their own successor).      *
  *-------------------------------------------------------------------------*/
 static Bool
-Fd_All_Different_Rec(WamWord list_word, PlLong x_tag, WamWord x_word,
-		     WamWord save_list_word)
+Circuit_Chains(WamWord **array, int n, Bool sub)
 {
-  WamWord word, tag_mask;
-  WamWord *lst_adr;
-  int ret;
+  WamWord *fdv_adr;
+  int i, j, s, e, len;
+  int nb_mand, nb_cycle;
+
+  for (i = 0; i < n; i++)
+    {
+      ci_next[i] = -1;
+      ci_mark[i] = 0;
+    }
 
+  for (i = 0; i < n; i++)
+    {
+      fdv_adr = array[i];
+      if (!sub && !Pl_Fd_Tell_Not_Value(fdv_adr, i + 1))
+	return FALSE;
 
-  DEREF(list_word, word, tag_mask);
-  if (tag_mask == TAG_REF_MASK)
-    Pl_Err_Instantiation();
+      if (!Fd_Variable_Is_Ground(fdv_adr) || (j = (int) Min(fdv_adr) - 1) == i)
+	continue;
 
-  if (word == NIL_WORD)
-    return TRUE;
+      /* fd_all_different may not have been woken yet */
+      if (ci_mark[j] & CIRCUIT_HAS_PRED)
+	return FALSE;
 
-  if (tag_mask != TAG_LST_MASK)
-    Pl_Err_Type(pl_type_list, save_list_word);
+      ci_next[i] = j;
+      ci_mark[j] |= CIRCUIT_HAS_PRED;
+    }
 
-  lst_adr = UnTag_LST(word);
-  DEREF(Car(lst_adr), word, tag_mask);
+  nb_mand = 0;
+  for (i = 0; i < n; i++)
+    {
+      fdv_adr = array[i];
+      if ((ci_mark[i] & CIRCUIT_HAS_PRED) && !Pl_Fd_Tell_Not_Value(fdv_adr, i + 1))
+	return FALSE;
 
-  if (tag_mask != TAG_REF_MASK && tag_mask != TAG_INT_MASK &&
-      tag_mask != TAG_FDV_MASK)
-    Pl_Err_Type(pl_type_fd_variable, word);
+      if (!Pl_Range_Test_Value(Range(fdv_adr), i + 1))
+	nb_mand++;
+    }
 
-  if (x_tag == TAG_INT_MASK)
-    ret = (tag_mask == TAG_INT_MASK) ? x_word != word :
-             pl_x_neq_c(word, x_word);
-  else
-    ret = (tag_mask == TAG_INT_MASK) ? pl_x_neq_c(x_word, word) :
-             pl_x_neq_y(x_word, word);
+  /* all the nodes of a chain belong to the circuit */
+  for (s = 0; s < n; s++)
+    {
+      if (ci_next[s] < 0 || (ci_mark[s] & CIRCUIT_HAS_PRED))
+	continue;
+
+      len = 1;
+      for (e = s; ci_next[e] >= 0; e = ci_next[e])
+	{
+	  ci_mark[e] |= CIRCUIT_VISITED;
+	  len++;
+	}
+      ci_mark[e] |= CIRCUIT_VISITED;
+
+      if (len < nb_mand && !Pl_Fd_Tell_Not_Value(array[e], s + 1))
+	return FALSE;
+    }
+
+  /* the remaining fixed nodes form cycles */
+  nb_cycle = 0;
+  for (i = 0; i < n; i++)
+    {
+      if (ci_next[i] < 0 || (ci_mark[i] & CIRCUIT_VISITED))
+	continue;
 
-  return ret &&
-    Fd_All_Different_Rec(Cdr(lst_adr), x_tag, x_word, save_list_word);
+      if (++nb_cycle > 1)
+	return FALSE;
+
+      len = 0;
+      j = i;
+      do
+	{
+	  ci_mark[j] |= CIRCUIT_VISITED | CIRCUIT_CYCLE;
+	  j = ci_next[j];
+	  len++;
+	}
+      while (j != i);
+
+      if (len < nb_mand)
+	return FALSE;
+
+      for (j = 0; j < n; j++)
+	if (!(ci_mark[j] & CIRCUIT_CYCLE) && !Pl_Fd_Tell_Value(array[j], j + 1))
+	  return FALSE;
+    }
+
+  return TRUE;
 }
 
 
 
 
 /*-------------------------------------------------------------------------*
- * PL_FD_ELEMENT_I                                                         *
+ * CIRCUIT_GRAPH                                                           *
  *                                                                         *
+ * Builds the successor and predecessor lists (self loops are ignored).    *
  *-------------------------------------------------------------------------*/
-void
-Pl_Fd_Element_I(Range *i, WamWord *l)
+static void
+Circuit_Graph(WamWord **array, int n)
 {
-  int n = (int) (*l);			/* I in 1..N in sparse mode */
+  Range *r;
+  int nb_arc = 0;
+  int i, j, k, v;
 
-  Range_Init_Interval(i, 1, n);
-  Pl_Range_Becomes_Sparse(i);
+  for (i = 0; i < n; i++)
+    nb_arc += (int) Nb_Elem(array[i]);
+
+  Circuit_Alloc(n, nb_arc);
+
+  for (j = 0; j <= n; j++)
+    ci_in_beg[j] = 0;
+
+  k = 0;
+  for (i = 0; i < n; i++)
+    {
+      ci_out_beg[i] = k;
+      r = Range(array[i]);
+      Ad_For_Each_Value(r, v)
+	{
+	  j = v - 1;
+	  if (j != i && j >= 0 && j < n)
+	    {
+	      ci_out[k++] = j;
+	      ci_in_beg[j + 1]++;
+	    }
+	}
+    }
+  ci_out_beg[n] = k;
+
+  for (j = 0; j < n; j++)
+    {
+      ci_in_beg[j + 1] += ci_in_beg[j];
+      ci_mark[j] = ci_in_beg[j];	/* insertion point */
+    }
+
+  for (i = 0; i < n; i++)
+    for (k = ci_out_beg[i]; k < ci_out_beg[i + 1]; k++)
+      {
+	j = ci_out[k];
+	ci_in[ci_mark[j]++] = i;
+      }
 }
 
 
 
 
 /*-------------------------------------------------------------------------*
- * PL_FD_ELEMENT_I_TO_V                                                    *
+ * CIRCUIT_FILTER_SCC                                                      *
  *                                                                         *
+ * An arc between 2 SCCs belongs to no circuit. For fd_circuit the graph   *
+ * must be strongly connected. For fd_subcircuit the nodes which must be   *
+ * in the circuit have to be in the same SCC and the nodes of the other    *
+ * SCCs are their own successor.                                           *
  *-------------------------------------------------------------------------*/
-void
-Pl_Fd_Element_I_To_V(Range *v, Range *i, WamWord *l)
+static Bool
+Circuit_Filter_Scc(WamWord **array, int n, Bool sub)
 {
-  int val;
-  int j;
+  int i, j, k, c;
 
-  /* when I changes -> update V */
+  for (i = 0; i < n; i++)
+    ci_index[i] = -1;
 
-  Vector_Allocate(v->vec);
-  Pl_Vector_Empty(v->vec);
+  ci_stack_top = 0;
+  ci_index_counter = 0;
+  ci_nb_comp = 0;
+  for (i = 0; i < n; i++)
+    if (ci_index[i] < 0)
+      Circuit_Scc(i);
 
-  if (i->min == i->max || Is_Interval(i))
+  if (ci_nb_comp == 1)
+    return TRUE;
+
+  if (!sub)
+    return FALSE;
+
+  c = -1;
+  for (i = 0; i < n; i++)
+    if (!Pl_Range_Test_Value(Range(array[i]), i + 1))
+      {
+	if (c < 0)
+	  c = ci_comp[i];
+	else if (ci_comp[i] != c)
+	  return FALSE;
+      }
+
+  for (i = 0; i < n; i++)
     {
-      for (j = i->min; j <= i->max; j++)
+      if (c >= 0 && ci_comp[i] != c)
 	{
-	  val = (int) (l[j]);
-	  Vector_Set_Value(v->vec, val);
+	  if (!Pl_Fd_Tell_Value(array[i], i + 1))
+	    return FALSE;
+	  continue;
 	}
-    }
-  else
-    {
-      VECTOR_BEGIN_ENUM(i->vec, j);
 
-      val = (int) (l[j]);
-      Vector_Set_Value(v->vec, val);
-
-      VECTOR_END_ENUM;
+      for (k = ci_out_beg[i]; k < ci_out_beg[i + 1]; k++)
+	{
+	  j = ci_out[k];
+	  if (ci_comp[j] != ci_comp[i] && !Pl_Fd_Tell_Not_Value(array[i], j + 1))
+	    return FALSE;
+	}
     }
 
-  Pl_Range_From_Vector(v);
+  return TRUE;
 }
 
 
 
 
 /*-------------------------------------------------------------------------*
- * PL_FD_ELEMENT_V_TO_I                                                    *
+ * CIRCUIT_SCC                                                             *
  *                                                                         *
+ * Tarjan's algorithm.                                                     *
  *-------------------------------------------------------------------------*/
-void
-Pl_Fd_Element_V_To_I(Range *i, Range *v, WamWord *l)
+static void
+Circuit_Scc(int x)
 {
-  int val;
-  int n;
-  int j;
-
-  /* when V changes -> update I */
-
-  Vector_Allocate(i->vec);
-  Pl_Vector_Empty(i->vec);
+  int k, y;
 
-  n = (int) (*l);
+  ci_index[x] = ci_low[x] = ci_index_counter++;
+  ci_comp[x] = -1;		/* -1: on the stack */
+  ci_stack[ci_stack_top++] = x;
 
-  for (j = 1; j <= n; j++)
+  for (k = ci_out_beg[x]; k < ci_out_beg[x + 1]; k++)
     {
-      val = (int) (l[j]);		/* val=Lj */
-      if (Pl_Range_Test_Value(v, val))
-	Vector_Set_Value(i->vec, j);
+      y = ci_out[k];
+      if (ci_index[y] < 0)
+	{
+	  Circuit_Scc(y);
+	  if (ci_low[y] < ci_low[x])
+	    ci_low[x] = ci_low[y];
+	}
+      else if (ci_comp[y] < 0 && ci_index[y] < ci_low[x])
+	ci_low[x] = ci_index[y];
     }
 
-  Pl_Range_From_Vector(i);
+  if (ci_low[x] == ci_index[x])
+    {
+      do
+	{
+	  y = ci_stack[--ci_stack_top];
+	  ci_comp[y] = ci_nb_comp;
+	}
+      while (y != x);
+
+      ci_nb_comp++;
+    }
 }
 
 
 
 
 /*-------------------------------------------------------------------------*
- * PL_FD_ELEMENT_VAR_I                                                     *
+ * CIRCUIT_FILTER_DOM                                                      *
  *                                                                         *
+ * Let root be a node of the circuit. If the arc i -> j is used, the path  *
+ * of the circuit from root to i does not contain j (unless j = root). Thus*
+ * i -> j can be removed if j dominates i. Symmetrically (reverse graph),  *
+ * i -> j can be removed if i is on every path from j to root (i != root). *
+ * See L. Fages, X. Lorca: "Improving the asymmetric TSP by considering    *
+ * graph structure" (2012).                                                *
  *-------------------------------------------------------------------------*/
-void
-Pl_Fd_Element_Var_I(Range *i, WamWord *l)
+static Bool
+Circuit_Filter_Dom(WamWord **array, int n, int root, Bool reverse)
 {
-  int n = (int) (*l);			/* I in 1..N in sparse mode */
+  int i, j, k, x, y;
 
-  Range_Init_Interval(i, 1, n);
-  Pl_Range_Becomes_Sparse(i);
+  if (reverse)
+    Circuit_Dominators(n, root, ci_in_beg, ci_in, ci_out_beg, ci_out);
+  else
+    Circuit_Dominators(n, root, ci_out_beg, ci_out, ci_in_beg, ci_in);
+
+  for (i = 0; i < n; i++)
+    for (k = ci_out_beg[i]; k < ci_out_beg[i + 1]; k++)
+      {
+	j = ci_out[k];
+	x = (reverse) ? j : i;	/* remove i -> j if y dominates x */
+	y = (reverse) ? i : j;
+
+	if (y != root && ci_pre[x] >= 0 && ci_pre[y] >= 0 &&
+	    Ci_Dominates(y, x) && !Pl_Fd_Tell_Not_Value(array[i], j + 1))
+	  return FALSE;
+      }
+
+  return TRUE;
 }
 
 
 
 
 /*-------------------------------------------------------------------------*
- * PL_FD_ELEMENT_VAR_I_TO_V                                                *
+ * CIRCUIT_DOMINATORS                                                      *
  *                                                                         *
+ * Computes the immediate dominators of the nodes reachable from root, see *
+ * K. D. Cooper, T. J. Harvey, K. Kennedy: "A simple, fast dominance       *
+ * algorithm" (2001), then numbers the dominator tree (ci_pre/ci_post, -1  *
+ * for unreachable nodes) to test the dominance in constant time.          *
  *-------------------------------------------------------------------------*/
-void
-Pl_Fd_Element_Var_I_To_V(Range *v, Range *i, WamWord **l)
+static void
+Circuit_Dominators(int n, int root, int *succ_beg, int *succ,
+		   int *pred_beg, int *pred)
 {
-  WamWord *fdv_adr;
-  int j;
+  int i, k, b, p, a, c, new_idom, nb;
+  Bool changed;
 
-  v->extra_cstr = FALSE;
-  v->vec = 0;
-  Set_To_Empty(v);
+  for (i = 0; i < n; i++)
+    {
+      ci_po_num[i] = -1;
+      ci_idom[i] = -1;
+      ci_child[i] = -1;
+      ci_pre[i] = -1;		/* also the visit mark of Circuit_Dfs */
+      ci_post[i] = -1;
+    }
 
-  /* when I or L changes -> update V */
+  ci_counter = 0;
+  Circuit_Dfs(root, succ_beg, succ);
+  nb = ci_counter;
 
-  if (i->min == i->max || Is_Interval(i))
+  ci_idom[root] = root;
+  do
     {
-      for (j = i->min; j <= i->max; j++)
+      changed = FALSE;
+      for (i = nb - 2; i >= 0; i--)	/* reverse postorder (root is last) */
 	{
-	  fdv_adr = l[j];
-	  Pl_Range_Union(v, Range(fdv_adr));
+	  b = ci_order[i];
+	  new_idom = -1;
+	  for (k = pred_beg[b]; k < pred_beg[b + 1]; k++)
+	    {
+	      p = pred[k];
+	      if (ci_idom[p] < 0)
+		continue;
+
+	      if (new_idom < 0)
+		{
+		  new_idom = p;
+		  continue;
+		}
+
+	      a = p;		/* intersect */
+	      c = new_idom;
+	      while (a != c)
+		{
+		  while (ci_po_num[a] < ci_po_num[c])
+		    a = ci_idom[a];
+		  while (ci_po_num[c] < ci_po_num[a])
+		    c = ci_idom[c];
+		}
+	      new_idom = a;
+	    }
+
+	  if (ci_idom[b] != new_idom)
+	    {
+	      ci_idom[b] = new_idom;
+	      changed = TRUE;
+	    }
 	}
     }
-  else
+  while (changed);
+
+  for (i = 0; i < nb; i++)
     {
-      VECTOR_BEGIN_ENUM(i->vec, j);
+      b = ci_order[i];
+      if (b == root)
+	continue;
 
-      fdv_adr = l[j];
-      Pl_Range_Union(v, Range(fdv_adr));
+      p = ci_idom[b];
+      ci_sibling[b] = ci_child[p];
+      ci_child[p] = b;
+    }
 
-      VECTOR_END_ENUM;
+  ci_counter = 0;
+  Circuit_Dom_Number(root);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CIRCUIT_DFS                                                             *
+ *                                                                         *
+ * Appends the nodes reachable from x to ci_order in postorder.            *
+ *-------------------------------------------------------------------------*/
+static void
+Circuit_Dfs(int x, int *succ_beg, int *succ)
+{
+  int k, y;
+
+  ci_pre[x] = 0;		/* visited */
+  for (k = succ_beg[x]; k < succ_beg[x + 1]; k++)
+    {
+      y = succ[k];
+      if (ci_pre[y] < 0)
+	Circuit_Dfs(y, succ_beg, succ);
     }
+
+  ci_po_num[x] = ci_counter;
+  ci_order[ci_counter++] = x;
 }
 
 
 
 
 /*-------------------------------------------------------------------------*
- * PL_FD_ELEMENT_VAR_V_TO_I                                                *
+ * CIRCUIT_DOM_NUMBER                                                      *
  *                                                                         *
  *-------------------------------------------------------------------------*/
-void
-Pl_Fd_Element_Var_V_To_I(Range *i, Range *v, WamWord **l)
+static void
+Circuit_Dom_Number(int x)
 {
-  WamWord *fdv_adr;
-  PlLong n;
-  int j;
+  int y;
 
-  Vector_Allocate(i->vec);
-  Pl_Vector_Empty(i->vec);
-  /* when V or L changes -> update I */
+  ci_pre[x] = ci_counter++;
+  for (y = ci_child[x]; y >= 0; y = ci_sibling[y])
+    Circuit_Dom_Number(y);
+  ci_post[x] = ci_counter++;
+}
 
-  n = (PlLong) *l;
 
-  for (j = 1; j <= n; j++)
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_GLOBAL_CARDINALITY                                                *
+ *                                                                         *
+ * The ith count is the number of vars equal to the ith key (keys are    *
+ * sorted and distinct, each var is equal to a key). The filtering is      *
+ * based on a feasible flow (J.-C. Regin: "Generalized arc consistency for *
+ * global cardinality constraint", 1996): vars -> keys -> sink with the    *
+ * bounds of the counts as capacities of the key -> sink arcs. If bounds   *
+ * is TRUE the domain of a var is relaxed to its interval, which gives     *
+ * bounds consistency. Like in fd_all_different, the flow is kept from one *
+ * call to the next (only repaired) and needs no trailing.                 *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Global_Cardinality(WamWord **array, WamWord *keys, WamWord **counts,
+			 PlLong bounds, WamWord *work)
+{
+  int n = (int) (PlLong) *array++;
+  int m = (int) *keys++;
+  PlLong val_min, val_max;
+  PlLong stamp, prev_stamp;
+
+  counts++;
+
+#define Gcc_Stamp()							\
+  (All_Diff_Stamp(array, n, (Bool) bounds, &val_min, &val_max) +	\
+   All_Diff_Stamp(counts, m, TRUE, &val_min, &val_max))
+
+  stamp = Gcc_Stamp();
+  if (stamp == work[GCC_STAMP])
+    return TRUE;
+
+  Gcc_Alloc(n, m);
+  gc_array = array;
+  gc_key = (PlLong *) keys;
+  gc_n = n;
+  gc_m = m;
+  gc_bounds = (Bool) bounds;
+
+  do
     {
-      fdv_adr = l[j];
-      if (!Pl_Range_Test_Null_Inter(Range(fdv_adr), v))
-	  Vector_Set_Value(i->vec, j);
+      prev_stamp = stamp;
+      if (!Gcc_Filter(work, counts))
+	return FALSE;
+      stamp = Gcc_Stamp();
     }
+  while (stamp != prev_stamp);
 
-  Pl_Range_From_Vector(i);
+#undef Gcc_Stamp
+
+  FD_Bind_OV(work + GCC_STAMP, stamp);
+
+  return TRUE;
 }
 
 
 
 
 /*-------------------------------------------------------------------------*
- * PL_FD_ELEMENT_V_TO_XI                                                   *
+ * GCC_ALLOC                                                               *
  *                                                                         *
  *-------------------------------------------------------------------------*/
-Bool
-Pl_Fd_Element_V_To_Xi(int i, WamWord **array, Range *v)
+static void
+Gcc_Alloc(int n, int m)
 {
-  WamWord *fdv_adr = array[i];
+  int nb_node;
 
-  if (Fd_Variable_Is_Ground(fdv_adr))
-    return Pl_Fd_Tell_Int_Range(fdv_adr, v);
+  if (n <= gc_nb_var && m <= gc_nb_key)
+    return;
 
-  return Pl_Fd_Tell_Range_Range(fdv_adr, v);
+  if (n > gc_nb_var)
+    {
+      gc_nb_var = n + n / 2;
+      n = gc_nb_var;
+      gc_mate = (int *) Realloc(gc_mate, n * sizeof(int));
+      gc_next = (int *) Realloc(gc_next, n * sizeof(int));
+      gc_prev = (int *) Realloc(gc_prev, n * sizeof(int));
+    }
+
+  if (m > gc_nb_key)
+    {
+      gc_nb_key = m + m / 2;
+      m = gc_nb_key;
+      gc_first = (int *) Realloc(gc_first, m * sizeof(int));
+      gc_flow = (int *) Realloc(gc_flow, m * sizeof(int));
+      gc_low = (PlLong *) Realloc(gc_low, m * sizeof(PlLong));
+      gc_up = (PlLong *) Realloc(gc_up, m * sizeof(PlLong));
+      gc_visit = (int *) Realloc(gc_visit, m * sizeof(int));
+      memset(gc_visit, 0, m * sizeof(int));
+      gc_visit_stamp = 0;
+      gc_fixed = (int *) Realloc(gc_fixed, m * sizeof(int));
+      gc_possible = (int *) Realloc(gc_possible, m * sizeof(int));
+    }
+
+  nb_node = gc_nb_var + gc_nb_key + 1;
+  gc_index = (int *) Realloc(gc_index, nb_node * sizeof(int));
+  gc_low_link = (int *) Realloc(gc_low_link, nb_node * sizeof(int));
+  gc_stack = (int *) Realloc(gc_stack, nb_node * sizeof(int));
+  gc_comp = (int *) Realloc(gc_comp, nb_node * sizeof(int));
 }
 
 
 
 
 /*-------------------------------------------------------------------------*
- * PL_FD_ATMOST                                                            *
+ * GCC_FILTER                                                              *
  *                                                                         *
+ * Repairs the flow: first each var gets a key (count upper bounds), then  *
+ * each key gets enough vars (count lower bounds). In the residual graph   *
+ * (var -> key in its domain but not its mate, key -> its vars, key -> sink*
+ * if its flow < count max, sink -> key if its flow > count min) the value *
+ * of a key is removed from a var unless they are in the same SCC. Then    *
+ * the count of a key is reduced to the vars which can be equal to it.     *
  *-------------------------------------------------------------------------*/
-Bool
-Pl_Fd_Atmost(int n, WamWord **array, int v)
+static Bool
+Gcc_Filter(WamWord *work, WamWord **counts)
 {
-  WamWord **p;
-  WamWord word = Tag_INT(v);
-  PlLong size = (PlLong) array[0];
-  int nb = 0;
-  int i;
+  WamWord *mate = work + GCC_CELLS;
+  WamWord *fdv_adr;
+  int n = gc_n, m = gc_m;
+  int x, k, k_min, k_max, nb;
 
-  array++;
-  p = array;
-  for (i = 0; i < size; i++)
+  for (k = 0; k < m; k++)
     {
-      if (FD_Tag_Value(*p) == word)
-	nb++;
+      gc_low[k] = Min(counts[k]);
+      gc_up[k] = Max(counts[k]);
+      gc_flow[k] = 0;
+      gc_first[k] = -1;
+    }
+
+  for (x = 0; x < n; x++)
+    gc_mate[x] = -1;
 
-      p++;
+  for (x = 0; x < n; x++)	/* keep what remains of the previous flow */
+    {
+      k = (int) mate[x] - 1;
+      if (k >= 0 && k < m && gc_flow[k] < gc_up[k] && Gcc_Is_Key(x, k))
+	Gcc_Assign(x, k);
     }
 
-  if (nb > n)
-    return FALSE;
+  for (x = 0; x < n; x++)
+    if (gc_mate[x] < 0)
+      {
+	Gcc_New_Visit;
+	if (!Gcc_Augment_Up(x))
+	  return FALSE;
+      }
+
+  for (k = 0; k < m; k++)
+    while (gc_flow[k] < gc_low[k])
+      {
+	Gcc_New_Visit;
+	gc_visit[k] = gc_visit_stamp;
+	if (!Gcc_Augment_Low(k))
+	  return FALSE;
+      }
+
+  for (x = 0; x < n; x++)
+    mate[x] = gc_mate[x] + 1;
+
+  for (x = 0; x <= n + m; x++)
+    gc_index[x] = -1;
+
+  gc_stack_top = 0;
+  gc_index_counter = 0;
+  gc_nb_comp = 0;
+  for (x = 0; x <= n + m; x++)
+    if (gc_index[x] < 0)
+      Gcc_Scc(x);
+
+  for (x = 0; x < n; x++)
+    {
+      fdv_adr = gc_array[x];
+      if (Fd_Variable_Is_Ground(fdv_adr))
+	continue;
+
+      k_min = k_max = gc_mate[x];
+      for (k = Gcc_Next_Key(x, -1); k < m; k = Gcc_Next_Key(x, k))
+	{
+	  if (k == gc_mate[x] || gc_comp[x] == gc_comp[n + k])
+	    {
+	      if (k < k_min)
+		k_min = k;
+	      if (k > k_max)
+		k_max = k;
+	    }
+	  else if (!gc_bounds && !Pl_Fd_Tell_Not_Value(fdv_adr, gc_key[k]))
+	    return FALSE;
+	}
 
-  if (nb == n)
+      if (gc_bounds &&
+	  !Pl_Fd_Tell_Interval(fdv_adr, gc_key[k_min], gc_key[k_max]))
+	return FALSE;
+    }
+
+  for (k = 0; k < m; k++)
+    {
+      gc_fixed[k] = 0;
+      gc_possible[k] = 0;
+    }
+
+  for (x = 0; x < n; x++)
     {
-      p = array;
-      for (i = 0; i < size; i++)
+      nb = 0;
+      k_min = -1;
+      for (k = Gcc_Next_Key(x, -1); k < m; k = Gcc_Next_Key(x, k))
 	{
-	  if (!Fd_Variable_Is_Ground(*p))
-	    if (!Pl_Fd_Tell_Not_Value(*p, v))
-	      return FALSE;
-	  p++;
+	  gc_possible[k]++;
+	  k_min = k;
+	  nb++;
 	}
+      if (nb == 1)
+	gc_fixed[k_min]++;
     }
 
+  for (k = 0; k < m; k++)
+    if (!Pl_Fd_Tell_Interval(counts[k], gc_fixed[k], gc_possible[k]))
+      return FALSE;
+
   return TRUE;
 }
 
@@ -379,102 +3309,206 @@ Pl_Fd_Atmost(int n, WamWord **array, int v)
 
 
 /*-------------------------------------------------------------------------*
- * PL_FD_ATLEAST                                                           *
+ * GCC_NEXT_KEY                                                            *
  *                                                                         *
+ * Returns the next key after k (k = -1 for the first) of the var x (or m).*
  *-------------------------------------------------------------------------*/
-Bool
-Pl_Fd_Atleast(int n, WamWord **array, int v)
+static int
+Gcc_Next_Key(int x, int k)
 {
-  WamWord **p;
-  int size = (int) (PlLong) (array[0]);
-  int nb = size;
-  int i;
+  WamWord *fdv_adr = gc_array[x];
+  PlLong max = Max(fdv_adr);
+  int lo, hi, mid;
 
-  array++;
-  p = array;
-  for (i = 0; i < size; i++)
+  if (k < 0)			/* binary search of the first key >= min */
     {
-      if (!Pl_Range_Test_Value(Range(*p), v))
-	  nb--;
-
-      p++;
+      lo = 0;
+      hi = gc_m;
+      while (lo < hi)
+	{
+	  mid = (lo + hi) / 2;
+	  if (gc_key[mid] < Min(fdv_adr))
+	    lo = mid + 1;
+	  else
+	    hi = mid;
+	}
+      k = lo;
     }
+  else
+    k++;
 
-  if (nb < n)
-    return FALSE;
+  for (; k < gc_m && gc_key[k] <= max; k++)
+    if (gc_bounds || Pl_Range_Test_Value(Range(fdv_adr), gc_key[k]))
+      return k;
 
-  if (nb == n)
-    {
-      p = array;
-      for (i = 0; i < size; i++)
-	{
-	  if (Pl_Range_Test_Value(Range(*p), v))
-	    if (!Pl_Fd_Tell_Value(*p, v))
-	        return FALSE;
+  return gc_m;
+}
 
-	  p++;
-	}
+
+
+
+/*-------------------------------------------------------------------------*
+ * GCC_ASSIGN                                                              *
+ *                                                                         *
+ * Moves the var x to the key k in the flow.                               *
+ *-------------------------------------------------------------------------*/
+static void
+Gcc_Assign(int x, int k)
+{
+  int old = gc_mate[x];
+
+  if (old >= 0)
+    {
+      if (gc_prev[x] >= 0)
+	gc_next[gc_prev[x]] = gc_next[x];
+      else
+	gc_first[old] = gc_next[x];
+      if (gc_next[x] >= 0)
+	gc_prev[gc_next[x]] = gc_prev[x];
+      gc_flow[old]--;
     }
 
-  return TRUE;
+  gc_mate[x] = k;
+  gc_prev[x] = -1;
+  gc_next[x] = gc_first[k];
+  if (gc_first[k] >= 0)
+    gc_prev[gc_first[k]] = x;
+  gc_first[k] = x;
+  gc_flow[k]++;
 }
 
 
 
 
 /*-------------------------------------------------------------------------*
- * PL_FD_EXACTLY                                                           *
+ * GCC_AUGMENT_UP                                                          *
  *                                                                         *
+ * Searches an augmenting path from the var x (without a key) to a key     *
+ * whose flow is < its count max.                                          *
  *-------------------------------------------------------------------------*/
-Bool
-Pl_Fd_Exactly(int n, WamWord **array, int v)
+static Bool
+Gcc_Augment_Up(int x)
 {
-  WamWord **p;
-  WamWord word = Tag_INT(v);
-  int size = (int) (PlLong) (array[0]);
-  int nb1 = 0, nb2 = size;
-  int i;
+  int k, y;
 
-  array++;
-  p = array;
-  for (i = 0; i < size; i++)
+  for (k = Gcc_Next_Key(x, -1); k < gc_m; k = Gcc_Next_Key(x, k))
+    if (gc_flow[k] < gc_up[k])
+      goto found;
+
+  for (k = Gcc_Next_Key(x, -1); k < gc_m; k = Gcc_Next_Key(x, k))
     {
-      if (FD_Tag_Value(*p) == word)
-	nb1++;
-      else if (!Pl_Range_Test_Value(Range(*p), v))
-	  nb2--;
+      if (gc_visit[k] == gc_visit_stamp)
+	continue;
 
-      p++;
+      gc_visit[k] = gc_visit_stamp;
+      for (y = gc_first[k]; y >= 0; y = gc_next[y])
+	if (Gcc_Augment_Up(y))	/* y has left k */
+	  goto found;
     }
 
-  if (nb1 > n || nb2 < n)
-    return FALSE;
+  return FALSE;
 
-  if (nb1 == n)
+found:
+  Gcc_Assign(x, k);
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * GCC_AUGMENT_LOW                                                         *
+ *                                                                         *
+ * Adds a var to the key k (whose flow is < its count min), taking it from *
+ * a key whose flow is > its count min or (recursively) can be refilled.   *
+ *-------------------------------------------------------------------------*/
+static Bool
+Gcc_Augment_Low(int k)
+{
+  int x, w;
+
+  for (x = 0; x < gc_n; x++)
     {
-      p = array;
-      for (i = 0; i < size; i++)
+      w = gc_mate[x];
+      if (w == k || gc_visit[w] == gc_visit_stamp || !Gcc_Is_Key(x, k))
+	continue;
+
+      gc_visit[w] = gc_visit_stamp;
+      if (gc_flow[w] > gc_low[w] || Gcc_Augment_Low(w))
 	{
-	  if (!Fd_Variable_Is_Ground(*p))
-	    if (!Pl_Fd_Tell_Not_Value(*p, v))
-	      return FALSE;
-	  p++;
+	  Gcc_Assign(x, k);
+	  return TRUE;
 	}
+    }
+
+  return FALSE;
+}
 
-      return TRUE;
+
+
+
+/*-------------------------------------------------------------------------*
+ * GCC_SCC                                                                 *
+ *                                                                         *
+ * Tarjan's algorithm on the residual graph: nodes 0..n-1 are the vars,    *
+ * n..n+m-1 the keys and n+m the sink.                                     *
+ *-------------------------------------------------------------------------*/
+static void
+Gcc_Scc(int x)
+{
+  int n = gc_n, m = gc_m;
+  int k, y;
+
+#define Gcc_Scc_Visit(y)				\
+  do							\
+    {							\
+      if (gc_index[y] < 0)				\
+	{						\
+	  Gcc_Scc(y);					\
+	  if (gc_low_link[y] < gc_low_link[x])		\
+	    gc_low_link[x] = gc_low_link[y];		\
+	}						\
+      else if (gc_comp[y] < 0 && gc_index[y] < gc_low_link[x])	\
+	gc_low_link[x] = gc_index[y];			\
+    }							\
+  while (0)
+
+  gc_index[x] = gc_low_link[x] = gc_index_counter++;
+  gc_comp[x] = -1;		/* -1: on the stack */
+  gc_stack[gc_stack_top++] = x;
+
+  if (x < n)			/* a var */
+    {
+      for (k = Gcc_Next_Key(x, -1); k < m; k = Gcc_Next_Key(x, k))
+	if (k != gc_mate[x])
+	  Gcc_Scc_Visit(n + k);
+    }
+  else if (x < n + m)		/* a key */
+    {
+      k = x - n;
+      for (y = gc_first[k]; y >= 0; y = gc_next[y])
+	Gcc_Scc_Visit(y);
+      if (gc_flow[k] < gc_up[k])
+	Gcc_Scc_Visit(n + m);
+    }
+  else				/* the sink */
+    {
+      for (k = 0; k < m; k++)
+	if (gc_flow[k] > gc_low[k])
+	  Gcc_Scc_Visit(n + k);
     }
 
-  if (nb2 == n)
+#undef Gcc_Scc_Visit
+
+  if (gc_low_link[x] == gc_index[x])
     {
-      p = array;
-      for (i = 0; i < size; i++)
+      do
 	{
-	  if (Pl_Range_Test_Value(Range(*p), v))
-	    if (!Pl_Fd_Tell_Value(*p, v))
-	        return FALSE;
-
-	  p++;
+	  y = gc_stack[--gc_stack_top];
+	  gc_comp[y] = gc_nb_comp;
 	}
+      while (y != x);
+
+      gc_nb_comp++;
     }
-  return TRUE;
 }
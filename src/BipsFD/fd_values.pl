@@ -83,9 +83,22 @@ fd_labeling(List, Options) :-
 	'$fd_labeling'(List, Options).
 
 
+
+
+fd_labeling_parallel(List, Options) :-
+	set_bip_name(fd_labeling_parallel, 2),
+	'$check_list'(List),
+	'$get_parallel_options'(Options, NbWorkers, LabOptions, fd_labeling_parallel, 2),
+	'$set_labeling_defaults',
+	'$get_labeling_options'(LabOptions, _),	% check them before forking
+	'$fd_par'(label(List, LabOptions), List, LabOptions, NbWorkers).
+
+
 '$fd_labeling'(List, Options) :-
 	'$set_labeling_defaults',
 	'$get_labeling_options'(Options, Bckts),
+	g_read('$fd_restart', Restart),
+	g_read('$fd_recomputation', Recomp),
 	'$sys_var_read'(0, VarMethod),
 	'$sys_var_read'(1, ValMethod),
 	'$sys_var_read'(2, Reorder),
@@ -94,7 +107,12 @@ fd_labeling(List, Options) :-
 	    '$indomain'(List, ValMethod)
 	;
 	    '$check_list'(List),
-	    '$fd_labeling1'(List, VarMethod, ValMethod, Reorder)
+	    (   Restart = none, Recomp > 1 ->
+	        '$fd_labeling_recomp'(List, VarMethod, ValMethod, Recomp)
+	    ;   Restart = none ->
+	        '$fd_labeling1'(List, VarMethod, ValMethod, Reorder)
+	    ;   '$fd_labeling_restart'(List, VarMethod, ValMethod, Reorder, Restart, 1)
+	    )
 	),
 	'$fd_get_labeling_backtracks'(Bckts).
 
@@ -117,15 +135,20 @@ fd_labeling(List, Options) :-
 '$set_labeling_defaults' :-
 	'$sys_var_write'(0, 0),
 	'$sys_var_write'(1, 0),
-	'$sys_var_write'(2, 1).
+	'$sys_var_write'(2, 1),
+	g_assign('$fd_restart', none),
+	g_assign('$fd_recomputation', 1).
 
 
 
 
 '$get_labeling_options'(Options, Bckts) :-
 	'$check_list'(Options),
+	current_bip_name(Name, Arity),	% the arithmetic tests change it
+	g_assign('$fd_labeling_bip', Name / Arity),
 	g_link('$backtracks', _),
 	'$get_labeling_options1'(Options),
+	set_bip_name(Name, Arity),
 	g_read('$backtracks', Bckts).
 
 
@@ -158,6 +181,12 @@ fd_labeling(List, Options) :-
 	    '$sys_var_write'(0, 5)
 	;   X = random,
 	    '$sys_var_write'(0, 6)
+	;   X = dom_wdeg,
+	    '$sys_var_write'(0, 7)
+	;   X = activity,
+	    '$sys_var_write'(0, 8)
+	;   X = impact,
+	    '$sys_var_write'(0, 9)
 	).
 
 '$get_labeling_options2'(value_method(X)) :-
@@ -184,10 +213,29 @@ fd_labeling(List, Options) :-
 	    '$sys_var_write'(2, 1)
 	).
 
+'$get_labeling_options2'(restart(X)) :-
+	'$check_nonvar'(X),
+	(   X = none
+	;   X = luby(Scale),
+	    integer(Scale), Scale > 0
+	;   X = geometric(Scale, Factor),
+	    integer(Scale), Scale > 0,
+	    number(Factor), Factor >= 1
+	), !,
+	g_assign('$fd_restart', X).
+
+'$get_labeling_options2'(recomputation(X)) :-
+	'$check_nonvar'(X),
+	integer(X),
+	X >= 1, !,
+	g_assign('$fd_recomputation', X).
+
 '$get_labeling_options2'(backtracks(Bckts)) :- % maybe check Bckts is var or integer ?
 	g_link('$backtracks', Bckts).
 
 '$get_labeling_options2'(X) :-
+	g_read('$fd_labeling_bip', Name / Arity),
+	set_bip_name(Name, Arity),
 	'$pl_err_domain'(fd_labeling_option, X).
 
 
@@ -197,6 +245,11 @@ fd_labeling(List, Options) :-
 	!,
 	'$fd_labeling_std'(List, ValMethod).
 
+'$fd_labeling1'(List, 9, ValMethod, Reorder) :-                    % impact
+	!,
+	'$fd_sel_array_from_list'(List, SelArray),
+	'$fd_labeling_impact'(SelArray, ValMethod, Reorder).
+
 '$fd_labeling1'(List, VarMethod, ValMethod, Reorder) :-
 	'$fd_sel_array_from_list'(List, SelArray),
 	'$fd_labeling_mth'(SelArray, VarMethod, ValMethod, Reorder).
@@ -206,6 +259,219 @@ fd_labeling(List, Options) :-
 
 
 
+% Labeling with restarts: the I-th run is limited to a number of backtracks
+% given by the restart strategy. When the limit is reached, the choices of
+% the run are recorded as nogoods (see Pl_Fd_Restart_End_0) and a new run
+% starts. A solution is never computed twice: when backtracking into a run
+% its limit applies again and its choices (including the solutions already
+% found) are recorded as nogoods at the next restart.
+
+'$fd_labeling_restart'(List, VarMethod, ValMethod, Reorder, Restart, I) :-
+	'$fd_restart_nb_fails'(Restart, I, Fails),
+	'$get_current_B'(B),
+	'$call_c'('Pl_Fd_Restart_Begin_2'(Fails, B)),
+	(   '$fd_labeling1'(List, VarMethod, ValMethod, Reorder),
+	    '$call_c_test'('Pl_Fd_Restart_Suspend_1'(Count)),
+	    (   true
+	    ;   '$call_c'('Pl_Fd_Restart_Resume_3'(Fails, B, Count)),
+	        fail
+	    )
+	;   '$call_c_test'('Pl_Fd_Restart_End_0'),
+	    I1 is I + 1,
+	    '$fd_labeling_restart'(List, VarMethod, ValMethod, Reorder, Restart, I1)
+	).
+
+
+
+
+'$fd_restart_nb_fails'(luby(Scale), I, Fails) :-
+	'$fd_luby'(I, L),
+	Fails is Scale * L.
+
+'$fd_restart_nb_fails'(geometric(Scale, Factor), I, Fails) :-
+	Fails is truncate(min(Scale * Factor ** (I - 1), 1.0e9)).
+
+
+
+
+% Luby sequence: 1 1 2 1 1 2 4 1 1 2 1 1 2 4 8 ...
+
+'$fd_luby'(I, L) :-
+	'$fd_luby_k'(I, 1, K),
+	P is 1 << K,
+	(   I =:= P - 1 ->
+	    L is P >> 1
+	;   I1 is I - (P >> 1) + 1,
+	    '$fd_luby'(I1, L)
+	).
+
+
+'$fd_luby_k'(I, K, K) :-
+	(1 << K) - 1 >= I, !.
+
+'$fd_luby_k'(I, K, K2) :-
+	K1 is K + 1,
+	'$fd_luby_k'(I, K1, K2).
+
+
+
+
+% Labeling with recomputation (option recomputation(K)): the search tree is
+% divided into blocks of K choices (a choice is X = V or X \= V, X =< V or
+% X > V for bisect) and only one choice point is kept per block. The next
+% leaf of a block is searched (inside findall/3, so that its domains are
+% then undone) from the top of the block, after the previous leaf, and is
+% returned as a path of decisions d(I, Kind, V, ValMethod) (I is the index
+% of the variable). The path is then replayed. Thus a variable modified by
+% several choices of a block is trailed (and its domain copied on the
+% constraint stack) only once per block, at the cost of recomputing the
+% propagation of the paths. As with the choice points of '$indomain'/2, a
+% refuted variable is labeled again before the next variable is selected.
+
+'$fd_labeling_recomp'(List, VarMethod, ValMethod, K) :-
+	'$fd_sel_array_from_list'(List, SelArray),
+	Vars =.. [vars|List],
+	'$fd_recomp_block'(none, none, Vars, SelArray, VarMethod, ValMethod, K).
+
+
+'$fd_recomp_block'(Prev, Last, Vars, SelArray, VarMethod, ValMethod, K) :-
+	(   Prev = none ->
+	    Mode = free
+	;   Mode = follow(Prev)
+	),
+	findall(Path, '$fd_recomp_leaf'(Mode, Last, Vars, SelArray, VarMethod,
+					ValMethod, K, Path), [Next]),
+	(   '$fd_recomp_replay'(Next, Vars),
+	    (   Next = [] ->                            % all variables are ground
+	        true
+	    ;   '$fd_recomp_last'(Next, Last1),
+	        '$fd_recomp_block'(none, Last1, Vars, SelArray, VarMethod,
+				   ValMethod, K)
+	    )
+	;   '$fd_recomp_block'(Next, Last, Vars, SelArray, VarMethod,
+			       ValMethod, K)
+	).
+
+
+
+
+'$fd_recomp_leaf'(Mode, Last, Vars, SelArray, VarMethod, ValMethod, K, Path) :-
+	'$fd_recomp_dfs'(Mode, Last, 0, Vars, SelArray, VarMethod, ValMethod,
+			 K, Path), !.
+
+
+
+
+	% follow(Prev): only the leaves after Prev (Prev excluded)
+
+'$fd_recomp_dfs'(follow([D|Prev]), _, Depth, Vars, SelArray, VarMethod,
+		 ValMethod, K, [D1|Path]) :-
+	Depth1 is Depth + 1,
+	(   D1 = D,
+	    '$fd_recomp_post'(D, Vars, 0),
+	    '$fd_recomp_dfs'(follow(Prev), D, Depth1, Vars, SelArray, VarMethod,
+			     ValMethod, K, Path)
+	;   '$fd_recomp_refute'(D, D1),
+	    '$fd_recomp_post'(D1, Vars, 1),
+	    '$fd_recomp_dfs'(free, D1, Depth1, Vars, SelArray, VarMethod,
+			     ValMethod, K, Path)
+	).
+
+'$fd_recomp_dfs'(free, Last, Depth, Vars, SelArray, VarMethod, ValMethod,
+		 K, Path) :-
+	(   Depth >= K ->
+	    Path = []
+	;   '$fd_recomp_select'(Last, Vars, SelArray, VarMethod, ValMethod, D) ->
+	    Path = [D1|Path1],
+	    Depth1 is Depth + 1,
+	    (   D1 = D,
+	        '$fd_recomp_post'(D, Vars, 0)
+	    ;   '$fd_recomp_refute'(D, D1),
+	        '$fd_recomp_post'(D1, Vars, 1)
+	    ),
+	    '$fd_recomp_dfs'(free, D1, Depth1, Vars, SelArray, VarMethod,
+			     ValMethod, K, Path1)
+	;   Path = []
+	).
+
+
+
+
+'$fd_recomp_select'(Last, Vars, SelArray, VarMethod, ValMethod, D) :-
+	(   Last = d(I, _, _, ValMethod1),
+	    arg(I, Vars, X),
+	    fd_var(X) ->
+	    true
+	;   VarMethod = 0 ->                            % standard
+	    '$fd_recomp_first_var'(1, Vars, X, I),
+	    ValMethod1 = ValMethod
+	;   '$fd_sel_array_pick_var'(SelArray, VarMethod, 0, X),
+	    '$fd_recomp_index'(1, Vars, X, I),
+	    ValMethod1 = ValMethod
+	),
+	'$call_c_test'('Pl_Fd_Decision_Select_4'(X, ValMethod1, Kind, V)),
+	D = d(I, Kind, V, ValMethod1).
+
+
+
+
+'$fd_recomp_first_var'(I, Vars, X, I1) :-
+	arg(I, Vars, Y),
+	(   fd_var(Y) ->
+	    X = Y,
+	    I1 = I
+	;   I2 is I + 1,
+	    '$fd_recomp_first_var'(I2, Vars, X, I1)
+	).
+
+
+'$fd_recomp_index'(I, Vars, X, I1) :-
+	arg(I, Vars, Y),
+	(   Y == X ->
+	    I1 = I
+	;   I2 is I + 1,
+	    '$fd_recomp_index'(I2, Vars, X, I1)
+	).
+
+
+
+
+	% see DECISION_xxx and METHOD_LIMITS_MIN/MAX in fd_values_c.c
+
+'$fd_recomp_refute'(d(I, 0, V, ValMethod), d(I, 1, V, ValMethod1)) :-
+	(   ValMethod = 5 ->
+	    ValMethod1 = 6
+	;   ValMethod = 6 ->
+	    ValMethod1 = 5
+	;   ValMethod1 = ValMethod
+	).
+
+'$fd_recomp_refute'(d(I, 2, V, ValMethod), d(I, 3, V, ValMethod)).
+
+
+
+
+'$fd_recomp_post'(d(I, Kind, V, _), Vars, Bckt) :-
+	arg(I, Vars, X),
+	'$call_c_test'('Pl_Fd_Decision_Post_4'(X, Kind, V, Bckt)).
+
+
+'$fd_recomp_replay'([], _).
+
+'$fd_recomp_replay'([D|Path], Vars) :-
+	'$fd_recomp_post'(D, Vars, 0),
+	'$fd_recomp_replay'(Path, Vars).
+
+
+'$fd_recomp_last'([D], D) :-
+	!.
+
+'$fd_recomp_last'([_|Path], D) :-
+	'$fd_recomp_last'(Path, D).
+
+
+
+
 '$fd_labeling_std'([], _).
 
 '$fd_labeling_std'([X|List], ValMethod) :-
@@ -225,6 +491,20 @@ fd_labeling(List, Options) :-
 
 
 
+	% like '$fd_labeling_mth'/4 but measures the impact of each choice
+
+'$fd_labeling_impact'(SelArray, ValMethod, Reorder) :-
+	'$fd_sel_array_pick_var'(SelArray, 9, Reorder, X), !,
+	'$call_c_test'('Pl_Fd_Impact_Before_4'(SelArray, X, Fdv, Space)),
+	'$indomain'(X, ValMethod),
+	'$call_c'('Pl_Fd_Impact_After_3'(SelArray, Fdv, Space)),
+	'$fd_labeling_impact'(SelArray, ValMethod, Reorder).
+
+'$fd_labeling_impact'(_, _, _).
+
+
+
+
 '$fd_sel_array_from_list'(List, SelArray) :-
 	'$call_c_test'('Pl_Fd_Sel_Array_From_List_2'(List, SelArray)).
 
@@ -246,3 +526,356 @@ fd_labeling(List, Options) :-
 
 '$extra_cstr_alt' :-                % used by C code to create a choice-point
 	'$call_c_test'('Pl_Extra_Cstr_Alt_0').
+
+
+
+
+% Parallel search (see fd_labeling_parallel/2 and fd_minimize_parallel/4).
+% The master splits the search tree on a prefix of the variables into (at
+% least) 4 paths per worker, a path being the list of the values of the
+% prefix, then forks the worker processes. Each worker asks the master for
+% a path, replays it (binds the prefix) and explores the subtree. Paths are
+% handed out on demand, so the remaining work goes to the idle workers.
+% The messages are terms sent through pipes:
+%
+%   worker -> master: next(Res)  asks for a path (Res: best solution found
+%                                in the previous subtree when optimizing)
+%                     sol(Vals)  a solution (then waits for more)
+%                     error(E)   an exception has been raised
+%   master -> worker: path(P, B) a path and the current bound (optimizing)
+%                     more       looks for the next solution
+%                     stop       terminates
+%
+% The state of the master is recorded in the global var '$fd_par' so that
+% the workers left by a cut are killed at the next parallel search.
+
+'$fd_par'(Mode, Vars, LabOptions, NbWorkers) :-
+	'$fd_par_kill_stale',
+	'$fd_par_val_options'(LabOptions, ValOptions),
+	N is NbWorkers * 4,
+	'$fd_par_split'(Vars, [], Mode, ValOptions, N, Prefix, Paths),
+	Paths \== [],
+	'$fd_par_pipes'(NbWorkers, Pipes),
+	flush_output(user_output),
+	flush_output(user_error),
+	'$fd_par_fork'(Pipes, Pipes, Mode, Prefix, Workers),
+	g_assign('$fd_par', par(Paths, Workers, none)),
+	'$fd_par_master'(Mode, Vars).
+
+
+
+
+'$fd_par_val_options'([], []).
+
+'$fd_par_val_options'([X|LabOptions], ValOptions) :-
+	(   X = value_method(_) ->
+	    ValOptions = [X|ValOptions1]
+	;   ValOptions = ValOptions1
+	),
+	'$fd_par_val_options'(LabOptions, ValOptions1).
+
+
+
+
+% the prefix grows until it gives enough paths (or no path at all)
+
+'$fd_par_split'([X|Vars], Prefix0, Mode, ValOptions, N, Prefix, Paths) :-
+	append(Prefix0, [X], Prefix1),
+	findall(Prefix1, ('$fd_par_bip_name'(Mode),
+			  '$fd_labeling'(Prefix1, ValOptions)), Paths1),
+	(   ( Vars = [] ; Paths1 = [] ; length(Paths1, L), L >= N ) ->
+	    Prefix = Prefix1,
+	    Paths = Paths1
+	;   '$fd_par_split'(Vars, Prefix1, Mode, ValOptions, N, Prefix, Paths)
+	).
+
+'$fd_par_split'([], [], _, _, _, [], [[]]).
+
+
+
+
+'$fd_par_pipes'(0, []) :-
+	!.
+
+'$fd_par_pipes'(I, [p(TIn, TOut, RIn, ROut)|Pipes]) :-
+	create_pipe(TIn, TOut),		% tasks:   master -> worker
+	create_pipe(RIn, ROut),		% results: worker -> master
+	I1 is I - 1,
+	'$fd_par_pipes'(I1, Pipes).
+
+
+
+
+'$fd_par_fork'([], _, _, _, []).
+
+'$fd_par_fork'([P|Pipes], AllPipes, Mode, Prefix, [w(Pid, TOut, RIn)|Workers]) :-
+	P = p(TIn, TOut, RIn, ROut),
+	fork_prolog(Pid),
+	(   Pid = 0 ->
+	    '$fd_par_close_pipes'(AllPipes, P),
+	    (   catch('$fd_par_worker'(Mode, Prefix, TIn, ROut), _, true) ->
+	        true
+	    ;   true
+	    ),
+	    halt
+	;   close(TIn),
+	    close(ROut),
+	    '$fd_par_fork'(Pipes, AllPipes, Mode, Prefix, Workers)
+	).
+
+
+
+
+% a worker only keeps its own ends of its pipes (so that it gets an end of
+% file if the master disappears)
+
+'$fd_par_close_pipes'([], _).
+
+'$fd_par_close_pipes'([P1|Pipes], P) :-
+	(   P1 == P ->
+	    P = p(_, TOut, RIn, _),
+	    Streams = [TOut, RIn]
+	;   P1 = p(TIn, TOut, RIn, ROut),
+	    Streams = [TIn, TOut, RIn, ROut]
+	),
+	'$fd_par_close_streams'(Streams),
+	'$fd_par_close_pipes'(Pipes, P).
+
+
+'$fd_par_close_streams'([]).
+
+'$fd_par_close_streams'([S|Streams]) :-
+	catch(close(S), _, true),	% already closed by the master
+	'$fd_par_close_streams'(Streams).
+
+
+
+
+'$fd_par_worker'(Mode, Prefix, In, Out) :-
+	g_assign('$fd_par', none),
+	'$fd_par_send'(Out, next(none)),
+	repeat,
+	read(In, Msg),
+	(   Msg = path(Path, Bound) ->
+	    catch('$fd_par_task'(Mode, Prefix, Path, Bound, In, Out, Res), Err,
+		  Res = error(Err)),
+	    (   Res = error(_) ->
+	        '$fd_par_send'(Out, Res)
+	    ;   '$fd_par_send'(Out, next(Res))
+	    ),
+	    fail
+	;   !			% stop or end of file
+	).
+
+
+
+
+'$fd_par_task'(label(Vars, LabOptions), Prefix, Path, _, In, Out, none) :-
+	set_bip_name(fd_labeling_parallel, 2),
+	(   Prefix = Path,
+	    '$fd_labeling'(Vars, LabOptions),
+	    '$fd_par_send'(Out, sol(Vars)),
+	    read(In, Reply),
+	    Reply \== more ->
+	    halt
+	;   true
+	).
+
+'$fd_par_task'(optim(Dir, Goal, Var, Vars, _, Name, Arity), Prefix, Path, Bound, _, _, Res) :-
+	'$fd_par_optim_task'(Dir, Goal, Var, Vars, Name, Arity, Prefix, Path, Bound, Res).
+
+
+
+
+'$fd_par_send'(Stream, Msg) :-
+	write_canonical(Stream, Msg),
+	write(Stream, ' .'),
+	nl(Stream),
+	flush_output(Stream).
+
+
+
+
+'$fd_par_master'(Mode, Vars) :-
+	repeat,
+	g_read('$fd_par', par(Paths, Workers, Inc)),
+	(   Workers = [] ->
+	    !,
+	    g_assign('$fd_par', none),
+	    '$fd_par_end'(Mode, Inc)
+	;   '$fd_par_receive'(Workers, W, Msg),
+	    '$fd_par_master1'(Msg, W, Paths, Workers, Inc, Mode, Vars)
+	).
+
+
+
+
+'$fd_par_receive'(Workers, W, Msg) :-
+	'$fd_par_result_streams'(Workers, Streams),
+	select(Streams, [In|_], [], _, 0),
+	W = w(_, _, In),
+	'$fd_par_member'(W, Workers), !,
+	read(In, Msg).
+
+
+'$fd_par_result_streams'([], []).
+
+'$fd_par_result_streams'([w(_, _, In)|Workers], [In|Streams]) :-
+	'$fd_par_result_streams'(Workers, Streams).
+
+
+'$fd_par_member'(X, [X|_]).
+
+'$fd_par_member'(X, [_|L]) :-
+	'$fd_par_member'(X, L).
+
+
+
+
+'$fd_par_master1'(sol(Vals), W, _, _, _, _, Vars) :-
+	(   Vars = Vals
+	;   W = w(_, TOut, _),
+	    '$fd_par_send'(TOut, more),
+	    fail
+	).
+
+'$fd_par_master1'(next(Res), W, Paths, Workers, Inc, Mode, _) :-
+	'$fd_par_incumbent'(Res, Inc, Mode, Inc1, Optimal),
+	W = w(Pid, TOut, RIn),
+	(   Paths = [Path|Paths1],
+	    Optimal = false ->
+	    '$fd_par_bound'(Inc1, Bound),
+	    '$fd_par_send'(TOut, path(Path, Bound)),
+	    g_assign('$fd_par', par(Paths1, Workers, Inc1))
+	;   '$fd_par_send'(TOut, stop),
+	    close(TOut),
+	    close(RIn),
+	    wait(Pid, _),
+	    '$fd_par_delete'(Workers, W, Workers1),
+	    g_assign('$fd_par', par([], Workers1, Inc1))
+	),
+	fail.
+
+'$fd_par_master1'(error(Err), _, _, Workers, _, _, _) :-
+	'$fd_par_kill'(Workers),
+	g_assign('$fd_par', none),
+	throw(Err).
+
+'$fd_par_master1'(end_of_file, _, _, Workers, _, Mode, _) :-
+	'$fd_par_kill'(Workers),
+	g_assign('$fd_par', none),
+	'$fd_par_bip_name'(Mode),
+	'$pl_err_system'(fd_parallel_worker_lost).
+
+
+
+
+'$fd_par_bip_name'(label(_, _)) :-
+	set_bip_name(fd_labeling_parallel, 2).
+
+'$fd_par_bip_name'(optim(_, _, _, _, _, Name, Arity)) :-
+	set_bip_name(Name, Arity).
+
+
+
+
+'$fd_par_delete'([], _, []).
+
+'$fd_par_delete'([W1|Workers], W, Workers1) :-
+	(   W1 == W ->
+	    Workers1 = Workers
+	;   Workers1 = [W1|Workers2],
+	    '$fd_par_delete'(Workers, W, Workers2)
+	).
+
+
+
+
+% the incumbent of an optimization (none in labeling mode), Optimal is true
+% if the best possible value is reached (then no more paths are handed out)
+
+'$fd_par_incumbent'(none, Inc, Mode, Inc, Optimal) :-
+	!,
+	'$fd_par_optimal'(Inc, Mode, Optimal).
+
+'$fd_par_incumbent'(Res, Inc, Mode, Inc1, Optimal) :-
+	Res = sol(_, C),
+	Mode = optim(Dir, _, _, _, _, _, _),
+	(   Inc = sol(_, C0),
+	    (   Dir = min ->
+	        C0 =< C
+	    ;   C0 >= C
+	    ) ->
+	    Inc1 = Inc
+	;   Inc1 = Res
+	),
+	'$fd_par_optimal'(Inc1, Mode, Optimal).
+
+
+'$fd_par_optimal'(sol(_, C), optim(_, _, _, _, Best, _, _), true) :-
+	C =:= Best, !.
+
+'$fd_par_optimal'(_, _, false).
+
+
+'$fd_par_bound'(none, none).
+
+'$fd_par_bound'(sol(_, C), C).
+
+
+
+
+'$fd_par_end'(label(_, _), _) :-
+	fail.
+
+'$fd_par_end'(optim(_, Goal, Var, Vars, _, Name, Arity), sol(Vals, C)) :-
+	Var = C,
+	Vars = Vals,
+	'$call'(Goal, Name, Arity, true), !.
+
+
+
+
+'$fd_par_kill_stale' :-
+	g_read('$fd_par', Par),
+	g_assign('$fd_par', none),
+	(   Par = par(_, Workers, _) ->
+	    '$fd_par_kill'(Workers)
+	;   true
+	).
+
+
+
+
+'$fd_par_kill'([]).
+
+'$fd_par_kill'([w(Pid, TOut, RIn)|Workers]) :-
+	catch(send_signal(Pid, 'SIGKILL'), _, true),
+	catch(wait(Pid, _), _, true),
+	'$fd_par_close_streams'([TOut, RIn]),
+	'$fd_par_kill'(Workers).
+
+
+
+
+'$get_parallel_options'(Options, NbWorkers, Others, Name, Arity) :-
+	'$check_list'(Options),
+	'$get_parallel_options1'(Options, 4, NbWorkers, Others, Name, Arity).
+
+
+'$get_parallel_options1'([], NbWorkers, NbWorkers, [], _, _).
+
+'$get_parallel_options1'([X|Options], NbWorkers0, NbWorkers, Others, Name, Arity) :-
+	(   nonvar(X),
+	    X = workers(N) ->
+	    (   integer(N),
+	        N >= 1 ->
+	        true
+	    ;   set_bip_name(Name, Arity),	% reset by arithmetic
+	        '$pl_err_domain'(fd_parallel_option, X)
+	    ),
+	    Others = Others1
+	;   N = NbWorkers0,
+	    Others = [X|Others1]
+	),
+	'$get_parallel_options1'(Options, N, NbWorkers, Others1, Name, Arity).
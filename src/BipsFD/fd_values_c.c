@@ -37,12 +37,14 @@
 
 
 #include <stdlib.h>
+#include <math.h>
 
 #include "engine_pl.h"
 #include "bips_pl.h"
 
 #include "engine_fd.h"
 #include "bips_fd.h"
+#include "fd_trace.h"
 
 
 
@@ -61,6 +63,15 @@
 #define METHOD_LIMITS_MIN          METHOD_LIMITS
 #define METHOD_LIMITS_MAX          (METHOD_LIMITS + 1)
 
+#define INDOMAIN_REFUTED           (1 << 8) /* flag in A(1): a value refuted */
+
+	  /* decisions of the labeling with recomputation (see fd_values.pl) */
+
+#define DECISION_EQ                0 /* X = V */
+#define DECISION_NEQ               1 /* X \= V */
+#define DECISION_LE                2 /* X =< V (bisect) */
+#define DECISION_GT                3 /* X > V (bisect) */
+
 
 
 #define METHOD_STANDARD            0
@@ -70,6 +81,19 @@
 #define METHOD_LARGEST             4
 #define METHOD_MAX_REGRET          5
 #define METHOD_RANDOM              6
+#define METHOD_DOM_WDEG            7
+#define METHOD_ACTIVITY            8
+#define METHOD_IMPACT              9
+
+
+
+#define ACTIVITY_DECAY             0.95 /* activities *= decay at each choice */
+#define ACTIVITY_RESCALE           1e20 /* max increment before rescaling */
+#define IMPACT_RATE                0.25 /* weight of a new observed impact */
+
+
+
+#define LIMIT_TIME_CHECK_MASK      63 /* check the time every 64 backtracks */
 
 
 
@@ -80,6 +104,8 @@
 
 typedef Bool (*CmpFct) (WamWord *last_fdv_adr, WamWord *new_fdv_adr);
 
+typedef double (*ScoreFct) (WamWord *fdv_adr);
+
 
 
 
@@ -87,10 +113,43 @@ typedef Bool (*CmpFct) (WamWord *last_fdv_adr, WamWord *new_fdv_adr);
  * Global Variables                *
  *---------------------------------*/
 
+static Bool limit_active;	/* search limits (see fd_minimize_lns/4) */
+static Bool limit_reached;
+static PlLong limit_bckts;	/* max nb of backtracks (0 = none) */
+static PlLong limit_time;	/* deadline (real time, 0 = none) */
+static PlLong limit_count;
+
+static Bool restart_active;	/* limit of the current run of a restart */
+static Bool restart_reached;	/* (independent of the above limits) */
+static PlLong restart_fails;
+static PlLong restart_count;
+
+static WamWord *nogood_base;	/* restarts: B at the start of the run */
+static PlLong *nogood_buff;	/* nogoods recorded when the limit is reached */
+static int nogood_size;
+static int nogood_top;
+
+
+
+
 /*---------------------------------*
  * Function Prototypes             *
  *---------------------------------*/
 
+static Bool Search_Limit_Reached(void);
+
+static void Record_Nogood(WamWord *fdv_adr, int value_method, PlLong value,
+			  Bool refuted);
+
+static void Nogood_Push(PlLong x);
+
+static void Nogood_Push_Interval(PlLong min, PlLong max, PlLong ex_min,
+				 PlLong ex_max, int *k);
+
+static Bool Post_Nogood(PlLong *ng);
+
+static PlLong Nogood_Propagate(WamWord *AF);
+
 static Bool Cmp_First_Fail(WamWord *last_fdv_adr, WamWord *new_fdv_adr);
 
 static Bool Cmp_Most_Constrained(WamWord *last_fdv_adr, WamWord *new_fdv_adr);
@@ -101,6 +160,19 @@ static Bool Cmp_Largest(WamWord *last_fdv_adr, WamWord *new_fdv_adr);
 
 static Bool Cmp_Max_Regret(WamWord *last_fdv_adr, WamWord *new_fdv_adr);
 
+static WamWord **Pick_Best_Score(WamWord **array, WamWord **end, ScoreFct score_meth,
+				 Bool reorder);
+
+static double Score_Dom_Wdeg(WamWord *fdv_adr);
+
+static double Score_Activity(WamWord *fdv_adr);
+
+static double Score_Impact(WamWord *fdv_adr);
+
+static void Decay_Activities(WamWord **array, WamWord **end);
+
+static double Search_Space(WamWord **array, WamWord **end);
+
 
 
 #define INDOMAIN_ALT               X1_24696E646F6D61696E5F616C74
@@ -182,7 +254,7 @@ Pl_Fd_Domain_2(WamWord list_word, WamWord r_word)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 Bool
-Pl_Fd_Domain_Interval(WamWord x_word, int min, int max)
+Pl_Fd_Domain_Interval(WamWord x_word, PlLong min, PlLong max)
 {
   WamWord word, tag_mask;
   WamWord *adr, *fdv_adr;
@@ -227,7 +299,7 @@ Pl_Fd_Domain_Interval(WamWord x_word, int min, int max)
 Bool
 Pl_Fd_Domain_Var_3(WamWord x_word, WamWord l_word, WamWord u_word)
 {
-  int min, max;
+  PlLong min, max;
 
   min = Pl_Fd_Prolog_To_Value(l_word);
   if (min < 0)
@@ -250,7 +322,7 @@ Pl_Fd_Domain_3(WamWord list_word, WamWord l_word, WamWord u_word)
   WamWord word, tag_mask;
   WamWord save_list_word;
   WamWord *lst_adr;
-  int min, max;
+  PlLong min, max;
 
   min = Pl_Fd_Prolog_To_Value(l_word);
   if (min < 0)
@@ -292,10 +364,10 @@ Pl_Fd_Domain_3(WamWord list_word, WamWord l_word, WamWord u_word)
  * SELECT_VALUE                                                            *
  *                                                                         *
  *-------------------------------------------------------------------------*/
-static int
+static PlLong
 Select_Value(WamWord *fdv_adr, int value_method)
 {
-  int n;
+  PlLong n;
   switch(value_method)
     {
     case METHOD_MIN:
@@ -308,12 +380,12 @@ Select_Value(WamWord *fdv_adr, int value_method)
 
     case METHOD_BISECT:
     case METHOD_MIDDLE:
-      n = (int) Nb_Elem(fdv_adr) / 2;		   /* here nb_elem > 1 => n >= 1 */
+      n = Nb_Elem(fdv_adr) / 2;		   /* here nb_elem > 1 => n >= 1 */
       return Pl_Range_Ith_Elem(Range(fdv_adr), n); /* Ith is in 1..nb_elem */
 
     case METHOD_RANDOM_V:
-      n = (int) Nb_Elem(fdv_adr);
-      n = (int) Pl_M_Random_Integer(n);		       /* random returns in 0..nb_elem-1 */
+      n = Nb_Elem(fdv_adr);
+      n = Pl_M_Random_Integer(n);		       /* random returns in 0..nb_elem-1 */
       return Pl_Range_Ith_Elem(Range(fdv_adr), n + 1); /* Ith is in 1..nb_elem */
     }
 
@@ -333,7 +405,7 @@ Pl_Indomain_2(WamWord x_word, WamWord method_word)
   WamWord word, tag_mask;
   WamWord *fdv_adr;
   int value_method;
-  int value;
+  PlLong value;
 
   value_method = Pl_Rd_C_Int(method_word);
 
@@ -345,13 +417,17 @@ Pl_Indomain_2(WamWord x_word, WamWord method_word)
   if (tag_mask == TAG_INT_MASK)
     return TRUE;
 
+  if (limit_reached || restart_reached)
+    return FALSE;
+
   value = Select_Value(fdv_adr, value_method);
   
   A(0) = (WamWord) fdv_adr | Extra_Cstr(fdv_adr);
   A(1) = value_method;
   A(2) = value;
+  A(3) = Min(fdv_adr);		/* for the nogoods (X in A(3)..A(2) for bisect) */
 
-  Pl_Create_Choice_Point((CodePtr) Prolog_Predicate(INDOMAIN_ALT, 0), 3);
+  Pl_Create_Choice_Point((CodePtr) Prolog_Predicate(INDOMAIN_ALT, 0), 4);
 
   if (value_method == METHOD_BISECT)
     {
@@ -379,17 +455,34 @@ Pl_Indomain_Alt_0(void)
   WamWord *fdv_adr;
   int extra_cstr;
   int value_method;
-  int value;
+  PlLong value;
+  Bool first;
 
 
-  Pl_Delete_Choice_Point(3);
+  Pl_Delete_Choice_Point(4);
 
   SYS_VAR_FD_BCKTS++;
 
   fdv_adr = (WamWord *) (A(0) & ~1);
   extra_cstr = A(0) & 1;
   value_method = (int) A(1);
-  value = (int) A(2);
+  value = A(2);
+
+  pl_fd_nb_bckt++;
+  Fd_Trace(FD_TRACE_BCKT, FD_CSTR_TYPE_OTHER, fdv_adr, value);
+
+  if (limit_active || restart_active)
+    {
+      first = !restart_reached;
+      if (Search_Limit_Reached())
+	{
+	  if (nogood_base != NULL && !limit_reached)
+	    Record_Nogood(fdv_adr, value_method, value, first);
+	  return FALSE;
+	}
+    }
+
+  value_method &= ~INDOMAIN_REFUTED;
 
   if (value_method == METHOD_LIMITS_MIN)
     value_method = METHOD_LIMITS_MAX;
@@ -403,6 +496,12 @@ Pl_Indomain_Alt_0(void)
       if (!Pl_Fd_In_Interval(fdv_adr, value + 1, INTERVAL_MAX_INTEGER))
 	return FALSE;
 
+      if (nogood_base != NULL && Tag_Mask_Of(*fdv_adr) == TAG_INT_MASK)
+	{
+	  value_method = METHOD_MIN;
+	  goto forced;
+	}
+
       /* simple and enough (like in Prolog) */
       return Pl_Indomain_2(*fdv_adr, Tag_INT(value_method));
     }
@@ -422,18 +521,30 @@ Pl_Indomain_Alt_0(void)
 	{
 	  /* A(0) = fdv_adr; */
 	  Pl_Create_Choice_Point((CodePtr) Prolog_Predicate(EXTRA_CSTR_ALT, 0), 1);
+	  return TRUE;
 	}
-      return TRUE;
-    }
 
-  value = Select_Value(fdv_adr, value_method);
+      /* when recording nogoods, the value forced by the refutations is
+       * also a choice point (a premise of the nogoods of the next ones) */
+      if (nogood_base == NULL)
+	return TRUE;
+
+    forced:
+      value = Min(fdv_adr);
+    }
+  else
+    value = Select_Value(fdv_adr, value_method);
 
 
   /*  A(0) = (WamWord) fdv_adr | Extra_Cstr(fdv_adr); */
-  A(1) = value_method;		/* can change for METHOD_LIMITS */
+  A(1) = value_method | INDOMAIN_REFUTED; /* can change for METHOD_LIMITS */
   A(2) = value;
+  A(3) = Min(fdv_adr);
+
+  Pl_Create_Choice_Point((CodePtr) Prolog_Predicate(INDOMAIN_ALT, 0), 4);
 
-  Pl_Create_Choice_Point((CodePtr) Prolog_Predicate(INDOMAIN_ALT, 0), 3);
+  if (Tag_Mask_Of(*fdv_adr) == TAG_INT_MASK) /* forced */
+    return TRUE;
 
   return Pl_Fd_Assign_Value_Fast(fdv_adr, value);
 }
@@ -441,6 +552,506 @@ Pl_Indomain_Alt_0(void)
 
 
 
+/*-------------------------------------------------------------------------*
+ * PL_FD_DECISION_SELECT_4                                                 *
+ *                                                                         *
+ * Labeling with recomputation: the first decision on the var X with the   *
+ * value method (X = V or X =< V for bisect) without any choice point.     *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Decision_Select_4(WamWord x_word, WamWord method_word,
+			WamWord kind_word, WamWord value_word)
+{
+  WamWord word, tag_mask;
+  WamWord *fdv_adr;
+  int value_method;
+
+  value_method = Pl_Rd_C_Int(method_word);
+
+  Fd_Deref_Check_Fd_Var(x_word, word, tag_mask);
+  if (tag_mask == TAG_INT_MASK)
+    return FALSE;
+
+  fdv_adr = UnTag_FDV(word);
+
+  return Pl_Un_Integer((value_method == METHOD_BISECT) ? DECISION_LE : DECISION_EQ,
+		       kind_word) &&
+    Pl_Un_Integer(Select_Value(fdv_adr, value_method), value_word);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_DECISION_POST_4                                                   *
+ *                                                                         *
+ * Labeling with recomputation: posts a decision. bckt_word is 1 when a    *
+ * refutation (X \= V or X > V) is a new backtrack (not a replay) to count *
+ * it like Pl_Indomain_Alt_0 and to check the search limits.               *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Decision_Post_4(WamWord x_word, WamWord kind_word, WamWord value_word,
+		      WamWord bckt_word)
+{
+  WamWord word, tag_mask;
+  WamWord *fdv_adr;
+  int kind;
+  PlLong value;
+
+  kind = Pl_Rd_C_Int(kind_word);
+  value = Pl_Rd_Integer(value_word);
+
+  Fd_Deref_Check_Fd_Var(x_word, word, tag_mask);
+
+  if (Pl_Rd_C_Int(bckt_word))
+    {
+      SYS_VAR_FD_BCKTS++;
+      pl_fd_nb_bckt++;
+      if (tag_mask == TAG_FDV_MASK)
+	Fd_Trace(FD_TRACE_BCKT, FD_CSTR_TYPE_OTHER, UnTag_FDV(word), value);
+
+      if ((limit_active || restart_active) && Search_Limit_Reached())
+	return FALSE;
+    }
+  else if (limit_reached || restart_reached)
+    return FALSE;
+
+  if (tag_mask == TAG_INT_MASK)
+    {
+      switch (kind)
+	{
+	case DECISION_EQ:
+	  return UnTag_INT(word) == value;
+	case DECISION_NEQ:
+	  return UnTag_INT(word) != value;
+	case DECISION_LE:
+	  return UnTag_INT(word) <= value;
+	default:
+	  return UnTag_INT(word) > value;
+	}
+    }
+
+  fdv_adr = UnTag_FDV(word);
+
+  switch (kind)
+    {
+    case DECISION_EQ:		/* a replayed value may no longer be possible */
+      return Pl_Fd_Unify_With_Integer0(fdv_adr, value);
+    case DECISION_NEQ:
+      return Pl_Fd_Remove_Value(fdv_adr, value);
+    case DECISION_LE:
+      return Pl_Fd_In_Interval(fdv_adr, 0, value);
+    default:
+      return Pl_Fd_In_Interval(fdv_adr, value + 1, INTERVAL_MAX_INTEGER);
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_SET_SEARCH_LIMIT_2                                                *
+ *                                                                         *
+ * Limits the labeling to a number of backtracks and/or a time (in ms) (0  *
+ * for no limit). Once a limit is reached all labeling choices fail, so    *
+ * the search is quickly exhausted. Pl_Fd_Set_Search_Limit_2(0, 0) removes *
+ * the limits.                                                             *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Set_Search_Limit_2(WamWord bckts_word, WamWord time_word)
+{
+  PlLong time = Pl_Rd_Integer_Check(time_word);
+
+  limit_bckts = Pl_Rd_Integer_Check(bckts_word);
+  limit_time = (time > 0) ? Pl_M_Real_Time() + time : 0;
+  limit_count = 0;
+  limit_reached = FALSE;
+  limit_active = (limit_bckts > 0 || limit_time > 0);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_SEARCH_LIMIT_REACHED_0                                            *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Search_Limit_Reached_0(void)
+{
+  return limit_reached;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SEARCH_LIMIT_REACHED                                                    *
+ *                                                                         *
+ * Called at each backtrack when a limit is active: the search limits      *
+ * (fd_minimize_lns/4) and/or the limit of the current run of a restart.   *
+ *-------------------------------------------------------------------------*/
+static Bool
+Search_Limit_Reached(void)
+{
+  if (limit_active && !limit_reached)
+    {
+      limit_count++;
+      if (limit_bckts > 0 && limit_count >= limit_bckts)
+	limit_reached = TRUE;
+      else if (limit_time > 0 && (limit_count & LIMIT_TIME_CHECK_MASK) == 0 &&
+	       Pl_M_Real_Time() >= limit_time)
+	limit_reached = TRUE;
+    }
+
+  if (restart_active && !restart_reached &&
+      ++restart_count >= restart_fails)
+    restart_reached = TRUE;
+
+  return limit_reached || restart_reached;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_RESTART_BEGIN_2                                                   *
+ *                                                                         *
+ * Starts a run of a labeling with restarts (see '$fd_labeling_restart'/6) *
+ * limited to nb_fails backtracks. b_word is the choice point before the   *
+ * run. When the limit is reached, the choices of the run (i.e. the        *
+ * indomain choice points above b_word) are recorded as nogoods while the  *
+ * failure goes back to b_word (see Pl_Indomain_Alt_0).                    *
+ * This limit is independent of the search limits which thus still apply   *
+ * (e.g. a labeling with restarts inside fd_minimize_lns/4).               *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Restart_Begin_2(WamWord nb_fails_word, WamWord b_word)
+{
+  WamWord word, tag_mask;
+
+  restart_fails = Pl_Rd_Integer_Check(nb_fails_word);
+  restart_count = 0;
+  restart_reached = FALSE;
+  restart_active = TRUE;
+
+  DEREF(b_word, word, tag_mask);
+  nogood_base = From_WamWord_To_B(word);
+  nogood_top = 0;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_RESTART_SUSPEND_1                                                 *
+ *                                                                         *
+ * Called when the run succeeds: the limit is removed (it would apply to   *
+ * the continuation), count_word is unified with the current count.        *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Restart_Suspend_1(WamWord count_word)
+{
+  PlLong count = restart_count;
+
+  restart_active = FALSE;
+  nogood_base = NULL;
+
+  return Pl_Get_Integer(count, count_word);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_RESTART_RESUME_3                                                  *
+ *                                                                         *
+ * Called when backtracking into the run to get the next solution.         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Restart_Resume_3(WamWord nb_fails_word, WamWord b_word, WamWord count_word)
+{
+  Pl_Fd_Restart_Begin_2(nb_fails_word, b_word);
+  restart_count = Pl_Rd_Integer_Check(count_word);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_RESTART_END_0                                                     *
+ *                                                                         *
+ * Called when the run fails. If the limit of the run has not been reached *
+ * the search space is exhausted, if a search limit has been reached the   *
+ * search is stopped (fails in both cases). Else posts the recorded        *
+ * nogoods (they are kept by the next runs).                               *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Restart_End_0(void)
+{
+  PlLong *ng;
+  Bool reached = restart_reached;
+
+  restart_active = restart_reached = FALSE;
+  nogood_base = NULL;
+
+  if (!reached || limit_reached)
+    return FALSE;
+
+  for (ng = nogood_buff; ng < nogood_buff + nogood_top; ng += 3 * ng[0] + 3 + 2 * ng[3 * ng[0] + 2])
+    if (!Post_Nogood(ng))
+      return FALSE;
+
+  nogood_top = 0;
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * RECORD_NOGOOD                                                           *
+ *                                                                         *
+ * Called on a choice point of the run when the limit is reached (refuted  *
+ * is TRUE for the first one: the choice on value has been fully explored) *
+ * and the state is back to the one of the choice point. The decisions of  *
+ * the older choice points (X = V, or X =< V for bisect) imply that the    *
+ * variable of this choice point remains in its current domain (minus the  *
+ * refuted choice). This is useless (already ensured by the propagation)   *
+ * if no value of this choice point has been refuted.                      *
+ *                                                                         *
+ * A nogood is recorded as: N, N x (fdv_adr, min, max), fdv_adr, K,        *
+ * K x (min, max) (the domain as a list of intervals).                     *
+ *-------------------------------------------------------------------------*/
+static void
+Record_Nogood(WamWord *fdv_adr, int value_method, PlLong value, Bool refuted)
+{
+  WamWord *b;
+  Range *range;
+  PlLong *il;
+  int method;
+  int n, k, i;
+  PlLong v;
+  PlLong ex_min, ex_max;
+  int save_top = nogood_top;
+
+  if (!refuted && !(value_method & INDOMAIN_REFUTED) &&
+      (value_method & ~INDOMAIN_REFUTED) != METHOD_BISECT)
+    return;
+
+  value_method &= ~INDOMAIN_REFUTED;
+
+  Nogood_Push(0);
+  for (b = B, n = 0; b > nogood_base; b = BB(b))
+    if (ALTB(b) == (CodePtr) Prolog_Predicate(INDOMAIN_ALT, 0))
+      {
+	method = (int) AB(b, 1) & ~INDOMAIN_REFUTED;
+	Nogood_Push(AB(b, 0) & ~1);
+	Nogood_Push((method == METHOD_BISECT) ? AB(b, 3) : AB(b, 2));
+	Nogood_Push(AB(b, 2));
+	n++;
+      }
+  nogood_buff[save_top] = n;
+
+  Nogood_Push((PlLong) fdv_adr);
+  Nogood_Push(0);		/* K (see below) */
+  k = 0;
+
+  if (!refuted)			/* nothing to exclude */
+    ex_min = 1, ex_max = 0;
+  else if (value_method == METHOD_BISECT)
+    ex_min = 0, ex_max = value;
+  else
+    ex_min = ex_max = value;
+
+  range = Range(fdv_adr);
+  if (Is_Interval(range))
+    Nogood_Push_Interval(range->min, range->max, ex_min, ex_max, &k);
+  else if (Is_IList(range))
+    {
+      il = IList_Of(range);
+      for (i = 0; i < IList_Nb_Interv(il); i++)
+	Nogood_Push_Interval(IList_Min(il, i), IList_Max(il, i), ex_min, ex_max, &k);
+    }
+  else
+    for (v = range->min; v >= 0; v = Pl_Range_Next_After(range, v))
+      Nogood_Push_Interval(v, v, ex_min, ex_max, &k);
+
+  nogood_buff[save_top + 3 * n + 2] = k;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * NOGOOD_PUSH                                                             *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Nogood_Push(PlLong x)
+{
+  if (nogood_top == nogood_size)
+    {
+      nogood_size = (nogood_size == 0) ? 1024 : 2 * nogood_size;
+      nogood_buff = (PlLong *) Realloc(nogood_buff, nogood_size * sizeof(PlLong));
+    }
+
+  nogood_buff[nogood_top++] = x;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * NOGOOD_PUSH_INTERVAL                                                    *
+ *                                                                         *
+ * Pushes min..max minus ex_min..ex_max (merged with the last interval if  *
+ * contiguous). k is the number of intervals.                              *
+ *-------------------------------------------------------------------------*/
+static void
+Nogood_Push_Interval(PlLong min, PlLong max, PlLong ex_min, PlLong ex_max,
+		     int *k)
+{
+  if (ex_min <= ex_max && ex_min <= max && ex_max >= min)
+    {
+      if (min < ex_min)
+	Nogood_Push_Interval(min, ex_min - 1, 1, 0, k);
+      if (ex_max < max)
+	Nogood_Push_Interval(ex_max + 1, max, 1, 0, k);
+      return;
+    }
+
+  if (*k > 0 && nogood_buff[nogood_top - 1] == min - 1)
+    {
+      nogood_buff[nogood_top - 1] = max;
+      return;
+    }
+
+  Nogood_Push(min);
+  Nogood_Push(max);
+  (*k)++;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * POST_NOGOOD                                                             *
+ *                                                                         *
+ * AF: N, N x (fdv_adr, min, max), fdv_adr, range                          *
+ *-------------------------------------------------------------------------*/
+static Bool
+Post_Nogood(PlLong *ng)
+{
+  int n = (int) ng[0];
+  int k = (int) ng[3 * n + 2];
+  PlLong *interv = ng + 3 * n + 3;
+  WamWord *AF, *CF;
+  Range *range, r;
+  int i;
+
+  AF = CS;
+  CS += 3 * n + 2 + sizeof(Range) / sizeof(WamWord);
+
+  for (i = 0; i <= 3 * n + 1; i++)
+    AF[i] = (WamWord) ng[i];
+
+  range = (Range *) (AF + 3 * n + 2);
+  range->extra_cstr = FALSE;
+  range->vec = NULL;
+  range->min = 0;
+  Set_To_Empty(range);
+  for (i = 0; i < k; i++)
+    {
+      Range_Init_Interval(&r, interv[2 * i], interv[2 * i + 1]);
+      if (i == 0)
+	*range = r;
+      else
+	Pl_Range_Union(range, &r);
+    }
+
+  Fd_Cstr_Type(fd_nogood);
+  Pl_Fd_Before_Add_Cstr();
+
+  CF = Pl_Fd_Create_C_Frame(Nogood_Propagate, AF, NULL, FALSE, FD_PRIO_CHEAP);
+  for (i = 0; i < n; i++)
+    Pl_Fd_Add_Dependency((WamWord *) AF[1 + 3 * i], CHAIN_NB_DOM, CF);
+  Pl_Fd_Add_Dependency((WamWord *) AF[3 * n + 1], CHAIN_NB_DOM, CF);
+
+  return Pl_Fd_After_Add_Cstr(Nogood_Propagate(AF));
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * NOGOOD_PROPAGATE                                                        *
+ *                                                                         *
+ * If all the premises X in Min..Max hold, the variable must be in the     *
+ * range. If all premises but one hold and the variable is not in the      *
+ * range, the remaining premise must be false.                             *
+ *-------------------------------------------------------------------------*/
+static PlLong
+Nogood_Propagate(WamWord *AF)
+{
+  int n = (int) AF[0];
+  WamWord *fdv_adr, *x_adr = (WamWord *) AF[3 * n + 1];
+  Range *range = (Range *) (AF + 3 * n + 2);
+  Range r;
+  WamWord *save_CS;
+  WamWord *p, *unknown = NULL;
+  PlLong min, max;
+  int i;
+
+  for (i = 0, p = AF + 1; i < n; i++, p += 3)
+    {
+      fdv_adr = (WamWord *) p[0];
+      min = p[1];
+      max = p[2];
+
+      if (Max(fdv_adr) < min || Min(fdv_adr) > max ||
+	  (min == max && !Pl_Range_Test_Value(Range(fdv_adr), min)))
+	return TRUE;		/* a premise is false */
+
+      if (Min(fdv_adr) < min || Max(fdv_adr) > max)
+	{
+	  if (unknown != NULL)	/* 2 unknown premises */
+	    return TRUE;
+	  unknown = p;
+	}
+    }
+
+  if (unknown == NULL)		/* the tell modifies its range: use a copy */
+    {
+      save_CS = CS;		/* like fd_allocate/fd_deallocate */
+      r.vec = NULL;
+      Pl_Range_Copy(&r, range);
+      CS = save_CS;
+      return Pl_Fd_Tell_Range(x_adr, &r);
+    }
+
+  fdv_adr = (WamWord *) unknown[0];
+  if (fdv_adr == x_adr || !Pl_Range_Test_Null_Inter(Range(x_adr), range))
+    return TRUE;
+
+  min = unknown[1];
+  max = unknown[2];
+
+  if (min == max)
+    return Pl_Fd_Tell_Not_Value(fdv_adr, min);
+
+  if (min <= Min(fdv_adr))
+    return Pl_Fd_Tell_Interval(fdv_adr, max + 1, Max(fdv_adr));
+
+  if (max >= Max(fdv_adr))
+    return Pl_Fd_Tell_Interval(fdv_adr, Min(fdv_adr), min - 1);
+
+  return TRUE;
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * PL_EXTRA_CSTR_ALT_0                                                     *
  *                                                                         *
@@ -585,6 +1196,19 @@ Pl_Fd_Sel_Array_Pick_Var_4(WamWord sel_array_word, WamWord method_word,
       cmp_meth = Cmp_Max_Regret;
       break;
 
+    case METHOD_DOM_WDEG:
+      res_elem = Pick_Best_Score(array, end, Score_Dom_Wdeg, reorder);
+      goto picked;
+
+    case METHOD_ACTIVITY:
+      res_elem = Pick_Best_Score(array, end, Score_Activity, reorder);
+      Decay_Activities(array, end);
+      goto picked;
+
+    case METHOD_IMPACT:
+      res_elem = Pick_Best_Score(array, end, Score_Impact, reorder);
+      goto picked;
+
     case METHOD_RANDOM:
       for (;;)
 	{
@@ -654,6 +1278,10 @@ Pl_Fd_Sel_Array_Pick_Var_4(WamWord sel_array_word, WamWord method_word,
     }
 #endif
 
+picked:
+  if (res_elem == NULL)
+    return FALSE;
+
   fdv_adr = *res_elem;
 
 finish:
@@ -663,6 +1291,61 @@ finish:
 
 
 
+/*-------------------------------------------------------------------------*
+ * PL_FD_IMPACT_BEFORE_4                                                   *
+ *                                                                         *
+ * Called before trying the values of the picked variable fdv_word (see    *
+ * '$fd_labeling_impact'/3): returns the variable as an offset in the      *
+ * constraint stack (it is bound after the choice) and the search space.   *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Impact_Before_4(WamWord sel_array_word, WamWord fdv_word,
+		      WamWord fdv_off_word, WamWord space_word)
+{
+  WamWord word, tag_mask;
+  WamWord **array;
+
+  array = (WamWord **) (Cstr_Stack + Pl_Rd_Integer_Check(sel_array_word));
+
+  DEREF(fdv_word, word, tag_mask);
+  if (tag_mask != TAG_FDV_MASK)
+    return FALSE;
+
+  return Pl_Get_Integer(Cstr_Offset(UnTag_FDV(word)), fdv_off_word) &&
+    Pl_Get_Float(Search_Space(array + 1, array + 1 + (PlLong) array[0]), space_word);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_IMPACT_AFTER_3                                                    *
+ *                                                                         *
+ * Called after a choice on the variable succeeded: the impact of the      *
+ * choice is the ratio of the search space it removed.                     *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Impact_After_3(WamWord sel_array_word, WamWord fdv_off_word,
+		     WamWord space_word)
+{
+  WamWord **array;
+  WamWord *fdv_adr;
+  double impact;
+
+  array = (WamWord **) (Cstr_Stack + Pl_Rd_Integer_Check(sel_array_word));
+  fdv_adr = Cstr_Stack + Pl_Rd_Integer_Check(fdv_off_word);
+
+  impact = 1.0 - exp(Search_Space(array + 1, array + 1 + (PlLong) array[0]) -
+		     Pl_Rd_Float(space_word));
+  if (impact < 0)
+    impact = 0;
+
+  Fdv_Impact(fdv_adr) += (impact - Fdv_Impact(fdv_adr)) * IMPACT_RATE;
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * CMP_FIRST_FAIL                                                          *
  *                                                                         *
@@ -683,8 +1366,8 @@ Cmp_First_Fail(WamWord *last_fdv_adr, WamWord *new_fdv_adr)
 static Bool
 Cmp_Most_Constrained(WamWord *last_fdv_adr, WamWord *new_fdv_adr)
 {
-  int l_nb = (int) Nb_Elem(last_fdv_adr);
-  int n_nb = (int) Nb_Elem(new_fdv_adr);
+  PlLong l_nb = Nb_Elem(last_fdv_adr);
+  PlLong n_nb = Nb_Elem(new_fdv_adr);
 
   return n_nb < l_nb ||
     (n_nb == l_nb && Nb_Cstr(new_fdv_adr) > Nb_Cstr(last_fdv_adr));
@@ -700,8 +1383,8 @@ Cmp_Most_Constrained(WamWord *last_fdv_adr, WamWord *new_fdv_adr)
 static Bool
 Cmp_Smallest(WamWord *last_fdv_adr, WamWord *new_fdv_adr)
 {
-  int l_min = Min(last_fdv_adr);
-  int n_min = Min(new_fdv_adr);
+  PlLong l_min = Min(last_fdv_adr);
+  PlLong n_min = Min(new_fdv_adr);
 
   return n_min < l_min ||
     (n_min == l_min && Nb_Cstr(new_fdv_adr) > Nb_Cstr(last_fdv_adr));
@@ -717,8 +1400,8 @@ Cmp_Smallest(WamWord *last_fdv_adr, WamWord *new_fdv_adr)
 static Bool
 Cmp_Largest(WamWord *last_fdv_adr, WamWord *new_fdv_adr)
 {
-  int l_max = Max(last_fdv_adr);
-  int n_max = Max(new_fdv_adr);
+  PlLong l_max = Max(last_fdv_adr);
+  PlLong n_max = Max(new_fdv_adr);
 
   return n_max > l_max ||
     (n_max == l_max && Nb_Cstr(new_fdv_adr) > Nb_Cstr(last_fdv_adr));
@@ -734,9 +1417,9 @@ Cmp_Largest(WamWord *last_fdv_adr, WamWord *new_fdv_adr)
 static Bool
 Cmp_Max_Regret(WamWord *last_fdv_adr, WamWord *new_fdv_adr)
 {
-  int l_diff;
-  int n_diff;
-  int min;
+  PlLong l_diff;
+  PlLong n_diff;
+  PlLong min;
 
   min = Min(last_fdv_adr);
   l_diff = Pl_Range_Next_After(Range(last_fdv_adr), min) - min;
@@ -747,3 +1430,147 @@ Cmp_Max_Regret(WamWord *last_fdv_adr, WamWord *new_fdv_adr)
   return n_diff > l_diff ||
     (n_diff == l_diff && Nb_Cstr(new_fdv_adr) > Nb_Cstr(last_fdv_adr));
 }
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PICK_BEST_SCORE                                                         *
+ *                                                                         *
+ * Returns the non-ground variable with the greatest score (ties: smallest *
+ * domain), NULL if all variables are ground.                              *
+ *-------------------------------------------------------------------------*/
+static WamWord **
+Pick_Best_Score(WamWord **array, WamWord **end, ScoreFct score_meth, Bool reorder)
+{
+  WamWord **p;
+  WamWord **res_elem = NULL;
+  WamWord *fdv_adr;
+  double score, res_score = 0;
+
+  for (p = array; p < end; p++)
+    {
+      fdv_adr = *p;
+
+      if (Fd_Variable_Is_Ground(fdv_adr))
+	continue;
+
+      score = (*score_meth) (fdv_adr);
+      if (res_elem == NULL)
+	{
+	  res_elem = p;
+	  res_score = score;
+	}
+      else if (score > res_score ||
+	       (score == res_score && Nb_Elem(fdv_adr) < Nb_Elem(*res_elem)))
+	{
+	  if (reorder)
+	    {
+	      *p = *res_elem;
+	      *res_elem = fdv_adr;
+	    }
+	  else
+	    res_elem = p;
+	  res_score = score;
+	}
+    }
+
+  return res_elem;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SCORE_DOM_WDEG                                                          *
+ *                                                                         *
+ * domain size / weighted degree. The weighted degree of X is the sum of   *
+ * the weights (failure counts) of the constraints woken by X.             *
+ *-------------------------------------------------------------------------*/
+static double
+Score_Dom_Wdeg(WamWord *fdv_adr)
+{
+  WamWord **chain_adr = &Chain_Min(fdv_adr);
+  WamWord *record_adr;
+  PlULong wdeg = 0;
+  int i;
+
+  for (i = CHAIN_NB_MIN; i <= CHAIN_NB_VAL; i++, chain_adr++)
+    for (record_adr = *chain_adr; record_adr; record_adr = Next_Chain(record_adr))
+      wdeg += Cstr_Weight(CF_Pointer(record_adr));
+
+  return (double) wdeg / (double) Nb_Elem(fdv_adr);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SCORE_ACTIVITY                                                          *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static double
+Score_Activity(WamWord *fdv_adr)
+{
+  return Fdv_Activity(fdv_adr) / (double) Nb_Elem(fdv_adr);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SCORE_IMPACT                                                            *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static double
+Score_Impact(WamWord *fdv_adr)
+{
+  return Fdv_Impact(fdv_adr) / (double) Nb_Elem(fdv_adr);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * DECAY_ACTIVITIES                                                        *
+ *                                                                         *
+ * Instead of multiplying all activities by ACTIVITY_DECAY, the increment  *
+ * applied by the solver at each reduction is divided by ACTIVITY_DECAY.   *
+ * When it becomes too large, the activities of the variables of the array *
+ * and the increment are scaled down (the other variables are not).        *
+ *-------------------------------------------------------------------------*/
+static void
+Decay_Activities(WamWord **array, WamWord **end)
+{
+  WamWord **p;
+
+  pl_fd_activity_inc /= ACTIVITY_DECAY;
+  if (pl_fd_activity_inc < ACTIVITY_RESCALE)
+    return;
+
+  for (p = array; p < end; p++)
+    Fdv_Activity(*p) /= ACTIVITY_RESCALE;
+
+  pl_fd_activity_inc /= ACTIVITY_RESCALE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SEARCH_SPACE                                                            *
+ *                                                                         *
+ * Returns the log of the product of the domain sizes.                     *
+ *-------------------------------------------------------------------------*/
+static double
+Search_Space(WamWord **array, WamWord **end)
+{
+  WamWord **p;
+  double s = 0;
+
+  for (p = array; p < end; p++)
+    if (!Fd_Variable_Is_Ground(*p))
+      s += log((double) Nb_Elem(*p));
+
+  return s;
+}
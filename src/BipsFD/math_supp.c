@@ -67,6 +67,21 @@
 
 #define MAX_COEF_FOR_SORT          100
 
+#define LINEAR_MIN_MONOMS          4 /* n-ary propagator from this size */
+
+#define LINEAR_NB_TERM             0 /* A frame of a n-ary linear cstr */
+#define LINEAR_SUM_MIN             1
+#define LINEAR_SUM_MAX             2
+#define LINEAR_SPAN                3 /* >= max |a| * (max - min) of a term */
+#define LINEAR_TERMS               4
+
+#define TERM_AF                    0 /* a term: the A frame of the cstr, */
+#define TERM_FDV                   1 /* X, a and the bounds of X in the  */
+#define TERM_COEF                  2 /* sums (X can be reduced since)    */
+#define TERM_MIN                   3
+#define TERM_MAX                   4
+#define LINEAR_TERM_SIZE           5
+
 
 #define PLUS_1                     0
 #define PLUS_2                     1
@@ -191,8 +206,20 @@ static Bool Load_Poly(int nb_monom, Monom *m, WamWord pref_load_word,
 
 static Bool Load_Poly_Rec(int nb_monom, Monom *m, WamWord load_word);
 
+static Bool Load_Poly_Linear(int nb_monom, Monom *m, WamWord load_word);
+
+static PlLong Linear_Propagate(WamWord *t);
+
+static void Linear_Update(WamWord *AF, WamWord *t, PlLong min, PlLong max);
+
+static Bool Linear_Filter(WamWord *AF);
+
 static Bool Load_Delay_Cstr_Part(void);
 
+static Bool Small_Operands(NonLin *i);
+
+static PlLong Word_Max(WamWord x_word);
+
 
 
 #ifdef DEBUG
@@ -205,7 +232,30 @@ void Pl_Write_1(WamWord term_word);
 
 #define New_Poly(p)             ((p).c = (p).nb_monom = 0)
 
-#define Add_Cst_To_Poly(p, s, w)  (p->c += s * w)
+#define Add_Cst_To_Poly(p, s, w)  (p->c = Range_Sat(p->c + s * Range_Sat(w)))
+
+
+	  /* like MATH_CSTR_n but according to full_ac (Load_Delay_Cstr_Part) */
+
+#define DELAY_CSTR_3(f, a1, a2, a3)		\
+  do						\
+    {						\
+      if (full_ac == FALSE)			\
+	PRIM_CSTR_3(f, a1, a2, a3);		\
+      else					\
+	PRIM_CSTR_3(f##_F, a1, a2, a3);		\
+    }						\
+  while (0)
+
+#define DELAY_CSTR_4(f, a1, a2, a3, a4)		\
+  do						\
+    {						\
+      if (full_ac == FALSE)			\
+	PRIM_CSTR_4(f, a1, a2, a3, a4);		\
+      else					\
+	PRIM_CSTR_4(f##_F, a1, a2, a3, a4);	\
+    }						\
+  while (0)
 
 
 
@@ -337,6 +387,13 @@ Load_Left_Right_Rec(Bool optim_eq, WamWord le_word, WamWord re_word,
   if (re_word != NOT_A_WAM_WORD && !Normalize(re_word, -1, &p))
     return FALSE;
 
+  for (i = 0; i < p.nb_monom; i++)	/* saturated coefs are not integers */
+    if (p.m[i].a < -INT_GREATEST_VALUE || p.m[i].a > INT_GREATEST_VALUE)
+      Pl_Err_Evaluation(pl_evaluation_int_overflow);
+
+  if (p.c < -INT_GREATEST_VALUE || p.c > INT_GREATEST_VALUE)
+    Pl_Err_Evaluation(pl_evaluation_int_overflow);
+
   if (sort || p.nb_monom > MAX_MONOMS / 2)
     {
       qsort(p.m, p.nb_monom, sizeof(Monom),
@@ -612,13 +669,14 @@ Add_Monom(Poly *p, int sign, PlLong a, WamWord x_word)
   if (a == 0)
     return;
 
+  a = Range_Sat(a);
   if (sign < 0)
     a = -a;
 
   for (i = 0; i < p->nb_monom; i++)
     if (p->m[i].x_word == x_word)
       {
-	p->m[i].a += a;
+	p->m[i].a = Range_Sat(p->m[i].a + a);
 	return;
       }
 
@@ -644,7 +702,7 @@ Add_Multiply_Monom(Poly *p, int sign, Monom *m1, Monom *m2)
   PlLong a;
   WamWord x_word;
 
-  a = m1->a * m2->a;
+  a = Pl_Range_Mul_Sat(m1->a, m2->a);
 
   if (a == 0)
     return TRUE;
@@ -833,18 +891,20 @@ Normalize(WamWord e_word, int sign, Poly *p)
 	if (!Normalize(le_word, 1, &p1) || !Normalize(re_word, 1, &p2))
 	  return FALSE;
 
-	Add_Cst_To_Poly(p, sign, p1.c * p2.c);
+	Add_Cst_To_Poly(p, sign, Pl_Range_Mul_Sat(p1.c, p2.c));
 
 	for (i1 = 0; i1 < p1.nb_monom; i1++)
 	  {
-	    Add_Monom(p, sign, p1.m[i1].a * p2.c, p1.m[i1].x_word);
+	    Add_Monom(p, sign, Pl_Range_Mul_Sat(p1.m[i1].a, p2.c),
+		      p1.m[i1].x_word);
 	    for (i2 = 0; i2 < p2.nb_monom; i2++)
 	      if (!Add_Multiply_Monom(p, sign, p1.m + i1, p2.m + i2))
 		return FALSE;
 	  }
 
 	for (i2 = 0; i2 < p2.nb_monom; i2++)
-	  Add_Monom(p, sign, p2.m[i2].a * p1.c, p2.m[i2].x_word);
+	  Add_Monom(p, sign, Pl_Range_Mul_Sat(p2.m[i2].a, p1.c),
+		    p2.m[i2].x_word);
 
 	return TRUE;
       }
@@ -859,7 +919,7 @@ Normalize(WamWord e_word, int sign, Poly *p)
 	  if (Tag_Is_INT(word2))
 	    {
 	      n2 = UnTag_INT(word2);
-	      n1 = n1 * n2;
+	      n1 = Pl_Range_Mul_Sat(n1, n2);
 	      Add_Cst_To_Poly(p, sign, n1);
 	      return TRUE;
 	    }
@@ -895,7 +955,7 @@ Normalize(WamWord e_word, int sign, Poly *p)
 	  if (Tag_Is_INT(word2))
 	    {
 	      n2 = UnTag_INT(word2);
-	      if ((n1 = Pl_Power((unsigned) n1, (unsigned) n2)) < 0)
+	      if ((n1 = Pl_Power((PlULong) n1, (PlULong) n2)) < 0)
 		return FALSE;
 
 	      Add_Cst_To_Poly(p, sign, n1);
@@ -1161,6 +1221,9 @@ Load_Poly(int nb_monom, Monom *m, WamWord pref_load_word,
   else
     *load_word = New_Tagged_Fd_Variable;
 
+  if (nb_monom >= LINEAR_MIN_MONOMS && !pl_full_ac)
+    return Load_Poly_Linear(nb_monom, m, *load_word);
+
   return Load_Poly_Rec(nb_monom, m, *load_word);
 }
 
@@ -1242,17 +1305,269 @@ Load_Poly_Rec(int nb_monom, Monom *m, WamWord load_word)
 
 
 
+/*-------------------------------------------------------------------------*
+ * LOAD_POLY_LINEAR                                                        *
+ *                                                                         *
+ * This function loads a polynomial term into a word with a single n-ary   *
+ * constraint a1*X1 + ... + an*Xn - load_word = 0 instead of a chain of    *
+ * primitive constraints (and of intermediate variables).                  *
+ * The constraint maintains the bounds of the sum incrementally: each term *
+ * has its own constraint frame (only triggered by the bounds of its       *
+ * variable) which updates the sums in O(1). The terms are only filtered   *
+ * when a span exceeds the slack of the sums (see Linear_Filter).          *
+ * Since domains only shrink, the sums cannot overflow if sum(|a|*max(X))  *
+ * is < RANGE_SAT_MAX when posted (else the chain of constraints is used). *
+ * This bound is computed before allocating anything on CS since the new   *
+ * FD variables created by Pl_Fd_Prolog_To_Fd_Var() live on CS.            *
+ *-------------------------------------------------------------------------*/
+static Bool
+Load_Poly_Linear(int nb_monom, Monom *m, WamWord load_word)
+{
+  WamWord word, tag_mask;
+  WamWord *AF, *CF, *t;
+  WamWord *fdv_adr;
+  PlLong a, span, max;
+  PlLong sum_min = 0, sum_max = 0, span_max = 0, bound = 0;
+  int n = nb_monom + 1;
+  int i;
+
+#ifdef DEBUG
+  DBGPRINTF("n-ary linear: %d terms\n", nb_monom);
+#endif
+
+  for (i = 0; i < n; i++)
+    {
+      if (i < nb_monom)
+	{
+	  DEREF(m[i].x_word, word, tag_mask);
+	  a = m[i].a;
+	}
+      else
+	{
+	  DEREF(load_word, word, tag_mask);
+	  a = -1;
+	}
+
+      if (tag_mask == TAG_INT_MASK)
+	max = UnTag_INT(word);
+      else if (tag_mask == TAG_FDV_MASK)
+	max = Max(UnTag_FDV(word));
+      else			/* a new variable will be 0..INTERVAL_MAX_INTEGER */
+	max = INTERVAL_MAX_INTEGER;
+
+      bound = Range_Sat(bound + Pl_Range_Mul_Sat((a > 0) ? a : -a, max));
+    }
+
+  if (bound >= RANGE_SAT_MAX)	/* decided before anything is put on CS */
+    return Load_Poly_Rec(nb_monom, m, load_word);
+
+  AF = CS;
+  CS += LINEAR_TERMS + n * LINEAR_TERM_SIZE;
+
+  for (i = 0, t = AF + LINEAR_TERMS; i < n; i++, t += LINEAR_TERM_SIZE)
+    {
+      if (i < nb_monom)
+	{
+	  fdv_adr = Pl_Fd_Prolog_To_Fd_Var(m[i].x_word, TRUE);
+	  a = m[i].a;
+	}
+      else
+	{
+	  fdv_adr = Pl_Fd_Prolog_To_Fd_Var(load_word, TRUE);
+	  a = -1;
+	}
+
+      t[TERM_AF] = (WamWord) AF;
+      t[TERM_FDV] = (WamWord) fdv_adr;
+      t[TERM_COEF] = a;
+      t[TERM_MIN] = Min(fdv_adr);
+      t[TERM_MAX] = Max(fdv_adr);
+    }
+
+  for (i = 0, t = AF + LINEAR_TERMS; i < n; i++, t += LINEAR_TERM_SIZE)
+    {
+      a = t[TERM_COEF];
+      if (a > 0)
+	{
+	  sum_min += a * t[TERM_MIN];
+	  sum_max += a * t[TERM_MAX];
+	  span = a * (t[TERM_MAX] - t[TERM_MIN]);
+	}
+      else
+	{
+	  sum_min += a * t[TERM_MAX];
+	  sum_max += a * t[TERM_MIN];
+	  span = -a * (t[TERM_MAX] - t[TERM_MIN]);
+	}
+      span_max = math_max(span_max, span);
+    }
+
+  AF[LINEAR_NB_TERM] = n;
+  AF[LINEAR_SUM_MIN] = sum_min;
+  AF[LINEAR_SUM_MAX] = sum_max;
+  AF[LINEAR_SPAN] = span_max;
+
+  Fd_Cstr_Type(fd_linear);
+  Pl_Fd_Before_Add_Cstr();
+
+  for (i = 0, t = AF + LINEAR_TERMS; i < n; i++, t += LINEAR_TERM_SIZE)
+    {
+      fdv_adr = (WamWord *) t[TERM_FDV];
+      CF = Pl_Fd_Create_C_Frame(Linear_Propagate, t, fdv_adr, FALSE,
+				FD_PRIO_CHEAP);
+      Pl_Fd_Add_Dependency(fdv_adr, CHAIN_NB_MIN_MAX, CF);
+    }
+
+  return Pl_Fd_After_Add_Cstr(Linear_Filter(AF));
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * LINEAR_PROPAGATE                                                        *
+ *                                                                         *
+ * Constraint of a term t of a n-ary linear constraint.                    *
+ *-------------------------------------------------------------------------*/
+static PlLong
+Linear_Propagate(WamWord *t)
+{
+  WamWord *fdv_adr = (WamWord *) t[TERM_FDV];
+  WamWord *AF = (WamWord *) t[TERM_AF];
+
+  if (Min(fdv_adr) != t[TERM_MIN] || Max(fdv_adr) != t[TERM_MAX])
+    Linear_Update(AF, t, Min(fdv_adr), Max(fdv_adr));
+
+  return Linear_Filter(AF);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * LINEAR_UPDATE                                                           *
+ *                                                                         *
+ * Updates the sums with the new bounds min..max of the variable of t.     *
+ *-------------------------------------------------------------------------*/
+static void
+Linear_Update(WamWord *AF, WamWord *t, PlLong min, PlLong max)
+{
+  PlLong a = t[TERM_COEF];
+  PlLong d_min, d_max;
+
+  if (a > 0)
+    {
+      d_min = a * (min - t[TERM_MIN]);
+      d_max = a * (max - t[TERM_MAX]);
+    }
+  else
+    {
+      d_min = a * (max - t[TERM_MAX]);
+      d_max = a * (min - t[TERM_MIN]);
+    }
+
+  FD_Bind_OV(AF + LINEAR_SUM_MIN, AF[LINEAR_SUM_MIN] + d_min);
+  FD_Bind_OV(AF + LINEAR_SUM_MAX, AF[LINEAR_SUM_MAX] + d_max);
+  FD_Bind_OV(t + TERM_MIN, min);
+  FD_Bind_OV(t + TERM_MAX, max);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * LINEAR_FILTER                                                           *
+ *                                                                         *
+ * Ensures bounds consistency on sum(a*X) = 0. With slack_up = -sum_min    *
+ * and slack_down = sum_max, a term a*X can be reduced only if its span    *
+ * a*(max(X) - min(X)) exceeds a slack, else nothing is done. The new      *
+ * bounds are reflected at once in the sums (and in LINEAR_SPAN), so the   *
+ * frames woken by these reductions find nothing to do.                    *
+ *-------------------------------------------------------------------------*/
+static Bool
+Linear_Filter(WamWord *AF)
+{
+  int n = (int) AF[LINEAR_NB_TERM];
+  WamWord *t, *end = AF + LINEAR_TERMS + n * LINEAR_TERM_SIZE;
+  WamWord *fdv_adr;
+  PlLong a, slack_up, slack_down;
+  PlLong new_min, new_max, span, span_max;
+  Bool reduced;
+
+  do
+    {
+      slack_up = -AF[LINEAR_SUM_MIN];
+      slack_down = AF[LINEAR_SUM_MAX];
+
+      if (slack_up < 0 || slack_down < 0)
+	return FALSE;
+
+      if (AF[LINEAR_SPAN] <= math_min(slack_up, slack_down))
+	return TRUE;
+
+      reduced = FALSE;
+      span_max = 0;
+      for (t = AF + LINEAR_TERMS; t < end; t += LINEAR_TERM_SIZE)
+	{
+	  a = t[TERM_COEF];
+	  if (a > 0)
+	    {
+	      new_min = t[TERM_MAX] - slack_down / a;
+	      new_max = t[TERM_MIN] + slack_up / a;
+	    }
+	  else
+	    {
+	      new_min = t[TERM_MAX] - slack_up / -a;
+	      new_max = t[TERM_MIN] + slack_down / -a;
+	      a = -a;
+	    }
+
+	  if (new_min > t[TERM_MIN] || new_max < t[TERM_MAX])
+	    {
+	      fdv_adr = (WamWord *) t[TERM_FDV];
+	      if (!Pl_Fd_Tell_Interval(fdv_adr,
+				       math_max(new_min, t[TERM_MIN]),
+				       math_min(new_max, t[TERM_MAX])))
+		return FALSE;
+
+	      Linear_Update(AF, t, Min(fdv_adr), Max(fdv_adr));
+	      reduced = TRUE;
+
+	      slack_up = -AF[LINEAR_SUM_MIN];
+	      slack_down = AF[LINEAR_SUM_MAX];
+	      if (slack_up < 0 || slack_down < 0)
+		return FALSE;
+	    }
+
+	  span = a * (t[TERM_MAX] - t[TERM_MIN]);
+	  span_max = math_max(span_max, span);
+	}
+
+      FD_Bind_OV(AF + LINEAR_SPAN, span_max);
+    }
+  while (reduced);
+
+  return TRUE;
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * LOAD_DELAY_CSTR_PART                                                    *
  *                                                                         *
+ * The full AC version of a constraint is also used in partial AC mode if  *
+ * its operands are small enough (see Small_Operands).                     *
  *-------------------------------------------------------------------------*/
 static Bool
 Load_Delay_Cstr_Part(void)
 {
   NonLin *i;
+  Bool full_ac;
 
   for (i = delay_cstr_stack; i < delay_sp; i++)
     {
+      full_ac = pl_full_ac || Small_Operands(i);
       switch (i->cstr)
 	{
 	case DC_X2_EQ_Y:
@@ -1260,12 +1575,12 @@ Load_Delay_Cstr_Part(void)
 	  break;
 
 	case DC_XY_EQ_Z:
-	  MATH_CSTR_3(pl_xy_eq_z, i->a1, i->a2, i->res);
+	  DELAY_CSTR_3(pl_xy_eq_z, i->a1, i->a2, i->res);
 	  break;
 
 	case DC_DIV_A_Y_EQ_Z:
 	  PRIM_CSTR_2(pl_x_gte_c, i->a2, Tag_INT(1));
-	  MATH_CSTR_3(pl_xy_eq_z, i->res, i->a2, i->a1);
+	  DELAY_CSTR_3(pl_xy_eq_z, i->res, i->a2, i->a1);
 	  break;
 
 	case DC_DIV_X_A_EQ_Z:	/* A != 0 has been checked before push in delay stack (see above) */
@@ -1274,7 +1589,7 @@ Load_Delay_Cstr_Part(void)
 
 	case DC_DIV_X_Y_EQ_Z:
 	  PRIM_CSTR_2(pl_x_gte_c, i->a2, Tag_INT(1));
-	  MATH_CSTR_3(pl_xy_eq_z, i->res, i->a2, i->a1);
+	  DELAY_CSTR_3(pl_xy_eq_z, i->res, i->a2, i->a1);
 	  break;
 
 	case DC_ZERO_POWER_N_EQ_Y:
@@ -1314,15 +1629,15 @@ Load_Delay_Cstr_Part(void)
 	  break;
 
 	case DC_QUOT_REM_A_Y_R_EQ_Z:
-	  MATH_CSTR_4(pl_quot_rem_a_y_r_eq_z, i->a1, i->a2, i->a3, i->res);
+	  DELAY_CSTR_4(pl_quot_rem_a_y_r_eq_z, i->a1, i->a2, i->a3, i->res);
 	  break;
 
 	case DC_QUOT_REM_X_A_R_EQ_Z:
-	  MATH_CSTR_4(pl_quot_rem_x_a_r_eq_z, i->a1, i->a2, i->a3, i->res);
+	  DELAY_CSTR_4(pl_quot_rem_x_a_r_eq_z, i->a1, i->a2, i->a3, i->res);
 	  break;
 
 	case DC_QUOT_REM_X_Y_R_EQ_Z:
-	  MATH_CSTR_4(pl_quot_rem_x_y_r_eq_z, i->a1, i->a2, i->a3, i->res);
+	  DELAY_CSTR_4(pl_quot_rem_x_y_r_eq_z, i->a1, i->a2, i->a3, i->res);
 	  break;
 	}
     }
@@ -1334,6 +1649,57 @@ Load_Delay_Cstr_Part(void)
 
 
 
+/*-------------------------------------------------------------------------*
+ * SMALL_OPERANDS                                                          *
+ *                                                                         *
+ * For products and divisions: is max(X)*max(Y) <= vector_max ? Then the   *
+ * domains of all the variables involved are included in 0..vector_max so *
+ * that the full AC version can be used without losing any value and its   *
+ * cost remains limited.                                                   *
+ *-------------------------------------------------------------------------*/
+static Bool
+Small_Operands(NonLin *i)
+{
+  switch (i->cstr)
+    {
+    case DC_XY_EQ_Z:
+    case DC_DIV_A_Y_EQ_Z:
+    case DC_DIV_X_Y_EQ_Z:
+    case DC_QUOT_REM_A_Y_R_EQ_Z:
+    case DC_QUOT_REM_X_A_R_EQ_Z:
+    case DC_QUOT_REM_X_Y_R_EQ_Z:
+      return Pl_Range_Mul_Sat(Word_Max(i->a1), Word_Max(i->a2))
+	<= pl_vec_max_integer;
+    }
+
+  return FALSE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * WORD_MAX                                                                *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static PlLong
+Word_Max(WamWord x_word)
+{
+  WamWord word, tag_mask;
+
+  DEREF(x_word, word, tag_mask);
+  if (tag_mask == TAG_INT_MASK)
+    return UnTag_INT(word);
+
+  if (tag_mask == TAG_FDV_MASK)
+    return Max(UnTag_FDV(word));
+
+  return INTERVAL_MAX_INTEGER;
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * PL_FD_MATH_UNIFY_X_Y                                                    *
  *                                                                         *
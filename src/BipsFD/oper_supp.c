@@ -49,6 +49,8 @@
  * Constants                       *
  *---------------------------------*/
 
+#define PROD_FACTOR_MAX_STEPS      64
+
 /*---------------------------------*
  * Type Definitions                *
  *---------------------------------*/
@@ -61,7 +63,10 @@
  * Function Prototypes             *
  *---------------------------------*/
 
-static unsigned Find_Expon_General(unsigned x, unsigned y, unsigned *pxn);
+static PlULong Find_Expon_General(PlULong x, PlULong y, PlULong *pxn);
+
+static Bool Prod_Factor_Supported(PlLong x, PlLong y_min, PlLong y_max,
+				  PlLong z_min, PlLong z_max);
 
 
 
@@ -70,10 +75,10 @@ static unsigned Find_Expon_General(unsigned x, unsigned y, unsigned *pxn);
  * PL_POWER                                                                *
  *                                                                         *
  *-------------------------------------------------------------------------*/
-unsigned
-Pl_Power(unsigned x, unsigned n)
+PlULong
+Pl_Power(PlULong x, PlULong n)
 {
-  unsigned xn, xp;
+  PlULong xn, xp;
 
   if (n == 0 || x == 1)
     return 1;
@@ -81,22 +86,29 @@ Pl_Power(unsigned x, unsigned n)
   if (x == 0)
     return 0;
 
-  if (n >= sizeof(unsigned) * 8)
+  if (n >= sizeof(PlULong) * 8)
     return INTERVAL_MAX_INTEGER;
 
   xn = 1;
   xp = x;
 
-  while (n)
+  for (;;)			/* saturates instead of wrapping around */
     {
       if (n & 1)
-	xn *= xp;
-      xp *= xp;
+	{
+	  if (xn > INTERVAL_MAX_INTEGER / xp)
+	    return INTERVAL_MAX_INTEGER;
+	  xn *= xp;
+	}
       n >>= 1;
+      if (n == 0)
+	break;
+      if (xp > INTERVAL_MAX_INTEGER / xp)
+	return INTERVAL_MAX_INTEGER;
+      xp *= xp;
     }
 
-  return ((PlLong) xn > 0 && (PlLong) xn <= INTERVAL_MAX_INTEGER)
-    ? xn : INTERVAL_MAX_INTEGER;
+  return xn;
 }
 
 
@@ -106,12 +118,12 @@ Pl_Power(unsigned x, unsigned n)
  * PL_NTH_ROOT_DN                                                          *
  *                                                                         *
  *-------------------------------------------------------------------------*/
-unsigned
-Pl_Nth_Root_Dn(unsigned y, unsigned n)
+PlULong
+Pl_Nth_Root_Dn(PlULong y, PlULong n)
 {
-  unsigned old, new;
-  unsigned n1 = n - 1;
-  unsigned oldn1;
+  PlULong old, new;
+  PlULong n1 = n - 1;
+  PlULong oldn1;
   int bit, nb;
 
   if (y == 0)
@@ -120,16 +132,16 @@ Pl_Nth_Root_Dn(unsigned y, unsigned n)
   if (n == 0)
     return INTERVAL_MAX_INTEGER;
 
-  if (n >= sizeof(unsigned) * 8)
+  if (n >= sizeof(PlULong) * 8)
     return 1;
 
   bit = Pl_Most_Significant_Bit(y);
 
-  if ((unsigned) (bit + 1) < n)
+  if ((PlULong) (bit + 1) < n)
     return 1;
 
-  nb = bit / n;
-  new = 1 << nb;
+  nb = (int) (bit / n);
+  new = (PlULong) 1 << nb;
 
   old = new;
   oldn1 = Pl_Power(old, n1);
@@ -152,10 +164,10 @@ Pl_Nth_Root_Dn(unsigned y, unsigned n)
  * PL_NTH_ROOT_UP                                                          *
  *                                                                         *
  *-------------------------------------------------------------------------*/
-unsigned
-Pl_Nth_Root_Up(unsigned y, unsigned n)
+PlULong
+Pl_Nth_Root_Up(PlULong y, PlULong n)
 {
-  unsigned x;
+  PlULong x;
 
   if (y == 0)
     return 0;
@@ -177,17 +189,17 @@ Pl_Nth_Root_Up(unsigned y, unsigned n)
  * PL_NTH_ROOT_EXACT                                                       *
  *                                                                         *
  *-------------------------------------------------------------------------*/
-unsigned
-Pl_Nth_Root_Exact(unsigned y, unsigned n)
+PlULong
+Pl_Nth_Root_Exact(PlULong y, PlULong n)
 {
-  unsigned x;
+  PlULong x;
 
   if (y == 0)
     return 0;
 
   x = Pl_Nth_Root_Dn(y, n);
   if (Pl_Power(x, n) != y)
-    return (unsigned) -1;
+    return (PlULong) -1;
 
   return x;
 }
@@ -199,10 +211,10 @@ Pl_Nth_Root_Exact(unsigned y, unsigned n)
  * PL_SQRT_DN                                                              *
  *                                                                         *
  *-------------------------------------------------------------------------*/
-unsigned
-Pl_Sqrt_Dn(unsigned y)
+PlULong
+Pl_Sqrt_Dn(PlULong y)
 {
-  unsigned old, new;
+  PlULong old, new;
 
   if (y == 0)
     return 0;
@@ -225,10 +237,10 @@ Pl_Sqrt_Dn(unsigned y)
  * PL_SQRT_UP                                                              *
  *                                                                         *
  *-------------------------------------------------------------------------*/
-unsigned
-Pl_Sqrt_Up(unsigned y)
+PlULong
+Pl_Sqrt_Up(PlULong y)
 {
-  unsigned x;
+  PlULong x;
 
   x = Pl_Sqrt_Dn(y);
   if (x * x != y)
@@ -244,14 +256,14 @@ Pl_Sqrt_Up(unsigned y)
  * PL_SQRT_EXACT                                                           *
  *                                                                         *
  *-------------------------------------------------------------------------*/
-unsigned
-Pl_Sqrt_Exact(unsigned y)
+PlULong
+Pl_Sqrt_Exact(PlULong y)
 {
-  unsigned x;
+  PlULong x;
 
   x = Pl_Sqrt_Dn(y);
   if (x * x != y)
-    return (unsigned) -1;
+    return (PlULong) -1;
 
   return x;
 }
@@ -263,11 +275,11 @@ Pl_Sqrt_Exact(unsigned y)
  * PL_FIND_EXPON_DN                                                        *
  *                                                                         *
  *-------------------------------------------------------------------------*/
-unsigned
-Pl_Find_Expon_Dn(unsigned x, unsigned y)
+PlULong
+Pl_Find_Expon_Dn(PlULong x, PlULong y)
 {
-  unsigned n;
-  unsigned xn;
+  PlULong n;
+  PlULong xn;
 
   if (x <= 1 || y == 0)
     return INTERVAL_MAX_INTEGER;
@@ -286,11 +298,11 @@ Pl_Find_Expon_Dn(unsigned x, unsigned y)
  *                                                                         *
  * X must be > 1 and Y must be > 0                                         *
  *-------------------------------------------------------------------------*/
-unsigned
-Pl_Find_Expon_Up(unsigned x, unsigned y)
+PlULong
+Pl_Find_Expon_Up(PlULong x, PlULong y)
 {
-  unsigned n;
-  unsigned xn;
+  PlULong n;
+  PlULong xn;
 
   if (x <= 1 || y == 0)
     return INTERVAL_MAX_INTEGER;
@@ -309,11 +321,11 @@ Pl_Find_Expon_Up(unsigned x, unsigned y)
  *                                                                         *
  * X must be > 1 and Y must be > 0                                         *
  *-------------------------------------------------------------------------*/
-unsigned
-Pl_Find_Expon_Exact(unsigned x, unsigned y)
+PlULong
+Pl_Find_Expon_Exact(PlULong x, PlULong y)
 {
-  unsigned n;
-  unsigned xn;
+  PlULong n;
+  PlULong xn;
 
   if (x <= 1 || y == 0)
     return INTERVAL_MAX_INTEGER;
@@ -322,7 +334,7 @@ Pl_Find_Expon_Exact(unsigned x, unsigned y)
   n = Find_Expon_General(x, y, &xn);
 
   if (y != xn)
-    return (unsigned) -1;
+    return (PlULong) -1;
 
   return n;
 }
@@ -330,28 +342,121 @@ Pl_Find_Expon_Exact(unsigned x, unsigned y)
 
 
 
+/*-------------------------------------------------------------------------*
+ * PL_PROD_FACTOR_MIN                                                      *
+ *                                                                         *
+ * Returns the smallest x such that x*y = z for some y in y_min..y_max and *
+ * z in z_min..z_max (all >= 0). At most PROD_FACTOR_MAX_STEPS values are  *
+ * tried, the last candidate is then returned (it is still a lower bound). *
+ * Returns z_max+1 if there is no such x.                                  *
+ *-------------------------------------------------------------------------*/
+PlLong
+Pl_Prod_Factor_Min(PlLong y_min, PlLong y_max, PlLong z_min, PlLong z_max)
+{
+  PlLong x;
+  int steps;
+
+  if (z_min == 0)		/* x = 0 */
+    return 0;
+
+  if (y_max == 0)
+    return z_max + 1;
+
+  x = (z_min + y_max - 1) / y_max;
+  for (steps = 0; steps < PROD_FACTOR_MAX_STEPS; steps++, x++)
+    {
+      if (x > z_max)
+	return z_max + 1;
+
+      if (Prod_Factor_Supported(x, y_min, y_max, z_min, z_max))
+	break;
+    }
+
+  return x;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_PROD_FACTOR_MAX                                                      *
+ *                                                                         *
+ * Returns the greatest x such that x*y = z for some y in y_min..y_max and *
+ * z in z_min..z_max (all >= 0). Same remarks as Pl_Prod_Factor_Min.       *
+ * Returns -1 if there is no such x.                                       *
+ *-------------------------------------------------------------------------*/
+PlLong
+Pl_Prod_Factor_Max(PlLong y_min, PlLong y_max, PlLong z_min, PlLong z_max)
+{
+  PlLong x;
+  int steps;
+
+  if (y_min == 0)
+    {
+      if (z_min == 0)		/* y = 0 */
+	return INTERVAL_MAX_INTEGER;
+      y_min = 1;
+    }
+
+  if (y_min > y_max)
+    return -1;
+
+  x = z_max / y_min;
+  for (steps = 0; steps < PROD_FACTOR_MAX_STEPS; steps++, x--)
+    {
+      if (x == 0)
+	return (z_min == 0) ? 0 : -1;
+
+      if (Prod_Factor_Supported(x, y_min, y_max, z_min, z_max))
+	break;
+    }
+
+  return x;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PROD_FACTOR_SUPPORTED                                                   *
+ *                                                                         *
+ * Is there a multiple of x (x > 0) in z_min..z_max with a quotient in     *
+ * y_min..y_max ?                                                          *
+ *-------------------------------------------------------------------------*/
+static Bool
+Prod_Factor_Supported(PlLong x, PlLong y_min, PlLong y_max,
+		      PlLong z_min, PlLong z_max)
+{
+  PlLong y_lo = (z_min + x - 1) / x;
+  PlLong y_hi = z_max / x;
+
+  return math_max(y_lo, y_min) <= math_min(y_hi, y_max);
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * FIND_EXPON_GENERAL                                                      *
  *                                                                         *
  * X must be > 1 and Y must be > 0                                         *
  *-------------------------------------------------------------------------*/
-static unsigned
-Find_Expon_General(unsigned x, unsigned y, unsigned *pxn)
+static PlULong
+Find_Expon_General(PlULong x, PlULong y, PlULong *pxn)
 {
-  static unsigned txp[sizeof(unsigned) * 8];
-  unsigned *p = txp;
-  unsigned xp;
-  unsigned prod;
-  unsigned n;
-  unsigned xn;
+  static PlULong txp[sizeof(PlULong) * 8];
+  PlULong *p = txp;
+  PlULong xp;
+  PlULong n;
+  PlULong xn;
 
   p = txp;
   xp = x;
-  prod = 1;
-  while (prod < y && (PlLong) xp > 0)
+  for (;;)			/* all X^(2^i) <= Y (stops before overflow) */
     {
       *p++ = xp;
-      prod *= xp;
+      if (xp > y / xp)
+	break;
       xp *= xp;
     }
 
@@ -382,15 +487,16 @@ Find_Expon_General(unsigned x, unsigned y, unsigned *pxn)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 void
-Pl_Full_Coeff_Power_Var(Range *y, int a, Range *n)
+Pl_Full_Coeff_Power_Var(Range *y, PlLong a, Range *n)
 {
-  unsigned an, an0;
-  int i, vec_elem;
+  PlULong an, an0;
+  PlLong i;
+  int vec_elem;
 
   an = Pl_Power(a, n->min);
 
   Vector_Allocate(y->vec);
-  if (an > (unsigned) pl_vec_max_integer)
+  if (an > (PlULong) pl_vec_max_integer)
     {
       y->extra_cstr = TRUE;
       Set_To_Empty(y);
@@ -401,12 +507,15 @@ Pl_Full_Coeff_Power_Var(Range *y, int a, Range *n)
   y->extra_cstr = FALSE;
   y->min = an;
 
+  if (Is_IList(n))		/* approximated by a vector */
+    Pl_Range_Becomes_Sparse(n);
+
   if (Is_Interval(n))		/* N is Interval */
     {
       an0 = an;
       for (i = n->min; i <= n->max; i++)
 	{
-	  if (an0 > (unsigned) pl_vec_max_integer)
+	  if (an0 > (PlULong) pl_vec_max_integer)
 	    goto end_loop;
 
 	  an = an0;
@@ -421,7 +530,7 @@ Pl_Full_Coeff_Power_Var(Range *y, int a, Range *n)
       VECTOR_BEGIN_ENUM(n->vec, vec_elem);
 
       an = Pl_Power(a, vec_elem);
-      if (an > (unsigned) pl_vec_max_integer)
+      if (an > (PlULong) pl_vec_max_integer)
 	goto end_loop;
 
       Vector_Set_Value(y->vec, an);
@@ -442,10 +551,11 @@ end_loop:
  * Here A>=2 then Y>=1                                                     *
  *-------------------------------------------------------------------------*/
 void
-Pl_Full_Find_Expon(Range *n, int a, Range *y)
+Pl_Full_Find_Expon(Range *n, PlLong a, Range *y)
 {
-  int e = 0, min;		/* init for the compiler */
-  int i, vec_elem;
+  PlLong e = 0, min;		/* init for the compiler */
+  PlLong i;
+  int vec_elem;
 
   Vector_Allocate(n->vec);
   Pl_Vector_Empty(n->vec);
@@ -454,6 +564,9 @@ Pl_Full_Find_Expon(Range *n, int a, Range *y)
   min = -1;
 
 
+  if (Is_IList(y))		/* approximated by a vector */
+    Pl_Range_Becomes_Sparse(y);
+
   if (Is_Interval(y))		/* Y is Interval */
     {
       for (i = y->min; i <= y->max; i++)
@@ -498,15 +611,16 @@ Pl_Full_Find_Expon(Range *n, int a, Range *y)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 void
-Pl_Full_Var_Power_Coeff(Range *y, Range *x, int a)
+Pl_Full_Var_Power_Coeff(Range *y, Range *x, PlLong a)
 {
-  unsigned xa;
-  int i, vec_elem;
+  PlULong xa;
+  PlLong i;
+  int vec_elem;
 
   xa = Pl_Power(x->min, a);
 
   Vector_Allocate(y->vec);
-  if (xa > (unsigned) pl_vec_max_integer)
+  if (xa > (PlULong) pl_vec_max_integer)
     {
       y->extra_cstr = TRUE;
       Set_To_Empty(y);
@@ -517,12 +631,15 @@ Pl_Full_Var_Power_Coeff(Range *y, Range *x, int a)
   y->extra_cstr = FALSE;
   y->min = xa;
 
+  if (Is_IList(x))		/* approximated by a vector */
+    Pl_Range_Becomes_Sparse(x);
+
   if (Is_Interval(x))		/* X is Interval */
     {
       for (i = x->min; i <= x->max; i++)
 	{
 	  xa = Pl_Power(i, a);
-	  if (xa > (unsigned) pl_vec_max_integer)
+	  if (xa > (PlULong) pl_vec_max_integer)
 	    goto end_loop;
 
 	  Vector_Set_Value(y->vec, xa);
@@ -535,7 +652,7 @@ Pl_Full_Var_Power_Coeff(Range *y, Range *x, int a)
       VECTOR_BEGIN_ENUM(x->vec, vec_elem);
 
       xa = Pl_Power(vec_elem, a);
-      if (xa > (unsigned) pl_vec_max_integer)
+      if (xa > (PlULong) pl_vec_max_integer)
 	goto end_loop;
 
       Vector_Set_Value(y->vec, xa);
@@ -555,10 +672,11 @@ end_loop:
  *                                                                         *
  *-------------------------------------------------------------------------*/
 void
-Pl_Full_Nth_Root(Range *x, Range *y, int a)
+Pl_Full_Nth_Root(Range *x, Range *y, PlLong a)
 {
-  int e = 0, min;		/* init for the compiler */
-  int i, vec_elem;
+  PlLong e = 0, min;		/* init for the compiler */
+  PlLong i;
+  int vec_elem;
 
   Vector_Allocate(x->vec);
   Pl_Vector_Empty(x->vec);
@@ -567,6 +685,9 @@ Pl_Full_Nth_Root(Range *x, Range *y, int a)
   min = -1;
 
 
+  if (Is_IList(y))		/* approximated by a vector */
+    Pl_Range_Becomes_Sparse(y);
+
   if (Is_Interval(y))		/* Y is Interval */
     {
       for (i = y->min; i <= y->max; i++)
@@ -613,13 +734,14 @@ Pl_Full_Nth_Root(Range *x, Range *y, int a)
 void
 Pl_Full_Var_Power_2(Range *y, Range *x)
 {
-  unsigned x2;
-  int i, vec_elem;
+  PlULong x2;
+  PlLong i;
+  int vec_elem;
 
   x2 = x->min * x->min;
 
   Vector_Allocate(y->vec);
-  if (x2 > (unsigned) pl_vec_max_integer)
+  if (x2 > (PlULong) pl_vec_max_integer)
     {
       y->extra_cstr = TRUE;
       Set_To_Empty(y);
@@ -630,12 +752,15 @@ Pl_Full_Var_Power_2(Range *y, Range *x)
   y->extra_cstr = FALSE;
   y->min = x2;
 
+  if (Is_IList(x))		/* approximated by a vector */
+    Pl_Range_Becomes_Sparse(x);
+
   if (Is_Interval(x))		/* X is Interval */
     {
       for (i = x->min; i <= x->max; i++)
 	{
 	  x2 = i * i;
-	  if (x2 > (unsigned) pl_vec_max_integer)
+	  if (x2 > (PlULong) pl_vec_max_integer)
 	    goto end_loop;
 
 	  Vector_Set_Value(y->vec, x2);
@@ -648,7 +773,7 @@ Pl_Full_Var_Power_2(Range *y, Range *x)
       VECTOR_BEGIN_ENUM(x->vec, vec_elem);
 
       x2 = vec_elem * vec_elem;
-      if (x2 > (unsigned) pl_vec_max_integer)
+      if (x2 > (PlULong) pl_vec_max_integer)
 	goto end_loop;
 
       Vector_Set_Value(y->vec, x2);
@@ -670,8 +795,9 @@ end_loop:
 void
 Pl_Full_Sqrt_Var(Range *x, Range *y)
 {
-  int e = 0, min;		/* init for the compiler */
-  int i, vec_elem;
+  PlLong e = 0, min;		/* init for the compiler */
+  PlLong i;
+  int vec_elem;
 
   Vector_Allocate(x->vec);
   Pl_Vector_Empty(x->vec);
@@ -680,6 +806,9 @@ Pl_Full_Sqrt_Var(Range *x, Range *y)
   min = -1;
 
 
+  if (Is_IList(y))		/* approximated by a vector */
+    Pl_Range_Becomes_Sparse(y);
+
   if (Is_Interval(y))		/* Y is Interval */
     {
       for (i = y->min; i <= y->max; i++)
@@ -52,39 +52,45 @@
  * Function Prototypes             *
  *---------------------------------*/
 
-unsigned Pl_Power(unsigned x, unsigned n);
+PlULong Pl_Power(PlULong x, PlULong n);
 
-unsigned Pl_Nth_Root_Dn(unsigned y, unsigned n);
+PlULong Pl_Nth_Root_Dn(PlULong y, PlULong n);
 
-unsigned Pl_Nth_Root_Up(unsigned y, unsigned n);
+PlULong Pl_Nth_Root_Up(PlULong y, PlULong n);
 
-unsigned Pl_Nth_Root_Exact(unsigned y, unsigned n);
+PlULong Pl_Nth_Root_Exact(PlULong y, PlULong n);
 
-unsigned Pl_Sqrt_Dn(unsigned y);
+PlULong Pl_Sqrt_Dn(PlULong y);
 
-unsigned Pl_Sqrt_Up(unsigned y);
+PlULong Pl_Sqrt_Up(PlULong y);
 
-unsigned Pl_Sqrt_Exact(unsigned y);
+PlULong Pl_Sqrt_Exact(PlULong y);
 
-unsigned Pl_Find_Expon_Dn(unsigned x, unsigned y);
+PlULong Pl_Find_Expon_Dn(PlULong x, PlULong y);
 
-unsigned Pl_Find_Expon_Up(unsigned x, unsigned y);
+PlULong Pl_Find_Expon_Up(PlULong x, PlULong y);
 
-unsigned Pl_Find_Expon_Exact(unsigned x, unsigned y);
+PlULong Pl_Find_Expon_Exact(PlULong x, PlULong y);
 
-void Pl_Full_Coeff_Power_Var(Range *y, int a, Range *n);
+PlLong Pl_Prod_Factor_Min(PlLong y_min, PlLong y_max,
+			  PlLong z_min, PlLong z_max);
 
-void Pl_Full_Find_Expon(Range *n, int a, Range *y);
+PlLong Pl_Prod_Factor_Max(PlLong y_min, PlLong y_max,
+			  PlLong z_min, PlLong z_max);
 
-void Pl_Full_Var_Power_Coeff(Range *y, Range *x, int a);
+void Pl_Full_Coeff_Power_Var(Range *y, PlLong a, Range *n);
 
-void Pl_Full_Nth_Root(Range *x, Range *y, int a);
+void Pl_Full_Find_Expon(Range *n, PlLong a, Range *y);
+
+void Pl_Full_Var_Power_Coeff(Range *y, Range *x, PlLong a);
+
+void Pl_Full_Nth_Root(Range *x, Range *y, PlLong a);
 
 void Pl_Full_Var_Power_2(Range *y, Range *x);
 
 void Pl_Full_Sqrt_Var(Range *x, Range *y);
 
-void Full_Max_Cst_Var(Range *z, int a, Range *x);
+void Full_Max_Cst_Var(Range *z, PlLong a, Range *x);
 
-void Full_Min_Cst_Var(Range *z, int a, Range *x);
+void Full_Min_Cst_Var(Range *z, PlLong a, Range *x);
 
@@ -111,6 +111,10 @@
 
 #define START_EVALUABLE_TBL_SIZE    64
 
+#define FLT_TMP_SIZE                1024 /* in WamWords */
+
+#define FLT_WORDS                   (sizeof(double) / sizeof(WamWord))
+
 
 
 
@@ -136,6 +140,11 @@ EvaluableInf;
 
 static char *evaluable_tbl;
 
+	  /* intermediate floats of an expression (see Make_Tagged_Float) */
+static WamWord *flt_tmp;
+static WamWord *flt_tmp_top;
+static WamWord *flt_tmp_end;
+
 /*---------------------------------*
  * Function Prototypes             *
  *---------------------------------*/
@@ -149,6 +158,13 @@ static WamWord Load_Math_Expression(WamWord exp_word);
 
 
 
+#define Is_Flt_Tmp(adr)       ((adr) >= flt_tmp && (adr) < flt_tmp_end)
+
+#define Reset_Flt_Tmp         (flt_tmp_top = flt_tmp)
+
+
+
+
 #define Pl_Lookup_Evaluable(func, arity) \
   (EvaluableInf *) Pl_Hash_Find(evaluable_tbl, Functor_Arity(func, arity))
 
@@ -180,6 +196,10 @@ Arith_Initializer(void)
 
   evaluable_tbl = Pl_Hash_Alloc_Table(START_EVALUABLE_TBL_SIZE, sizeof(EvaluableInf));
 
+  flt_tmp = (WamWord *) Malloc(FLT_TMP_SIZE * sizeof(WamWord));
+  flt_tmp_end = flt_tmp + FLT_TMP_SIZE;
+  Reset_Flt_Tmp;
+
   ADD_EVALUABLE("pi",                    0, "=F",       TRUE,  Pl_Fct_PI);
   ADD_EVALUABLE("e",                     0, "=F",       FALSE, Pl_Fct_E);
   ADD_EVALUABLE("epsilon",               0, "=F",       FALSE, Pl_Fct_Epsilon);
@@ -398,9 +418,40 @@ Pl_Math_Fast_Load_Value(WamWord start_word, WamWord *word_adr)
 
 
 
+/*-------------------------------------------------------------------------*
+ * PL_MATH_BOX_FLOAT                                                       *
+ *                                                                         *
+ * Called by compiled prolog code (on the result of is/2).                 *
+ * Copies on the heap a float only stored in the temporary area (i.e. an   *
+ * intermediate result) since it escapes. The temporary area is reset.     *
+ *-------------------------------------------------------------------------*/
+WamWord FC
+Pl_Math_Box_Float(WamWord x_word)
+{
+  WamWord *adr;
+
+  if (Tag_Is_FLT(x_word) && Is_Flt_Tmp(adr = UnTag_FLT(x_word)))
+    {
+      x_word = Tag_FLT(H);
+      Pl_Global_Push_Float(Pl_Obtain_Float(adr));
+    }
+
+  Reset_Flt_Tmp;
+  return x_word;
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * MAKE_TAGGED_FLOAT                                                       *
  *                                                                         *
+ * Floats computed during the evaluation of an expression are intermediate *
+ * results (consumed by the next operation) so they are not pushed on the  *
+ * heap but stored in a temporary area. Only a result which escapes (e.g.  *
+ * the result of is/2) is boxed on the heap (see Pl_Math_Box_Float). The   *
+ * area is reset after each comparison or boxing. If it is full (very big  *
+ * expression or an evaluation aborted by an error), floats go on the heap.*
  *-------------------------------------------------------------------------*/
 static WamWord
 Make_Tagged_Float(double d)
@@ -409,6 +460,14 @@ Make_Tagged_Float(double d)
 
   Check_Double_Errors(d, FALSE);
 
+  if (flt_tmp_top + FLT_WORDS <= flt_tmp_end)
+    {
+      x_word = Tag_FLT(flt_tmp_top);
+      memcpy(flt_tmp_top, &d, sizeof(double));
+      flt_tmp_top += FLT_WORDS;
+      return x_word;
+    }
+
   x_word = Tag_FLT(H);
 
   Pl_Global_Push_Float(d);
@@ -524,7 +583,7 @@ Load_Math_Expression(WamWord exp_word)
 Bool
 Pl_Arith_Evaluate_2(WamWord x_word, WamWord exp_word)
 {
-  return Pl_Unify(x_word, Load_Math_Expression(exp_word));
+  return Pl_Unify(x_word, Pl_Math_Box_Float(Load_Math_Expression(exp_word)));
 }
 
 
@@ -746,11 +805,13 @@ compare_with_double(PlLong a, double b)
 
 
 
+	/* NB: a float in an error term is boxed (can be temporary) */
+
 #define IxItoI(x_word, y_word, fast_op)				\
   if (Tag_Is_FLT(x_word))		/* error case */	\
-    Pl_Err_Type(pl_type_integer, x_word);			\
+    Pl_Err_Type(pl_type_integer, Pl_Math_Box_Float(x_word));	\
   if (Tag_Is_FLT(y_word))		/* error case */	\
-    Pl_Err_Type(pl_type_integer, y_word);			\
+    Pl_Err_Type(pl_type_integer, Pl_Math_Box_Float(y_word));	\
   return fast_op(x_word, y_word)
 
 
@@ -763,7 +824,7 @@ compare_with_double(PlLong a, double b)
 
 #define ItoI(x_word, fast_op)                         \
   if (Tag_Is_FLT(x_word))            /* error case */ \
-    Pl_Err_Type(pl_type_integer, x_word);             \
+    Pl_Err_Type(pl_type_integer, Pl_Math_Box_Float(x_word)); \
   return fast_op(x_word)
 
 
@@ -1555,6 +1616,7 @@ Pl_Fct_Identity(WamWord x_word)
 	  /* Mathematic Comparisons */
 
 #define Cmp_IFxIF(x_word, y_word, c_op, fast_op)     \
+  Reset_Flt_Tmp;				     \
   return (X_and_Y_are_INT(x_word, y_word))           \
     ? fast_op(x_word, y_word)                        \
     : (To_Double(x_word) c_op To_Double(y_word))
@@ -1041,4 +1041,5 @@ void
 Pl_Math_Evaluate(WamWord expr, WamWord *result)
 {
   Pl_Math_Load_Value(expr, result);
+  *result = Pl_Math_Box_Float(*result);
 }
@@ -172,6 +172,8 @@ void FC Pl_Math_Fast_Load_Value(WamWord start_word, WamWord *word_adr);
 
 void FC Pl_Math_Load_Value(WamWord start_word, WamWord *word_adr);
 
+WamWord FC Pl_Math_Box_Float(WamWord x_word);
+
 WamWord FC Pl_Fct_Fast_Neg(WamWord x_word);
 
 WamWord FC Pl_Fct_Fast_Inc(WamWord x_word);
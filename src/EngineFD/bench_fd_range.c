@@ -0,0 +1,312 @@
+/*-------------------------------------------------------------------------*
+ * GNU Prolog                                                              *
+ *                                                                         *
+ * Part  : FD constraint solver                                            *
+ * File  : bench_fd_range.c                                                *
+ * Descr.: FD Range Implementation - vector kernels microbenchmark         *
+ * Author: Daniel Diaz                                                     *
+ *                                                                         *
+ * Copyright (C) 1999-2023 Daniel Diaz                                     *
+ *                                                                         *
+ * This file is part of GNU Prolog                                         *
+ *                                                                         *
+ * GNU Prolog is free software: you can redistribute it and/or             *
+ * modify it under the terms of either:                                    *
+ *                                                                         *
+ *   - the GNU Lesser General Public License as published by the Free      *
+ *     Software Foundation; either version 3 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or                                                                      *
+ *                                                                         *
+ *   - the GNU General Public License as published by the Free             *
+ *     Software Foundation; either version 2 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or both in parallel, as here.                                           *
+ *                                                                         *
+ * GNU Prolog is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ * General Public License for more details.                                *
+ *                                                                         *
+ * You should have received copies of the GNU General Public License and   *
+ * the GNU Lesser General Public License along with this program.  If      *
+ * not, see http://www.gnu.org/licenses/.                                  *
+ *-------------------------------------------------------------------------*/
+
+/* Usage: bench_fd_range [vector_max [nb_iterations]]
+ *
+ * Times the Pl_Vector_* operations with each vector kernel supported by the
+ * running CPU (see Pl_Vector_Best_Kernel) and checks that all kernels
+ * compute the same results as the portable one. Built by "make bench".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "engine_pl.h"
+#include "engine_fd.h"
+
+
+
+
+/*---------------------------------*
+ * Constants                       *
+ *---------------------------------*/
+
+#define BENCH_VECTOR_MAX         32767
+#define BENCH_NB_ITER            200000
+
+#define NB_VECTORS                 16
+
+enum
+{
+  OP_COPY,
+  OP_UNION,
+  OP_INTER,
+  OP_COMPL,
+  OP_NULL_INTER,
+  OP_NB_ELEM,
+  OP_ITH_ELEM,
+  OP_NEXT_AFTER,
+  OP_ADD_VALUE,
+  OP_ADD_VECTOR,
+  OP_SUB_VECTOR,
+  NB_OPS
+};
+
+
+
+
+/*---------------------------------*
+ * Type Definitions                *
+ *---------------------------------*/
+
+typedef struct
+{
+  char *name;
+  int iter_div;			/* nb_iter / iter_div iterations */
+}
+OpInf;
+
+
+
+
+/*---------------------------------*
+ * Global Variables                *
+ *---------------------------------*/
+
+static OpInf op_tbl[NB_OPS] = {
+  {"copy", 1},
+  {"union", 1},
+  {"inter", 1},
+  {"compl", 1},
+  {"test_null_inter", 1},
+  {"nb_elem", 1},
+  {"ith_elem", 1},
+  {"next_after", 1},
+  {"add_value", 1},
+  {"add_vector", 100},
+  {"sub_vector", 100}
+};
+
+static char *kernel_name[] = { "undefined", "portable", "popcnt", "avx2" };
+
+static Vector vec_tbl[NB_VECTORS];
+static Vector sparse_tbl[NB_VECTORS];
+static Vector res;
+static PlULong checksum[NB_OPS];
+
+
+
+
+/*---------------------------------*
+ * Function Prototypes             *
+ *---------------------------------*/
+
+static PlULong Run_Op(int op, int nb_iter);
+
+static void Random_Vector(Vector vec, int density);
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * MAIN                                                                    *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+int
+main(int argc, char *argv[])
+{
+  int vec_max = (argc > 1) ? atoi(argv[1]) : BENCH_VECTOR_MAX;
+  int nb_iter = (argc > 2) ? atoi(argv[2]) : BENCH_NB_ITER;
+  int best, kernel, op, i;
+  int n;
+  PlULong sum;
+  clock_t t;
+  double ns;
+  int errors = 0;
+
+  Pl_Start_Prolog(1, argv);
+
+  Pl_Define_Vector_Size(vec_max);
+  best = Pl_Vector_Best_Kernel();
+
+  srand(1);
+  for (i = 0; i < NB_VECTORS; i++)
+    {
+      vec_tbl[i] = (Vector) malloc(pl_vec_size * sizeof(VecWord));
+      Random_Vector(vec_tbl[i], (i % 4) * 30 + 5);
+      sparse_tbl[i] = (Vector) malloc(pl_vec_size * sizeof(VecWord));
+      Random_Vector(sparse_tbl[i], 1);
+    }
+  res = (Vector) malloc(pl_vec_size * sizeof(VecWord));
+
+  printf("vector_max: %d (%d words) - best kernel: %s\n",
+	 pl_vec_max_integer, pl_vec_size, kernel_name[best]);
+
+  printf("%-16s", "operation");
+  for (kernel = VEC_KERNEL_PORTABLE; kernel <= best; kernel++)
+    printf(" %12s", kernel_name[kernel]);
+  printf("   (ns/op)\n");
+
+  for (op = 0; op < NB_OPS; op++)
+    {
+      printf("%-16s", op_tbl[op].name);
+      for (kernel = VEC_KERNEL_PORTABLE; kernel <= best; kernel++)
+	{
+	  pl_vec_kernel = kernel;
+	  n = nb_iter / op_tbl[op].iter_div;
+	  if (n == 0)
+	    n = 1;
+
+	  t = clock();
+	  sum = Run_Op(op, n);
+	  ns = (double) (clock() - t) * 1e9 / CLOCKS_PER_SEC / n;
+
+	  if (kernel == VEC_KERNEL_PORTABLE)
+	    checksum[op] = sum;
+	  else if (sum != checksum[op])
+	    {
+	      printf(" %12s", "MISMATCH");
+	      errors++;
+	      continue;
+	    }
+	  printf(" %12.1f", ns);
+	}
+      printf("\n");
+    }
+
+  pl_vec_kernel = best;
+  Pl_Stop_Prolog();
+
+  return errors != 0;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * RUN_OP                                                                  *
+ *                                                                         *
+ * Runs nb_iter times the operation op and returns a checksum of the       *
+ * results (so that they can be compared between kernels).                 *
+ *-------------------------------------------------------------------------*/
+static PlULong
+Run_Op(int op, int nb_iter)
+{
+  WamWord *save_CS = CS;
+  PlULong sum = 0;
+  Vector vec, vec1;
+  int i, j;
+
+  Pl_Vector_Copy(res, vec_tbl[0]);
+
+  for (i = 0; i < nb_iter; i++)
+    {
+      vec = vec_tbl[i % NB_VECTORS];
+      vec1 = vec_tbl[(i + 3) % NB_VECTORS];
+
+      if (op >= OP_ADD_VALUE)
+	Pl_Vector_Copy(res, vec);
+
+      switch (op)
+	{
+	case OP_COPY:
+	  Pl_Vector_Copy(res, vec);
+	  break;
+
+	case OP_UNION:
+	  Pl_Vector_Union(res, vec1);
+	  break;
+
+	case OP_INTER:
+	  Pl_Vector_Inter(res, vec1);
+	  break;
+
+	case OP_COMPL:
+	  Pl_Vector_Compl(res);
+	  break;
+
+	case OP_NULL_INTER:
+	  sum += Pl_Vector_Test_Null_Inter(vec, vec1);
+	  continue;
+
+	case OP_NB_ELEM:
+	  sum += Pl_Vector_Nb_Elem(vec);
+	  continue;
+
+	case OP_ITH_ELEM:
+	  sum += Pl_Vector_Ith_Elem(vec, i % 97 + 1);
+	  continue;
+
+	case OP_NEXT_AFTER:
+	  sum += Pl_Vector_Next_After(vec, i % pl_vec_max_integer);
+	  continue;
+
+	case OP_ADD_VALUE:
+	  Pl_Vector_Add_Value(res, (i % 2) ? i % 1000 : -(i % 1000));
+	  break;
+
+	case OP_ADD_VECTOR:
+	  Pl_Vector_Add_Vector(res, sparse_tbl[i % NB_VECTORS]);
+	  CS = save_CS;
+	  break;
+
+	case OP_SUB_VECTOR:
+	  Pl_Vector_Sub_Vector(res, sparse_tbl[i % NB_VECTORS]);
+	  CS = save_CS;
+	  break;
+	}
+
+      if (i < NB_VECTORS)	/* check the whole result once per input */
+	for (j = 0; j < pl_vec_size; j++)
+	  sum = sum * 31 + res[j];
+      else
+	sum = sum * 31 + res[i % pl_vec_size];
+    }
+
+  CS = save_CS;
+  return sum;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * RANDOM_VECTOR                                                           *
+ *                                                                         *
+ * Each value is in the vector with a probability of density percent.     *
+ *-------------------------------------------------------------------------*/
+static void
+Random_Vector(Vector vec, int density)
+{
+  int i;
+
+  Pl_Vector_Empty(vec);
+  for (i = 0; i <= pl_vec_max_integer; i++)
+    if (rand() % 100 < density)
+      Vector_Set_Value(vec, i);
+}
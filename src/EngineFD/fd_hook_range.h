@@ -41,4 +41,4 @@
  *---------------------------------*/
 
 #define RANGE_TOP_STACK            CS
-#define INTERVAL_MAX_INTEGER       ((int)(((PlLong)1<<(32-TAG_SIZE-1))-1))	/* only 32 bits (even on 64 bits machine) */
+#define INTERVAL_MAX_INTEGER       (((PlLong)1<<(WORD_SIZE-TAG_SIZE-1))-1)	/* any Prolog integer >= 0 */
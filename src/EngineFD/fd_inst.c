@@ -38,6 +38,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define FD_INST_FILE
 
@@ -48,6 +49,8 @@
 
 #include "bips_pl.h"
 
+#include "fd_trace.h"
+
 #if 0
 #define DEBUG_CHECK_DATES_AND_QUEUE
 #endif
@@ -67,16 +70,41 @@
  * Type Definitions                *
  *---------------------------------*/
 
+typedef struct			/* bound of an objective (fd_minimize) */
+{
+  WamWord *fdv_adr;
+  PlLong min;
+  PlLong max;
+}
+FdBound;
+
+
+
+
 /*---------------------------------*
  * Global Variables                *
  *---------------------------------*/
 
 static WamWord *TP;
 
+static WamWord *cstr_queue_head[FD_NB_PRIO];	/* queued constraints (prio > 0) */
+static WamWord *cstr_queue_tail[FD_NB_PRIO];
+static WamWord *current_cf;	/* idempotent constraint being executed */
+
+static FdBound *bound_stack;	/* bounds told at each propagation */
+static int bound_size;
+static int bound_top;
+
 static WamWord dummy_fd_var[FD_VARIABLE_FRAME_SIZE];
 
 static PlULong DATE;   /* NB: PlLong/PlULong have the same size as a WamWord (intptr_t) */
 
+static int cstr_type_size;	/* allocated size of pl_fd_cstr_type[] */
+
+static FdTraceRec *trace_buff;	/* ring buffer of the trace */
+static int trace_buff_size;
+static uint64_t trace_nb_event;
+
 /*
  * When a constraint X in ...  is added the following sequence is executed:
  * Pl_Fd_Before_Add_Cstr  (init the queue)
@@ -163,6 +191,44 @@ static PlULong DATE;   /* NB: PlLong/PlULong have the same size as a WamWord (in
  * NB: if a constraint reexecution fails (in the above loop), X has the 
  * MASK_TO_KEEP_IN_QUEUE set. This is not a problem since at the next
  * constraint post the queue is cleared assigning 0 to each Queue_Propag_Mask.
+ *
+ * Constraint priorities. Each constraint frame records a cost class
+ * (Cstr_Priority(cf), declared with "priority" in .fd files). Cheap
+ * constraints (FD_PRIO_CHEAP) are reexecuted as above. Other constraints
+ * found in the chains are not reexecuted but added (once) to the FIFO of
+ * their priority (linked with Cstr_Next_In_Queue, NULL if not queued).
+ * When the queue of variables is empty (i.e. cheap constraints have reached
+ * their fix-point) the first constraint of the lowest non-empty priority is
+ * dequeued and executed, then the queue of variables is processed again...
+ * So expensive (global) constraints are executed once on stable domains
+ * instead of once per modified variable.
+ *
+ * An idempotent constraint (FD_CSTR_IDEMPOTENT) does not need to be woken
+ * by its own modifications. While it is executed, current_cf points to it.
+ * Queue_Origin(X) records the constraint which caused the pending events
+ * on X: current_cf for the first event, NULL if events come from different
+ * constraints (QUEUE_ORIGIN_NONE: no event yet). Constraints of X equal to
+ * Queue_Origin(X) are not reexecuted.
+ *
+ * Each execution increments Cstr_Nb_Wakeups(cf) and the counter of its
+ * priority in pl_fd_nb_wakeups[] (see fd_wakeups/1).
+ *
+ * Solver statistics (see fd_statistics/2). Each constraint frame records
+ * the type of the constraint (Cstr_Type(cf)), i.e. the index of the name of
+ * the user constraint (or C constraint) in pl_fd_cstr_type[] which counts
+ * the executions, failures and domain reductions per type. The type of the
+ * constraint being posted or executed is pl_fd_cur_cstr_type (set by
+ * Fd_Cstr_Type() when posting), reset to FD_CSTR_TYPE_OTHER at the end of
+ * the propagation. When the trace is on, each event is also recorded in a
+ * ring buffer (see fd_trace.h).
+ *
+ * Search statistics (see the learning heuristics of fd_labeling/2). They
+ * are not trailed, so they are kept when backtracking (and restarting):
+ *   - Cstr_Weight(cf): 1 + the number of failures of the constraint
+ *     in the propagation phase (dom/wdeg).
+ *   - Fdv_Activity(X): incremented by pl_fd_activity_inc at each
+ *     reduction of X (the labeling decays it by increasing the increment).
+ *   - Fdv_Impact(X): maintained by the labeling (impact-based search).
  */
 
 #define DATE_NEVER   0
@@ -188,29 +254,22 @@ static void All_Propagations(WamWord *fdv_adr, int propag);
 
 static void Clear_Queue(void);
 
+static void Enqueue_Cstr(WamWord *CF);
 
+static WamWord *Dequeue_Cstr(void);
 
+static Bool Execute_Cstr(WamWord *CF);
 
-/*---------------------------------*
- * Auxiliary engine macros         *
- *---------------------------------*/
-
-#define FD_Word_Needs_Trailing(adr)  ((adr) <  CSB(B))
+static Bool Tell_Bounds(void);
 
+static void Failure_Stat(WamWord *CF);
 
 
 
-#define FD_Bind_OV(adr, word)       		\
-  do						\
-    {						\
-      if (FD_Word_Needs_Trailing(adr))		\
-	Trail_OV(adr);				\
-      *(adr) = (word);				\
-    }						\
-  while (0)
-
-
 
+/*---------------------------------*
+ * Auxiliary engine macros         *
+ *---------------------------------*/
 
 #define Trail_Fd_Int_Variable_If_Necessary(fdv_adr)		\
   do								\
@@ -233,7 +292,7 @@ static void Clear_Queue(void);
       if (Range_Stamp(fdv_adr) != STAMP)			\
 	{							\
 	  Trail_MV(fdv_adr + OFFSET_RANGE, RANGE_SIZE);		\
-	  if (Is_Sparse(Range(fdv_adr)))			\
+	  if (Is_Vector(Range(fdv_adr))) /* an IList is not modified */ \
 	      Trail_MV((WamWord *) Vec(fdv_adr), pl_vec_size);	\
 								\
 	  Range_Stamp(fdv_adr) = STAMP;				\
@@ -410,6 +469,9 @@ Pl_Fd_Init_Solver0(void)
 
   Pl_Define_Vector_Size(max_val);
 
+  if (pl_fd_cstr_type == NULL)
+    Pl_Fd_Cstr_Type("other");	/* FD_CSTR_TYPE_OTHER */
+
   Pl_Fd_Reset_Solver0();
 
   pl_fd_unify_with_integer = Pl_Fd_Unify_With_Integer0;
@@ -431,6 +493,9 @@ Pl_Fd_Reset_Solver0(void)
   STAMP = 0;
   DATE = 1;
   TP = dummy_fd_var;		/* the queue is empty */
+  bound_top = 0;
+  current_cf = NULL;
+  pl_fd_cur_cstr_type = FD_CSTR_TYPE_OTHER;
 }
 
 
@@ -461,7 +526,7 @@ Pl_Fd_Prolog_To_Fd_Var(WamWord arg_word, Bool pl_var_ok)
     }
 
   if (tag_mask == TAG_INT_MASK)
-    return Pl_Fd_New_Int_Variable((int) UnTag_INT(word));
+    return Pl_Fd_New_Int_Variable(UnTag_INT(word));
 
   if (tag_mask != TAG_FDV_MASK)
     Pl_Err_Type(pl_type_fd_variable, word);
@@ -498,19 +563,18 @@ Pl_Fd_Prolog_To_Range(WamWord list_word)
  * PL_FD_PROLOG_TO_VALUE                                                   *
  *                                                                         *
  *-------------------------------------------------------------------------*/
-int
+PlLong
 Pl_Fd_Prolog_To_Value(WamWord arg_word)
 {
   PlLong v = Pl_Rd_Integer_Check(arg_word);
 
-				/* conversion PlLong -> int (Fd only uses int) */
   if (v < -INTERVAL_MAX_INTEGER)
     v = -INTERVAL_MAX_INTEGER;
 
   if (v > INTERVAL_MAX_INTEGER)
     v = INTERVAL_MAX_INTEGER;
 
-  return (int) v;
+  return v;
 }
 
 
@@ -526,16 +590,14 @@ Pl_Fd_List_Int_To_Range(Range *range, WamWord list_word)
   WamWord word, tag_mask;
   WamWord save_list_word;
   WamWord *lst_adr;
-  WamWord val;
+  WamWord *save_CS = CS;
+  PlLong *val = (PlLong *) CS;	/* values are first stored on the top of CS */
   int n = 0;
+  Range r;
 
 
   save_list_word = list_word;
 
-  range->extra_cstr = FALSE;
-  Vector_Allocate_If_Necessary(range->vec);
-  Pl_Vector_Empty(range->vec);
-
   for (;;)
     {
       DEREF(list_word, word, tag_mask);
@@ -551,23 +613,19 @@ Pl_Fd_List_Int_To_Range(Range *range, WamWord list_word)
 
       lst_adr = UnTag_LST(word);
       
-      val = Pl_Fd_Prolog_To_Value(Car(lst_adr));
-
-      if ((unsigned) val > (unsigned) pl_vec_max_integer)
-	range->extra_cstr = TRUE;
-      else
-	{
-	  Vector_Set_Value(range->vec, val);
-	  n++;
-	}
+      val[n] = Pl_Fd_Prolog_To_Value(Car(lst_adr));
+      if (val[n] >= 0)		/* negative values are ignored */
+	n++;
 
       list_word = Cdr(lst_adr);
     }
 
-  if (n == 0)
-    Set_To_Empty(range);
-  else
-    Pl_Range_From_Vector(range);
+  CS += (n * sizeof(PlLong) + sizeof(WamWord) - 1) / sizeof(WamWord);
+  r.vec = NULL;
+  Pl_Range_From_Values(&r, val, n);
+
+  CS = save_CS;			/* move the range down over the values */
+  Pl_Range_Copy(range, &r);
 }
 
 
@@ -765,13 +823,21 @@ Pl_Fd_Prolog_To_Array_Fdv(WamWord list_word, Bool pl_var_ok)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 WamWord *
-Pl_Fd_Create_C_Frame(CstrFct cstr_fct , WamWord *AF, WamWord *fdv_adr, Bool optim2)
+Pl_Fd_Create_C_Frame(CstrFct cstr_fct , WamWord *AF, WamWord *fdv_adr, Bool optim2,
+		     int prio_info)
 {
   WamWord *CF = CS;
 
   AF_Pointer(CF) = AF;
   Optim_Pointer(CF) = (optim2 && fdv_adr) ? &FD_INT_Date(fdv_adr) : &optim2_date_always;
   Cstr_Address(CF) = cstr_fct;
+  Cstr_Prio_Info(CF) = prio_info;
+  Cstr_Next_In_Queue(CF) = NULL;
+  Cstr_Nb_Wakeups(CF) = 0;
+  Cstr_Weight(CF) = 1;
+  Cstr_Type(CF) = pl_fd_cur_cstr_type;
+
+  Fd_Trace(FD_TRACE_POST, pl_fd_cur_cstr_type, CF, 0);
 
   /* if ground Nb_Cstr not allocated (Fd_Int_Frame) */
   if (fdv_adr && !Fd_Variable_Is_Ground(fdv_adr))
@@ -835,7 +901,7 @@ Pl_Fd_Add_List_Dependency(WamWord *array, int chain_nb, WamWord *CF)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 WamWord *
-Pl_Fd_New_Variable_Interval(int min, int max)
+Pl_Fd_New_Variable_Interval(PlLong min, PlLong max)
 {
   WamWord *fdv_adr;
 
@@ -852,6 +918,9 @@ Pl_Fd_New_Variable_Interval(int min, int max)
 
   Queue_Propag_Mask(fdv_adr) = 0;
   Queue_Next_Fdv_Adr(fdv_adr) = NULL;
+  Queue_Origin(fdv_adr) = NULL;
+  Fdv_Activity(fdv_adr) = 0;
+  Fdv_Impact(fdv_adr) = 0;
 
   Range_Stamp(fdv_adr) = STAMP;
   Nb_Elem(fdv_adr) = max - min + 1;
@@ -864,6 +933,7 @@ Pl_Fd_New_Variable_Interval(int min, int max)
   Chain_Dom(fdv_adr) = Chain_Val(fdv_adr) = NULL;
 
   CS += FD_VARIABLE_FRAME_SIZE;
+  pl_fd_nb_var++;
   return fdv_adr;
 }
 
@@ -902,7 +972,7 @@ Pl_Fd_New_Variable_Range(Range *r)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 WamWord *
-Pl_Fd_New_Int_Variable(int n)
+Pl_Fd_New_Int_Variable(PlLong n)
 {
   WamWord *fdv_adr = CS;
 
@@ -911,6 +981,9 @@ Pl_Fd_New_Int_Variable(int n)
 
   Queue_Propag_Mask(fdv_adr) = 0;
   Queue_Next_Fdv_Adr(fdv_adr) = NULL;
+  Queue_Origin(fdv_adr) = NULL;
+  Fdv_Activity(fdv_adr) = 0;
+  Fdv_Impact(fdv_adr) = 0;
 
   Range_Stamp(fdv_adr) = STAMP;
   Nb_Elem(fdv_adr) = 1;
@@ -1000,6 +1073,10 @@ Clear_Queue(void)
   WamWord *BP;
   WamWord *fdv_adr;
 
+  current_cf = NULL;
+  while (Dequeue_Cstr() != NULL)
+    ;
+
   if (TP == dummy_fd_var)	/* empty ? */
     return;
 
@@ -1026,7 +1103,7 @@ Clear_Queue(void)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 Bool
-Pl_Fd_Tell_Value(WamWord *fdv_adr, int n)
+Pl_Fd_Tell_Value(WamWord *fdv_adr, PlLong n)
 {
   int propag;
 
@@ -1055,14 +1132,12 @@ Pl_Fd_Tell_Value(WamWord *fdv_adr, int n)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 Bool
-Pl_Fd_Tell_Not_Value(WamWord *fdv_adr, int n)
+Pl_Fd_Tell_Not_Value(WamWord *fdv_adr, PlLong n)
 {
   Range *r;
-  int min, max;
+  PlLong min, max;
   int propag;
 
-start:
-
   r = Range(fdv_adr);
 
   if (!Pl_Range_Test_Value(r, n))
@@ -1080,34 +1155,26 @@ start:
   max = r->max;
 
 
-  if (Is_Interval(r) && n != min && n != max)
-    {
-      if (min > pl_vec_max_integer)
-	{
-	  Pl_Fd_Display_Extra_Cstr(fdv_adr);
-	  return FALSE;
-	}
+  if ((Is_Interval(r) && n != min && n != max) ||
+      (Is_IList(r) && Nb_Elem(fdv_adr) > 2))
+    {				/* a vector or an interval list is created */
+      Trail_Range_If_Necessary(fdv_adr);
+      Pl_Range_Reset_Value(r, n);
+      Nb_Elem(fdv_adr)--;
 
-      if (min == pl_vec_max_integer)
+      propag = MASK_EMPTY;
+      Set_Dom_Mask(propag);
+      if (r->min != min)
 	{
-	  Pl_Fd_Display_Extra_Cstr(fdv_adr);
-	  Update_Range_From_Int(fdv_adr, min, propag);
-	  All_Propagations(fdv_adr, propag);
-	  return TRUE;
+	  Set_Min_Mask(propag);
+	  Set_Min_Max_Mask(propag);
 	}
-
-      Trail_Range_If_Necessary(fdv_adr);
-      Pl_Range_Becomes_Sparse(r);
-      Nb_Elem(fdv_adr) = r->max - r->min + 1;
-      if (r->extra_cstr)	/* the max has been changed */
+      if (r->max != max)
 	{
-	  propag = MASK_EMPTY;
 	  Set_Max_Mask(propag);
 	  Set_Min_Max_Mask(propag);
-	  Set_Dom_Mask(propag);
-	  All_Propagations(fdv_adr, propag);
 	}
-      goto start;
+      goto do_propag;
     }
 
 
@@ -1162,7 +1229,7 @@ do_propag:
 Bool
 Pl_Fd_Tell_Int_Range(WamWord *fdv_adr, Range *range)
 {
-  int n = Min(fdv_adr);
+  PlLong n = Min(fdv_adr);
 
   if (!Pl_Range_Test_Value(range, n))
     {
@@ -1183,11 +1250,11 @@ Pl_Fd_Tell_Int_Range(WamWord *fdv_adr, Range *range)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 Bool
-Pl_Fd_Tell_Interv_Interv(WamWord *fdv_adr, int min, int max)
+Pl_Fd_Tell_Interv_Interv(WamWord *fdv_adr, PlLong min, PlLong max)
 {
-  int nb_elem;
+  PlLong nb_elem;
   int propag;
-  int min1, max1;
+  PlLong min1, max1;
 
 
   min1 = Min(fdv_adr);
@@ -1223,17 +1290,23 @@ Pl_Fd_Tell_Interv_Interv(WamWord *fdv_adr, int min, int max)
 Bool
 Pl_Fd_Tell_Range_Range(WamWord *fdv_adr, Range *range)
 {
-  int nb_elem;
+  PlLong nb_elem;
   int propag;
   WamWord *save_CS = CS;
 
-  if (range->vec)
-    CS = (WamWord *) range->vec;
-  CS += pl_vec_size;
+  if (Is_IList(range))		/* protect the list (result above it) */
+    CS = math_max(CS, (WamWord *) IList_Of(range) +
+		  IList_Size(IList_Nb_Interv(IList_Of(range))));
+  else
+    {
+      if (range->vec)
+	CS = (WamWord *) range->vec;
+      CS += pl_vec_size;
+    }
 
   Pl_Range_Inter(range, Range(fdv_adr));
 
-  CS = save_CS;
+  CS = save_CS;			/* an IList result is moved down by the copy */
 
   if (Is_Empty(range))
     {
@@ -1272,9 +1345,9 @@ Pl_Fd_Tell_Range_Range(WamWord *fdv_adr, Range *range)
  * Called by fd_to_c.h                                                     *
  *-------------------------------------------------------------------------*/
 Bool
-Pl_Fd_Tell_Interval(WamWord *fdv_adr, int min, int max)
+Pl_Fd_Tell_Interval(WamWord *fdv_adr, PlLong min, PlLong max)
 {
-  int n;
+  PlLong n;
   Range range;
 
   if (Fd_Variable_Is_Ground(fdv_adr))
@@ -1319,22 +1392,128 @@ Pl_Fd_Tell_Range(WamWord *fdv_adr, Range *range)
 static void
 All_Propagations(WamWord *fdv_adr, int propag)
 {
+  Fdv_Activity(fdv_adr) += pl_fd_activity_inc;
+
+  pl_fd_cstr_type[pl_fd_cur_cstr_type].nb_reduc++;
+  Fd_Trace(FD_TRACE_REDUC, pl_fd_cur_cstr_type, fdv_adr, Nb_Elem(fdv_adr));
+
   if (propag &= Chains_Mask(fdv_adr))
     {				     /* here propag != 0 */
       if (!Is_Var_In_Queue(fdv_adr)) /* not yet in the queue */
 	{
 	  Queue_Propag_Mask(fdv_adr) = propag; /* setting propag != 0 adds the var to the queue */
+	  Queue_Origin(fdv_adr) = current_cf;
 	  Queue_Next_Fdv_Adr(TP) = fdv_adr;
 	  TP = fdv_adr;
 	}
       else			/* already in the queue */
-	Queue_Propag_Mask(fdv_adr) |= propag;
+	{
+	  Queue_Propag_Mask(fdv_adr) |= propag;
+	  if (Queue_Origin(fdv_adr) == QUEUE_ORIGIN_NONE)
+	    Queue_Origin(fdv_adr) = current_cf;
+	  else if (Queue_Origin(fdv_adr) != current_cf)
+	    Queue_Origin(fdv_adr) = NULL;
+	}
     }
 }
 
 
 
 
+/*-------------------------------------------------------------------------*
+ * ENQUEUE_CSTR                                                            *
+ *                                                                         *
+ * Adds a constraint (priority > FD_PRIO_CHEAP) at the end of the queue of *
+ * its priority (if not yet in the queue).                                 *
+ *-------------------------------------------------------------------------*/
+static void
+Enqueue_Cstr(WamWord *CF)
+{
+  int prio = Cstr_Priority(CF);
+
+  if (Cstr_Next_In_Queue(CF) != NULL) /* already in the queue */
+    return;
+
+  Cstr_Next_In_Queue(CF) = CF;	/* last of the queue points to itself */
+
+  if (cstr_queue_head[prio] == NULL)
+    cstr_queue_head[prio] = CF;
+  else
+    Cstr_Next_In_Queue(cstr_queue_tail[prio]) = CF;
+
+  cstr_queue_tail[prio] = CF;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * DEQUEUE_CSTR                                                            *
+ *                                                                         *
+ * Removes and returns the first constraint of the lowest non-empty        *
+ * priority (NULL if all queues are empty).                                *
+ *-------------------------------------------------------------------------*/
+static WamWord *
+Dequeue_Cstr(void)
+{
+  WamWord *CF;
+  int prio;
+
+  for (prio = FD_PRIO_CHEAP + 1; prio < FD_NB_PRIO; prio++)
+    if ((CF = cstr_queue_head[prio]) != NULL)
+      {
+	cstr_queue_head[prio] = (Cstr_Next_In_Queue(CF) == CF) ? NULL : Cstr_Next_In_Queue(CF);
+	Cstr_Next_In_Queue(CF) = NULL;
+	return CF;
+      }
+
+  return NULL;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * EXECUTE_CSTR                                                            *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static Bool
+Execute_Cstr(WamWord *CF)
+{
+  WamWord *AF = AF_Pointer(CF);
+  CstrFct fct = Cstr_Address(CF);
+
+  Cstr_Nb_Wakeups(CF)++;
+  pl_fd_nb_wakeups[Cstr_Priority(CF)]++;
+
+  pl_fd_cur_cstr_type = Cstr_Type(CF);
+  pl_fd_cstr_type[pl_fd_cur_cstr_type].nb_propag++;
+  Fd_Trace(FD_TRACE_PROPAG, pl_fd_cur_cstr_type, CF, 0);
+
+  current_cf = Cstr_Is_Idempotent(CF) ? CF : NULL;
+
+  fct = (CstrFct) (*fct) (AF);
+
+  if (fct == (CstrFct) FALSE)
+    return FALSE;
+#if 1						/* FD switch */
+  if (fct != (CstrFct) TRUE)	/* FD switch case triggered */
+    {
+      if ((*fct) (AF) == FALSE)
+	return FALSE;
+
+      Pl_Fd_Stop_Constraint(CF);
+    }
+#endif
+
+  current_cf = NULL;
+
+  return TRUE;
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * PL_FD_AFTER_ADD_CSTR                                                    *
  *                                                                         *
@@ -1348,92 +1527,251 @@ Pl_Fd_After_Add_Cstr(Bool result_of_tell)
   WamWord **chain_adr;
   WamWord *CF;
   WamWord *BP;
+  WamWord *origin;
   PlULong date = DATE;		/* local copy for efficiency */
   PlULong *pdate;
   WamWord *AF;
   CstrFct fct;
+  PlULong nb_cheap = 0;		/* local copy of pl_fd_nb_wakeups[FD_PRIO_CHEAP] */
 
   if (!result_of_tell)
     {
+      Failure_Stat(NULL);
     clear_queue:
+      pl_fd_nb_wakeups[FD_PRIO_CHEAP] += nb_cheap;
+      pl_fd_cur_cstr_type = FD_CSTR_TYPE_OTHER;
       Clear_Queue(); /* Do it now, not in Pl_Fd_Before_Add_Cstr (see comment above) */
       return FALSE;
     }
 
-  if (TP == dummy_fd_var)
-    return TRUE;
-
-  BP = Queue_Next_Fdv_Adr(dummy_fd_var);
-
+  if (bound_top > 0 && !Tell_Bounds())
+    {
+      Failure_Stat(NULL);
+      goto clear_queue;
+    }
 
   for (;;)
     {
-      fdv_adr = (WamWord *) BP;
-      propag = Queue_Propag_Mask(fdv_adr);
+      if (TP != dummy_fd_var)	/* propagate the queue of variables */
+	{
+	  BP = Queue_Next_Fdv_Adr(dummy_fd_var);
 
-      /* NB: the var must stay in the queue until fix-point (no more reactivations) */
-      /* add a mask to keep it in the queue (in case it is reactivated) */
-      Queue_Propag_Mask(fdv_adr) = MASK_TO_KEEP_IN_QUEUE;
+	  for (;;)
+	    {
+	      fdv_adr = (WamWord *) BP;
+	      propag = Queue_Propag_Mask(fdv_adr);
+	      origin = Queue_Origin(fdv_adr);
 
-      chain_adr = &Chain_Min(fdv_adr);
+	      /* NB: the var must stay in the queue until fix-point (no more reactivations) */
+	      /* add a mask to keep it in the queue (in case it is reactivated) */
+	      Queue_Propag_Mask(fdv_adr) = MASK_TO_KEEP_IN_QUEUE;
+	      Queue_Origin(fdv_adr) = QUEUE_ORIGIN_NONE;
 
+	      chain_adr = &Chain_Min(fdv_adr);
 
-      for (; propag; propag >>= 1, chain_adr++)
-	if (propag & 1)
-	  {
-	    record_adr = (*chain_adr);
-	    do
-	      {
-		CF = CF_Pointer(record_adr);
+
+	      for (; propag; propag >>= 1, chain_adr++)
+		if (propag & 1)
+		  {
+		    record_adr = (*chain_adr);
+		    do
+		      {
+			CF = CF_Pointer(record_adr);
 
 #if 1
-		/* optim #2 (and for 'stop constraint' management) */
-		pdate = Optim_Pointer(CF);
-		if (*pdate != DATE_ALWAYS && *pdate != date)
-		  continue;
+			/* optim #2 (and for 'stop constraint' management) */
+			pdate = Optim_Pointer(CF);
+			if (*pdate != DATE_ALWAYS && *pdate != date)
+			  continue;
 #endif
 
-		fct = Cstr_Address(CF);
-		AF = AF_Pointer(CF);
-
-		fct = (CstrFct) (*fct) (AF);
-
-		if (fct == (CstrFct) FALSE)
-		  {
-		  failure:
-		    Queue_Next_Fdv_Adr(dummy_fd_var) = BP; /* update begin of remaining queue */
-		    goto clear_queue;
-		  }
+			if (CF == origin) /* idempotent: its own modification */
+			  continue;
+
+			if (Cstr_Prio_Info(CF) != FD_PRIO_CHEAP) /* queued or idempotent */
+			  {
+			    if (Cstr_Priority(CF) != FD_PRIO_CHEAP)
+			      Enqueue_Cstr(CF);
+			    else if (!Execute_Cstr(CF))
+			      goto failure;
+			    continue;
+			  }
+
+			Cstr_Nb_Wakeups(CF)++;
+			nb_cheap++;
+
+			pl_fd_cur_cstr_type = Cstr_Type(CF);
+			pl_fd_cstr_type[pl_fd_cur_cstr_type].nb_propag++;
+			Fd_Trace(FD_TRACE_PROPAG, pl_fd_cur_cstr_type, CF, 0);
+
+			fct = Cstr_Address(CF);
+			AF = AF_Pointer(CF);
+
+			fct = (CstrFct) (*fct) (AF);
+
+			if (fct == (CstrFct) FALSE)
+			  {
+			  failure:
+			    Cstr_Weight(CF)++;
+			    Failure_Stat(CF);
+			    Queue_Next_Fdv_Adr(dummy_fd_var) = BP; /* update begin of remaining queue */
+			    goto clear_queue;
+			  }
 #if 1						/* FD switch */
-		if (fct != (CstrFct) TRUE)	/* FD switch case triggered */
-		  {
-		    if ((*fct) (AF) == FALSE)
-		      goto failure;
+			if (fct != (CstrFct) TRUE)	/* FD switch case triggered */
+			  {
+			    if ((*fct) (AF) == FALSE)
+			      goto failure;
 
-		    Pl_Fd_Stop_Constraint(CF);
-		  }
+			    Pl_Fd_Stop_Constraint(CF);
+			  }
 #endif
-	      }
-	    while ((record_adr = Next_Chain(record_adr)) != NULL);
-	  }
+		      }
+		    while ((record_adr = Next_Chain(record_adr)) != NULL);
+		  }
 
 
-      /* undo the mask */
-      Queue_Propag_Mask(fdv_adr) &= (MASK_TO_KEEP_IN_QUEUE - 1);
+	      /* undo the mask */
+	      Queue_Propag_Mask(fdv_adr) &= (MASK_TO_KEEP_IN_QUEUE - 1);
 
-      /* reactivated ? */
-      if (Queue_Propag_Mask(fdv_adr) == 0) /* no longer in queue ? */
-	{
-	  /*  Del_Var_From_Queue(fdv_adr); since Queue_Propag_Mask(fdv_adr) == 0 */
+	      /* reactivated ? */
+	      if (Queue_Propag_Mask(fdv_adr) == 0) /* no longer in queue ? */
+		{
+		  /*  Del_Var_From_Queue(fdv_adr); since Queue_Propag_Mask(fdv_adr) == 0 */
+
+		  if (BP == TP)
+		    break;
 
-	  if (BP == TP)
-	    break;
+		  BP = Queue_Next_Fdv_Adr(BP);
+		}
+	    }
 
-	  BP = Queue_Next_Fdv_Adr(BP);
+	  TP = dummy_fd_var;	/* queue of variables is now empty */
 	}
+
+				/* cheap constraints are at fix-point */
+      if ((CF = Dequeue_Cstr()) == NULL)
+	break;
+
+      pdate = Optim_Pointer(CF);
+      if (*pdate != DATE_ALWAYS && *pdate != date)
+	continue;
+
+      if (!Execute_Cstr(CF))
+	{
+	  Cstr_Weight(CF)++;
+	  Failure_Stat(CF);
+	  goto clear_queue;
+	}
+    }
+
+  pl_fd_nb_wakeups[FD_PRIO_CHEAP] += nb_cheap;
+  pl_fd_cur_cstr_type = FD_CSTR_TYPE_OTHER;
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * FAILURE_STAT                                                            *
+ *                                                                         *
+ * Counts a failure of the propagation (CF is the failed constraint, NULL  *
+ * if a tell of the current constraint failed).                            *
+ *-------------------------------------------------------------------------*/
+static void
+Failure_Stat(WamWord *CF)
+{
+  int type = (CF) ? (int) Cstr_Type(CF) : pl_fd_cur_cstr_type;
+
+  pl_fd_cstr_type[type].nb_fail++;
+  Fd_Trace(FD_TRACE_FAIL, type, CF, 0);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_PUSH_BOUND                                                        *
+ *                                                                         *
+ * Restricts fdv_adr to min..max at each propagation as long as this bound *
+ * is in the stack. Used by fd_minimize/fd_maximize to tighten the bound   *
+ * of the objective without restarting the search: the bound is not       *
+ * undone on backtracking. The FD var must not be reclaimed (backtracking) *
+ * before the bound is popped. Returns the number of bounds in the stack.  *
+ *-------------------------------------------------------------------------*/
+int
+Pl_Fd_Push_Bound(WamWord *fdv_adr, PlLong min, PlLong max)
+{
+  FdBound *b;
+
+  if (bound_top == bound_size)
+    {
+      bound_size = (bound_size == 0) ? 8 : 2 * bound_size;
+      bound_stack = (FdBound *) Realloc(bound_stack, bound_size * sizeof(FdBound));
     }
 
-  TP = dummy_fd_var;		/* queue is now empty */
+  b = bound_stack + bound_top++;
+  b->fdv_adr = fdv_adr;
+  b->min = min;
+  b->max = max;
+
+  return bound_top;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_POP_BOUND                                                         *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Pop_Bound(void)
+{
+  if (bound_top > 0)
+    bound_top--;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_SET_BOUND                                                         *
+ *                                                                         *
+ * Updates the bound on the top of the stack.                              *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Set_Bound(PlLong min, PlLong max)
+{
+  if (bound_top > 0)
+    {
+      bound_stack[bound_top - 1].min = min;
+      bound_stack[bound_top - 1].max = max;
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * TELL_BOUNDS                                                             *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static Bool
+Tell_Bounds(void)
+{
+  FdBound *b;
+  int i;
+
+  for (i = 0; i < bound_top; i++)
+    {
+      b = bound_stack + i;
+      if ((Min(b->fdv_adr) < b->min || Max(b->fdv_adr) > b->max) &&
+	  !Pl_Fd_Tell_Interval(b->fdv_adr, b->min, b->max))
+	return FALSE;
+    }
 
   return TRUE;
 }
@@ -1461,7 +1799,7 @@ Pl_Fd_Stop_Constraint(WamWord *CF)
  * Used by domain predicates.                                              *
  *-------------------------------------------------------------------------*/
 Bool
-Pl_Fd_In_Interval(WamWord *fdv_adr, int min, int max)
+Pl_Fd_In_Interval(WamWord *fdv_adr, PlLong min, PlLong max)
 {
   Pl_Fd_Before_Add_Cstr();
 
@@ -1496,7 +1834,7 @@ Pl_Fd_In_Range(WamWord *fdv_adr, Range *range)
  * Used by labeling predicates.                                            *
  *-------------------------------------------------------------------------*/
 Bool
-Pl_Fd_Assign_Value_Fast(WamWord *fdv_adr, int n)
+Pl_Fd_Assign_Value_Fast(WamWord *fdv_adr, PlLong n)
 {
   int propag;
 
@@ -1516,7 +1854,7 @@ Pl_Fd_Assign_Value_Fast(WamWord *fdv_adr, int n)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 Bool
-Pl_Fd_Unify_With_Integer0(WamWord *fdv_adr, int n)
+Pl_Fd_Unify_With_Integer0(WamWord *fdv_adr, PlLong n)
 {
   /* Pl_Unify(X,n) == X in n..n */
   Pl_Fd_Before_Add_Cstr();
@@ -1532,7 +1870,7 @@ Pl_Fd_Unify_With_Integer0(WamWord *fdv_adr, int n)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 Bool
-Pl_Fd_Remove_Value(WamWord *fdv_adr, int n)
+Pl_Fd_Remove_Value(WamWord *fdv_adr, PlLong n)
 {
   Pl_Fd_Before_Add_Cstr();
 
@@ -1567,7 +1905,7 @@ Pl_Fd_Use_Vector(WamWord *fdv_adr)
 {
   Range range;
 
-  if (Is_Sparse(Range(fdv_adr)))
+  if (Is_Vector(Range(fdv_adr)))
     return TRUE;
 
   Pl_Fd_Before_Add_Cstr();
@@ -1660,8 +1998,10 @@ Pl_Fd_Variable_Size0(WamWord *fdv_adr)
 {
   int size = FD_VARIABLE_FRAME_SIZE;
 
-  if (Is_Sparse(Range(fdv_adr)))
-      size += pl_vec_size;
+  if (Is_IList(Range(fdv_adr)))
+    size += IList_Size(IList_Nb_Interv(IList_Of(Range(fdv_adr))));
+  else if (Is_Sparse(Range(fdv_adr)))
+    size += pl_vec_size;
 
   return size;
 }
@@ -1720,3 +2060,171 @@ Pl_Fd_Display_Extra_Cstr(WamWord *fdv_adr)
   Pl_Stream_Printf(pl_stm_tbl[pl_stm_stdout], MSG_VECTOR_TOO_SMALL,
 		   Cstr_Offset(fdv_adr));
 }
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_CSTR_TYPE                                                         *
+ *                                                                         *
+ * Returns the index of a constraint type in pl_fd_cstr_type[] (created if *
+ * needed). name must be a permanent string (e.g. a literal).              *
+ *-------------------------------------------------------------------------*/
+int
+Pl_Fd_Cstr_Type(char *name)
+{
+  FdCstrType *t;
+  int i;
+
+  for (i = 0; i < pl_fd_nb_cstr_type; i++)
+    if (strcmp(pl_fd_cstr_type[i].name, name) == 0)
+      return i;
+
+  if (pl_fd_nb_cstr_type == cstr_type_size)
+    {
+      cstr_type_size = (cstr_type_size == 0) ? 64 : cstr_type_size * 2;
+      pl_fd_cstr_type = (FdCstrType *)
+	Realloc(pl_fd_cstr_type, cstr_type_size * sizeof(FdCstrType));
+    }
+
+  t = pl_fd_cstr_type + pl_fd_nb_cstr_type;
+  t->name = name;
+  t->nb_post = t->nb_propag = t->nb_fail = t->nb_reduc = 0;
+
+  return pl_fd_nb_cstr_type++;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_RESET_STATISTICS                                                  *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Reset_Statistics(void)
+{
+  FdCstrType *t;
+  int i;
+
+  for (i = 0, t = pl_fd_cstr_type; i < pl_fd_nb_cstr_type; i++, t++)
+    t->nb_post = t->nb_propag = t->nb_fail = t->nb_reduc = 0;
+
+  pl_fd_nb_var = 0;
+  pl_fd_nb_bckt = 0;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_TRACE_EVENT                                                       *
+ *                                                                         *
+ * Records an event in the ring buffer (only called if the trace is on,   *
+ * see Fd_Trace). obj is a constraint frame or an FD var (or NULL).        *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Trace_Event(int event, int type, WamWord *obj, PlLong value)
+{
+  FdTraceRec *rec = trace_buff + (int) (trace_nb_event++ % trace_buff_size);
+
+  rec->event = (uint16_t) event;
+  rec->type = (uint16_t) type;
+  rec->obj = (obj) ? (uint32_t) Cstr_Offset(obj) : 0;
+  rec->value = (uint64_t) value;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_TRACE_START                                                       *
+ *                                                                         *
+ * Starts a new trace in a ring buffer of size records.                    *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Trace_Start(int size)
+{
+  if (size != trace_buff_size)
+    {
+      Free(trace_buff);
+      trace_buff = (FdTraceRec *) Malloc(size * sizeof(FdTraceRec));
+      trace_buff_size = size;
+    }
+
+  trace_nb_event = 0;
+  pl_fd_trace_size = size;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_TRACE_STOP                                                        *
+ *                                                                         *
+ * Stops the trace (the buffer is kept for Pl_Fd_Trace_Dump).              *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Trace_Stop(void)
+{
+  pl_fd_trace_size = 0;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_TRACE_DUMP                                                        *
+ *                                                                         *
+ * Writes the trace in a binary file (see fd_trace.h). Returns -1 on error *
+ * (errno is set).                                                         *
+ *-------------------------------------------------------------------------*/
+int
+Pl_Fd_Trace_Dump(char *path)
+{
+  FILE *f;
+  FdTraceHeader h;
+  uint32_t len;
+  int start, nb, i;
+  int ok;
+
+  if ((f = fopen(path, "wb")) == NULL)
+    return -1;
+
+  if (trace_nb_event <= (uint64_t) trace_buff_size)
+    {
+      nb = (int) trace_nb_event;
+      start = 0;
+    }
+  else				/* the buffer has wrapped around */
+    {
+      nb = trace_buff_size;
+      start = (int) (trace_nb_event % trace_buff_size);
+    }
+
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, FD_TRACE_MAGIC, sizeof(h.magic));
+  h.rec_size = sizeof(FdTraceRec);
+  h.nb_type = pl_fd_nb_cstr_type;
+  h.nb_rec = nb;
+  h.buff_size = trace_buff_size;
+  h.nb_event = trace_nb_event;
+
+  ok = fwrite(&h, sizeof(h), 1, f) == 1;
+
+  for (i = 0; ok && i < pl_fd_nb_cstr_type; i++)
+    {
+      len = (uint32_t) strlen(pl_fd_cstr_type[i].name);
+      ok = fwrite(&len, sizeof(len), 1, f) == 1 &&
+	fwrite(pl_fd_cstr_type[i].name, 1, len, f) == len;
+    }
+
+  if (ok && nb > 0)		/* oldest records: from start to the end */
+    ok = fwrite(trace_buff + start, sizeof(FdTraceRec), nb - start, f) == (size_t) (nb - start) &&
+      fwrite(trace_buff, sizeof(FdTraceRec), start, f) == (size_t) start;
+
+  if (fclose(f) != 0)
+    ok = FALSE;
+
+  return (ok) ? 0 : -1;
+}
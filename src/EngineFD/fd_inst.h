@@ -45,7 +45,7 @@
 #define FD_VARIABLE_FRAME_SIZE     (OFFSET_RANGE + RANGE_SIZE + CHAINS_SIZE)
 #define FD_INT_VARIABLE_FRAME_SIZE (OFFSET_RANGE + RANGE_SIZE)
 
-#define OFFSET_RANGE               4
+#define OFFSET_RANGE               7
 #define RANGE_SIZE                 (2 + (sizeof(Range) / sizeof(WamWord)))
 
 #define OFFSET_CHAINS              (OFFSET_RANGE + RANGE_SIZE)
@@ -58,6 +58,10 @@
 
 #define Queue_Propag_Mask(fdv_adr) (((WamWord *)  fdv_adr)[2])
 #define Queue_Next_Fdv_Adr(fdv_adr)(((WamWord **) fdv_adr)[3])
+#define Queue_Origin(fdv_adr)      (((WamWord **) fdv_adr)[4])
+
+#define Fdv_Activity(fdv_adr)      (*(float *) &(((WamWord *) fdv_adr)[5]))
+#define Fdv_Impact(fdv_adr)        (*(float *) &(((WamWord *) fdv_adr)[6]))
 
 #define Range_Stamp(fdv_adr)       (((WamWord *)  fdv_adr)[OFFSET_RANGE])
 #define Nb_Elem(fdv_adr)           (((WamWord *)  fdv_adr)[OFFSET_RANGE + 1])
@@ -81,6 +85,8 @@
 #define Is_Var_In_Queue(fdv_adr)   (Queue_Propag_Mask(fdv_adr) != 0) /* mask = 0 <=> not in the queue */
 #define Del_Var_From_Queue(fdv_adr)(Queue_Propag_Mask(fdv_adr) = 0)
 
+#define QUEUE_ORIGIN_NONE          ((WamWord *) 1) /* no event recorded yet */
+
 
 
 
@@ -141,13 +147,67 @@
 
 typedef PlLong (*CstrFct) (WamWord *af);
 
-#define CONSTRAINT_FRAME_SIZE      3
+#define CONSTRAINT_FRAME_SIZE      8
 
 #define OFFSET_OF_OPTIM_POINTER    1	/* this offset must correspond to >>> */
 
 #define AF_Pointer(cf)             (*(WamWord **)    &(cf[0]))
 #define Optim_Pointer(cf)          (*(PlULong **)    &(cf[1]))	/* >>> this cell */
 #define Cstr_Address(cf)           (*(CstrFct *) &(cf[2]))
+#define Cstr_Prio_Info(cf)         (cf[3])
+#define Cstr_Next_In_Queue(cf)     (*(WamWord **)    &(cf[4]))	/* NULL: not in queue */
+#define Cstr_Nb_Wakeups(cf)        (*(PlULong *)     &(cf[5]))
+#define Cstr_Weight(cf)            (*(PlULong *)     &(cf[6]))	/* nb of failures + 1 */
+#define Cstr_Type(cf)              (cf[7])	/* index in pl_fd_cstr_type[] */
+
+#define Cstr_Priority(cf)          ((int) (Cstr_Prio_Info(cf) & FD_PRIO_MASK))
+#define Cstr_Is_Idempotent(cf)     ((Cstr_Prio_Info(cf) & FD_CSTR_IDEMPOTENT) != 0)
+
+
+
+
+	  /* Constraint Priorities (cost classes) */
+
+#define FD_PRIO_CHEAP              0 /* run as soon as a variable changes */
+#define FD_PRIO_LINEAR             1 /* queued, run when cheap ones are done */
+#define FD_PRIO_EXPENSIVE          2 /* queued, run when all others are done */
+
+#define FD_NB_PRIO                 3
+#define FD_PRIO_MASK               3
+
+#define FD_CSTR_IDEMPOTENT         4 /* not woken by its own modifications */
+
+
+
+
+	  /* Statistics and trace (see fd_statistics/2 and fd_trace_start/1) */
+
+#define FD_CSTR_TYPE_OTHER         0 /* not in a constraint (e.g. labeling) */
+
+
+	/* records the type of the constraint being posted (name is the    */
+	/* name of the user constraint or of the C constraint)             */
+
+#define Fd_Cstr_Type(name)					\
+  do								\
+    {								\
+      static int type_of_##name = -1;				\
+								\
+      if (type_of_##name < 0)					\
+	type_of_##name = Pl_Fd_Cstr_Type(#name);		\
+      pl_fd_cur_cstr_type = type_of_##name;			\
+      pl_fd_cstr_type[type_of_##name].nb_post++;		\
+    }								\
+  while (0)
+
+
+#define Fd_Trace(event, type, obj, value)			\
+  do								\
+    {								\
+      if (pl_fd_trace_size)					\
+	Pl_Fd_Trace_Event(event, type, obj, value);		\
+    }								\
+  while (0)
 
 
 
@@ -164,6 +224,23 @@ typedef PlLong (*CstrFct) (WamWord *af);
 
 
 
+#define FD_Word_Needs_Trailing(adr)  ((adr) <  CSB(B))
+
+
+
+
+#define FD_Bind_OV(adr, word)       		\
+  do						\
+    {						\
+      if (FD_Word_Needs_Trailing(adr))		\
+	Trail_OV(adr);				\
+      *(adr) = (word);				\
+    }						\
+  while (0)
+
+
+
+
 #define math_min(x, y)             ((x) <= (y) ? (x) : (y))
 #define math_max(x, y)             ((x) >= (y) ? (x) : (y))
 
@@ -174,6 +251,19 @@ typedef PlLong (*CstrFct) (WamWord *af);
  * Type Definitions                *
  *---------------------------------*/
 
+typedef struct			/* statistics of a constraint type */
+{
+  char *name;
+  PlULong nb_post;		/* number of constraints posted */
+  PlULong nb_propag;		/* number of executions */
+  PlULong nb_fail;		/* number of failures */
+  PlULong nb_reduc;		/* number of domain reductions */
+}
+FdCstrType;
+
+
+
+
 /*---------------------------------*
  * Global Variables                *
  *---------------------------------*/
@@ -183,11 +273,37 @@ typedef PlLong (*CstrFct) (WamWord *af);
 int pl_vec_size;
 int pl_vec_max_integer;
 
+PlULong pl_fd_nb_wakeups[FD_NB_PRIO];
+
+float pl_fd_activity_inc = 1.0;
+
+FdCstrType *pl_fd_cstr_type;
+int pl_fd_nb_cstr_type;
+int pl_fd_cur_cstr_type;
+
+PlULong pl_fd_nb_var;
+PlULong pl_fd_nb_bckt;
+
+int pl_fd_trace_size;		/* 0: no trace */
+
 #else
 
 extern int pl_vec_size;
 extern int pl_vec_max_integer;
 
+extern PlULong pl_fd_nb_wakeups[];
+
+extern float pl_fd_activity_inc;
+
+extern FdCstrType *pl_fd_cstr_type;
+extern int pl_fd_nb_cstr_type;
+extern int pl_fd_cur_cstr_type;
+
+extern PlULong pl_fd_nb_var;
+extern PlULong pl_fd_nb_bckt;
+
+extern int pl_fd_trace_size;
+
 #endif
 
 
@@ -201,7 +317,7 @@ WamWord *Pl_Fd_Prolog_To_Fd_Var(WamWord arg_word, Bool pl_var_ok);
 
 Range *Pl_Fd_Prolog_To_Range(WamWord list_word);
 
-int Pl_Fd_Prolog_To_Value(WamWord arg_word);
+PlLong Pl_Fd_Prolog_To_Value(WamWord arg_word);
 
 WamWord *Pl_Fd_Prolog_To_Array_Int(WamWord list_word);
 
@@ -211,15 +327,16 @@ WamWord *Pl_Fd_Prolog_To_Array_Fdv(WamWord list_word, Bool pl_var_ok);
 
 void Pl_Fd_List_Int_To_Range(Range *range, WamWord list_word);
 
-WamWord *Pl_Fd_New_Variable_Interval(int min, int max);
+WamWord *Pl_Fd_New_Variable_Interval(PlLong min, PlLong max);
 
 WamWord *Pl_Fd_New_Variable(void);
 
 WamWord *Pl_Fd_New_Variable_Range(Range *r);
 
-WamWord *Pl_Fd_New_Int_Variable(int n);
+WamWord *Pl_Fd_New_Int_Variable(PlLong n);
 
-WamWord *Pl_Fd_Create_C_Frame(CstrFct cstr_fct, WamWord *AF, WamWord *fdv_adr, Bool optim2);
+WamWord *Pl_Fd_Create_C_Frame(CstrFct cstr_fct, WamWord *AF, WamWord *fdv_adr, Bool optim2,
+			      int prio_info);
 
 void Pl_Fd_Add_Dependency(WamWord *fdv_adr, int chain_nb, WamWord *CF);
 
@@ -233,43 +350,61 @@ Bool Pl_Fd_After_Add_Cstr(Bool result_of_tell);
 
 void Pl_Fd_Stop_Constraint(WamWord *CF);
 
+int Pl_Fd_Push_Bound(WamWord *fdv_adr, PlLong min, PlLong max);
+
+void Pl_Fd_Pop_Bound(void);
+
+void Pl_Fd_Set_Bound(PlLong min, PlLong max);
+
 
 
-Bool Pl_Fd_Tell_Value(WamWord *fdv_adr, int n);
+Bool Pl_Fd_Tell_Value(WamWord *fdv_adr, PlLong n);
 
-Bool Pl_Fd_Tell_Not_Value(WamWord *fdv_adr, int n);
+Bool Pl_Fd_Tell_Not_Value(WamWord *fdv_adr, PlLong n);
 
 Bool Pl_Fd_Tell_Int_Range(WamWord *fdv_adr, Range *range);
 
-Bool Pl_Fd_Tell_Interv_Interv(WamWord *fdv_adr, int min, int max);
+Bool Pl_Fd_Tell_Interv_Interv(WamWord *fdv_adr, PlLong min, PlLong max);
 
 Bool Pl_Fd_Tell_Range_Range(WamWord *fdv_adr, Range *range);
 
-Bool Pl_Fd_Tell_Interval(WamWord *fdv_adr, int min, int max);
+Bool Pl_Fd_Tell_Interval(WamWord *fdv_adr, PlLong min, PlLong max);
 
 Bool Pl_Fd_Tell_Range(WamWord *fdv_adr, Range *range);
 
 void Pl_Fd_Display_Extra_Cstr(WamWord *fdv_adr);
 
+int Pl_Fd_Cstr_Type(char *name);
+
+void Pl_Fd_Reset_Statistics(void);
+
+void Pl_Fd_Trace_Event(int event, int type, WamWord *obj, PlLong value);
+
+void Pl_Fd_Trace_Start(int size);
+
+void Pl_Fd_Trace_Stop(void);
+
+int Pl_Fd_Trace_Dump(char *path);
+
 
 
 void Pl_Fd_Init_Solver0(void);
 
 void Pl_Fd_Reset_Solver0(void);
 
-Bool Pl_Fd_In_Interval(WamWord *fdv_adr, int min, int max);
+Bool Pl_Fd_In_Interval(WamWord *fdv_adr, PlLong min, PlLong max);
 
 Bool Pl_Fd_In_Range(WamWord *fdv_adr, Range *range);
 
-Bool Pl_Fd_Assign_Value_Fast(WamWord *fdv_adr, int n);
+Bool Pl_Fd_Assign_Value_Fast(WamWord *fdv_adr, PlLong n);
 
 #define Pl_Fd_Assign_Value(fdv, n) Pl_Fd_Unify_With_Integer0(fdv, n)
 
-Bool Pl_Fd_Unify_With_Integer0(WamWord *fdv_adr, int n);
+Bool Pl_Fd_Unify_With_Integer0(WamWord *fdv_adr, PlLong n);
 
 Bool Pl_Fd_Unify_With_Fd_Var0(WamWord *fdv_adr1, WamWord *fdv_adr2);
 
-Bool Pl_Fd_Remove_Value(WamWord *fdv_adr, int n);
+Bool Pl_Fd_Remove_Value(WamWord *fdv_adr, PlLong n);
 
 Bool Pl_Fd_Use_Vector(WamWord *fdv_adr);
 
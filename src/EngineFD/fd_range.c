@@ -38,6 +38,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
 
 #include "bool.h"
 
@@ -89,6 +90,19 @@
 #define WRITE_LIMITS_SEPARATOR     ".."
 #define WRITE_INTERVALS_SEPARATOR  ":"
 #define WRITE_EXTRA_CSTR_SYMBOL    "@"
+#define WRITE_TRUNCATED_SYMBOL     "..."
+
+#define ILIST_VECTOR_MAX_SIZE      32 /* prefer vectors up to this size */
+#define ILIST_MAX_ADD_PAIRS        1024
+
+#define VECTOR_SIMD_MIN_SIZE       4  /* use AVX2 from this size (in words) */
+
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+    (__GNUC__ >= 5 || defined(__clang__))
+#define VECTOR_X86_KERNELS
+#include <immintrin.h>
+#endif
 
 
 
@@ -105,6 +119,57 @@
  * Function Prototypes             *
  *---------------------------------*/
 
+static void Vector_Shift(Vector vec, Vector vec1, PlLong n, Bool union_it);
+
+#ifdef VECTOR_X86_KERNELS
+
+static int Vector_Nb_Elem_Popcnt(Vector vec);
+
+static int Vector_Ith_Elem_Popcnt(Vector vec, int i);
+
+static Bool Vector_Test_Null_Inter_Avx2(Vector vec, Vector vec1);
+
+static void Vector_Copy_Avx2(Vector vec, Vector vec1);
+
+static void Vector_Union_Avx2(Vector vec, Vector vec1);
+
+static void Vector_Inter_Avx2(Vector vec, Vector vec1);
+
+static void Vector_Compl_Avx2(Vector vec);
+
+#define Use_Popcnt        (pl_vec_kernel >= VEC_KERNEL_POPCNT)
+
+#define Use_Avx2          (pl_vec_kernel == VEC_KERNEL_AVX2 && \
+                           pl_vec_size >= VECTOR_SIMD_MIN_SIZE)
+
+#endif
+
+static Bool Vector_Preferred(PlLong min, PlLong max);
+
+static void IList_Push(PlLong *il, PlLong min, PlLong max);
+
+static PlLong *IList_From_Vector(Vector vec);
+
+static PlLong *IList_View(Range *range, PlLong *buff);
+
+static void IList_To_Range(Range *range, PlLong *il);
+
+static int IList_Search(PlLong *il, PlLong n);
+
+static int IList_Cmp_Interv(const void *p1, const void *p2);
+
+static void IList_Union(Range *range, Range *range1);
+
+static void IList_Inter(Range *range, Range *range1);
+
+static void IList_Compl(Range *range);
+
+static void IList_Reset_Value(Range *range, PlLong n);
+
+static void IList_Add_Value(Range *range, PlLong n);
+
+static void IList_Add_Range(Range *range, Range *range1, Bool sub);
+
 
 
 
@@ -127,6 +192,34 @@ Pl_Define_Vector_Size(int max_val)
 {
   pl_vec_size = max_val / WORD_SIZE + 1;
   pl_vec_max_integer = pl_vec_size * WORD_SIZE - 1;
+
+  if (pl_vec_kernel == VEC_KERNEL_UNDEFINED)
+    pl_vec_kernel = Pl_Vector_Best_Kernel();
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_VECTOR_BEST_KERNEL                                                   *
+ *                                                                         *
+ * Returns the best vector kernel supported by the running CPU. The        *
+ * portable kernel is always available (pl_vec_kernel can be lowered).     *
+ *-------------------------------------------------------------------------*/
+int
+Pl_Vector_Best_Kernel(void)
+{
+#ifdef VECTOR_X86_KERNELS
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+    return VEC_KERNEL_AVX2;
+
+  if (__builtin_cpu_supports("popcnt"))
+    return VEC_KERNEL_POPCNT;
+#endif
+
+  return VEC_KERNEL_PORTABLE;
 }
 
 
@@ -137,7 +230,7 @@ Pl_Define_Vector_Size(int max_val)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 void
-Pl_Vector_From_Interval(Vector vec, int min, int max)
+Pl_Vector_From_Interval(Vector vec, PlLong min, PlLong max)
 {
   Vector w_min = vec + Word_No(min);
   Vector w_max = vec + Word_No(max);
@@ -178,6 +271,11 @@ Pl_Vector_Nb_Elem(Vector vec)
   register Vector end = vec + pl_vec_size;
   register int nb_elem = 0;
 
+#ifdef VECTOR_X86_KERNELS
+  if (Use_Popcnt)
+    return Vector_Nb_Elem_Popcnt(vec);
+#endif
+
   do
     {
       nb_elem += Pl_Count_Set_Bits(*vec);
@@ -198,16 +296,32 @@ Pl_Vector_Nb_Elem(Vector vec)
 int
 Pl_Vector_Ith_Elem(Vector vec, int i)
 {
-  int vec_elem;
+  Vector end = vec + pl_vec_size;
+  Vector start = vec;
+  VecWord word;
+  int nb;
 
-  if (i > 0)			/* 1 <= i  <= nb_elem */
-    {
-      VECTOR_BEGIN_ENUM(vec, vec_elem);
+  if (i <= 0)			/* 1 <= i  <= nb_elem */
+    return -1;
 
-      if (--i == 0)
-	return vec_elem;
+#ifdef VECTOR_X86_KERNELS
+  if (Use_Popcnt)
+    return Vector_Ith_Elem_Popcnt(vec, i);
+#endif
 
-      VECTOR_END_ENUM;
+  for (; start < end; start++)	/* skip whole words */
+    {
+      word = *start;
+      nb = Pl_Count_Set_Bits(word);
+      if (i <= nb)
+	{
+	  while (--i)		/* drop the i-1 least significant bits */
+	    word &= word - 1;
+
+	  return Word_No_And_Bit_No(start - vec,
+				    Pl_Least_Significant_Bit(word));
+	}
+      i -= nb;
     }
 
   return -1;
@@ -221,7 +335,7 @@ Pl_Vector_Ith_Elem(Vector vec, int i)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 int
-Pl_Vector_Next_After(Vector vec, int n)
+Pl_Vector_Next_After(Vector vec, PlLong n)
 {
   int word_no;
   int bit_no;
@@ -260,9 +374,8 @@ Pl_Vector_Next_After(Vector vec, int n)
     }
 
   bit = Pl_Least_Significant_Bit(word);
-  n = Word_No_And_Bit_No(start - vec, bit);
 
-  return n;
+  return Word_No_And_Bit_No(start - vec, bit);
 }
 
 
@@ -273,7 +386,7 @@ Pl_Vector_Next_After(Vector vec, int n)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 int
-Pl_Vector_Next_Before(Vector vec, int n)
+Pl_Vector_Next_Before(Vector vec, PlLong n)
 {
   int word_no;
   int bit_no;
@@ -312,9 +425,8 @@ Pl_Vector_Next_Before(Vector vec, int n)
     }
 
   bit = Pl_Most_Significant_Bit(word);
-  n = Word_No_And_Bit_No(end - vec, bit);
 
-  return n;
+  return Word_No_And_Bit_No(end - vec, bit);
 }
 
 
@@ -363,6 +475,11 @@ Pl_Vector_Test_Null_Inter(Vector vec, Vector vec1)
 {
   Vector end = vec + pl_vec_size;
 
+#ifdef VECTOR_X86_KERNELS
+  if (Use_Avx2)
+    return Vector_Test_Null_Inter_Avx2(vec, vec1);
+#endif
+
   do
     if (*vec++ & *vec1++)
       return FALSE;
@@ -382,6 +499,14 @@ Pl_Vector_Copy(Vector vec, Vector vec1)
 {
   Vector end = vec + pl_vec_size;
 
+#ifdef VECTOR_X86_KERNELS
+  if (Use_Avx2)
+    {
+      Vector_Copy_Avx2(vec, vec1);
+      return;
+    }
+#endif
+
   do
     *vec++ = *vec1++;
   while (vec < end);
@@ -399,6 +524,14 @@ Pl_Vector_Union(Vector vec, Vector vec1)
 {
   Vector end = vec + pl_vec_size;
 
+#ifdef VECTOR_X86_KERNELS
+  if (Use_Avx2)
+    {
+      Vector_Union_Avx2(vec, vec1);
+      return;
+    }
+#endif
+
   do
     *vec++ |= *vec1++;
   while (vec < end);
@@ -416,6 +549,14 @@ Pl_Vector_Inter(Vector vec, Vector vec1)
 {
   Vector end = vec + pl_vec_size;
 
+#ifdef VECTOR_X86_KERNELS
+  if (Use_Avx2)
+    {
+      Vector_Inter_Avx2(vec, vec1);
+      return;
+    }
+#endif
+
   do
     *vec++ &= *vec1++;
   while (vec < end);
@@ -433,6 +574,14 @@ Pl_Vector_Compl(Vector vec)
 {
   Vector end = vec + pl_vec_size;
 
+#ifdef VECTOR_X86_KERNELS
+  if (Use_Avx2)
+    {
+      Vector_Compl_Avx2(vec);
+      return;
+    }
+#endif
+
   do
     *vec = ~(*vec), vec++;
   while (vec < end);
@@ -449,27 +598,17 @@ void
 Pl_Vector_Add_Vector(Vector vec, Vector vec1)
 {
   Vector aux_vec;
-  int vec_elem, vec_elem1;
-  int x;
+  int vec_elem1;
 
   Vector_Allocate(aux_vec);
   Pl_Vector_Copy(aux_vec, vec);
   Pl_Vector_Empty(vec);
 
-  VECTOR_BEGIN_ENUM(aux_vec, vec_elem);
+  /* vec = union of (aux_vec + e) for each e in vec1 (word shifts) */
 
   VECTOR_BEGIN_ENUM(vec1, vec_elem1);
 
-  x = vec_elem + vec_elem1;
-
-  if (x > pl_vec_max_integer)
-    goto loop1;
-
-  Vector_Set_Value(vec, x);
-
-  VECTOR_END_ENUM;
-
-loop1:;
+  Vector_Shift(vec, aux_vec, vec_elem1, TRUE);
 
   VECTOR_END_ENUM;
 }
@@ -485,26 +624,17 @@ void
 Pl_Vector_Sub_Vector(Vector vec, Vector vec1)
 {
   Vector aux_vec;
-  int vec_elem, vec_elem1;
-  int x;
+  int vec_elem1;
 
   Vector_Allocate(aux_vec);
   Pl_Vector_Copy(aux_vec, vec);
   Pl_Vector_Empty(vec);
 
-  VECTOR_BEGIN_ENUM(aux_vec, vec_elem);
+  /* vec = union of (aux_vec - e) for each e in vec1 (word shifts) */
 
   VECTOR_BEGIN_ENUM(vec1, vec_elem1);
 
-  x = vec_elem - vec_elem1;
-
-  if (x < 0)
-    goto loop1;
-
-  Vector_Set_Value(vec, x);
-  VECTOR_END_ENUM;
-
-loop1:;
+  Vector_Shift(vec, aux_vec, -vec_elem1, TRUE);
 
   VECTOR_END_ENUM;
 }
@@ -521,7 +651,7 @@ Pl_Vector_Mul_Vector(Vector vec, Vector vec1)
 {
   Vector aux_vec;
   int vec_elem, vec_elem1;
-  int x;
+  PlLong x;
 
   Vector_Allocate(aux_vec);
   Pl_Vector_Copy(aux_vec, vec);
@@ -531,7 +661,7 @@ Pl_Vector_Mul_Vector(Vector vec, Vector vec1)
 
   VECTOR_BEGIN_ENUM(vec1, vec_elem1);
 
-  x = vec_elem * vec_elem1;
+  x = (PlLong) vec_elem * vec_elem1;
 
   if (x > pl_vec_max_integer)
     goto loop1;
@@ -625,161 +755,798 @@ Pl_Vector_Mod_Vector(Vector vec, Vector vec1)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 void
-Pl_Vector_Add_Value(Vector vec, int n)
+Pl_Vector_Add_Value(Vector vec, PlLong n)
+{
+  Vector_Shift(vec, vec, n, FALSE);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * VECTOR_SHIFT                                                            *
+ *                                                                         *
+ * Stores (union_it = FALSE) or adds (union_it = TRUE) in vec the vector   *
+ * vec1 shifted by n bits (to the left if n >= 0, else to the right). Each *
+ * destination word combines two source words, so vec and vec1 can be the  *
+ * same vector when union_it is FALSE.                                     *
+ *-------------------------------------------------------------------------*/
+static void
+Vector_Shift(Vector vec, Vector vec1, PlLong n, Bool union_it)
 {
   int word_no;
   int bit_no;
-  VecWord rem, rem1;
+  VecWord word;
   int i, j;
 
   if (n >= 0)
     {
-      word_no = Word_No(n);
+      word_no = (n > pl_vec_max_integer) ? pl_vec_size : (int) Word_No(n);
       bit_no = Bit_No(n);
 
-      if (word_no)
+      for (i = pl_vec_size - 1; i >= word_no; i--)
 	{
-	  i = pl_vec_size - 1;
-	  j = pl_vec_size - 1 - word_no;
+	  j = i - word_no;
+	  word = vec1[j] << bit_no;
+	  if (bit_no && j > 0)
+	    word |= vec1[j - 1] >> (WORD_SIZE - bit_no);
+
+	  if (union_it)
+	    vec[i] |= word;
+	  else
+	    vec[i] = word;
+	}
+
+      if (!union_it)
+	for (; i >= 0; i--)
+	  vec[i] = 0;
+    }
+  else
+    {
+      n = -n;
+      word_no = (n > pl_vec_max_integer) ? pl_vec_size : (int) Word_No(n);
+      bit_no = Bit_No(n);
 
-	  while (j >= 0)
-	    vec[i--] = vec[j--];
+      for (i = 0; i < pl_vec_size - word_no; i++)
+	{
+	  j = i + word_no;
+	  word = vec1[j] >> bit_no;
+	  if (bit_no && j < pl_vec_size - 1)
+	    word |= vec1[j + 1] << (WORD_SIZE - bit_no);
 
-	  while (i >= 0)
-	    vec[i--] = 0;
+	  if (union_it)
+	    vec[i] |= word;
+	  else
+	    vec[i] = word;
 	}
 
-      if (bit_no)
+      if (!union_it)
+	for (; i < pl_vec_size; i++)
+	  vec[i] = 0;
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_VECTOR_MUL_VALUE                                                     *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Vector_Mul_Value(Vector vec, PlLong n)
+{
+  Vector aux_vec;
+  int vec_elem;
+
+  Vector_Allocate(aux_vec);
+  Pl_Vector_Copy(aux_vec, vec);
+  Pl_Vector_Empty(vec);
+
+  VECTOR_BEGIN_ENUM(aux_vec, vec_elem);
+
+  if (vec_elem != 0 &&		/* n < 0 or vec_elem * n > max */
+      (PlULong) n > (PlULong) (pl_vec_max_integer / vec_elem))
+    return;
+
+  Vector_Set_Value(vec, vec_elem * n);
+
+  VECTOR_END_ENUM;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_VECTOR_DIV_VALUE                                                     *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Vector_Div_Value(Vector vec, PlLong n)
+{
+  Vector aux_vec;
+  int vec_elem;
+  PlLong x;
+
+  Vector_Allocate(aux_vec);
+  Pl_Vector_Copy(aux_vec, vec);
+  Pl_Vector_Empty(vec);
+
+  if (n == 0)
+    return;
+
+  VECTOR_BEGIN_ENUM(aux_vec, vec_elem);
+
+  if (vec_elem % n == 0)
+    {
+      x = vec_elem / n;
+      Vector_Set_Value(vec, x);
+    }
+
+  VECTOR_END_ENUM;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_VECTOR_MOD_VALUE                                                     *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Vector_Mod_Value(Vector vec, PlLong n)
+{
+  Vector aux_vec;
+  int vec_elem;
+  PlLong x;
+
+  Vector_Allocate(aux_vec);
+  Pl_Vector_Copy(aux_vec, vec);
+  Pl_Vector_Empty(vec);
+
+  if (n == 0)
+    return;
+
+  VECTOR_BEGIN_ENUM(aux_vec, vec_elem);
+
+  x = vec_elem % n;
+  if ((PlULong) x <= (PlULong) pl_vec_max_integer)
+    Vector_Set_Value(vec, x);
+
+  VECTOR_END_ENUM;
+}
+
+
+
+
+#ifdef VECTOR_X86_KERNELS
+
+/*-------------------------------------------------------------------------*
+ * x86 vector kernels (selected at run-time, see Pl_Vector_Best_Kernel)    *
+ *                                                                         *
+ * AVX2 kernels process 32 bytes at a time then finish word by word. They  *
+ * are only used from VECTOR_SIMD_MIN_SIZE words.                          *
+ *-------------------------------------------------------------------------*/
+
+#define AVX2_NB_WORDS              (32 / (int) sizeof(VecWord))
+
+#define Popcount(w)                __builtin_popcountll((unsigned long long) (w))
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * VECTOR_NB_ELEM_POPCNT                                                   *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+__attribute__((target("popcnt")))
+static int
+Vector_Nb_Elem_Popcnt(Vector vec)
+{
+  Vector end = vec + pl_vec_size;
+  int nb_elem = 0;
+
+  do
+    nb_elem += Popcount(*vec++);
+  while (vec < end);
+
+  return nb_elem;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * VECTOR_ITH_ELEM_POPCNT                                                  *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+__attribute__((target("popcnt")))
+static int
+Vector_Ith_Elem_Popcnt(Vector vec, int i)
+{
+  Vector end = vec + pl_vec_size;
+  Vector start;
+  VecWord word;
+  int nb;
+
+  for (start = vec; start < end; start++)
+    {
+      word = *start;
+      nb = Popcount(word);
+      if (i <= nb)
 	{
-	  rem = 0;
-	  for (i = word_no; i < pl_vec_size; i++)
-	    {
-	      rem1 = vec[i] >> (WORD_SIZE - bit_no);
-	      vec[i] = (vec[i] << bit_no) | rem;
-	      rem = rem1;
-	    }
+	  while (--i)
+	    word &= word - 1;
+
+	  return Word_No_And_Bit_No(start - vec,
+				    Pl_Least_Significant_Bit(word));
 	}
+      i -= nb;
     }
-  else
+
+  return -1;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * VECTOR_TEST_NULL_INTER_AVX2                                             *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+__attribute__((target("avx2")))
+static Bool
+Vector_Test_Null_Inter_Avx2(Vector vec, Vector vec1)
+{
+  Vector end = vec + pl_vec_size;
+  __m256i x, y;
+
+  for (; vec + AVX2_NB_WORDS <= end; vec += AVX2_NB_WORDS, vec1 += AVX2_NB_WORDS)
     {
-      word_no = Word_No(-n);
-      bit_no = Bit_No(-n);
+      x = _mm256_loadu_si256((__m256i *) vec);
+      y = _mm256_loadu_si256((__m256i *) vec1);
+      if (!_mm256_testz_si256(x, y))
+	return FALSE;
+    }
+
+  for (; vec < end; vec++, vec1++)
+    if (*vec & *vec1)
+      return FALSE;
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * VECTOR_COPY_AVX2                                                        *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+__attribute__((target("avx2")))
+static void
+Vector_Copy_Avx2(Vector vec, Vector vec1)
+{
+  Vector end = vec + pl_vec_size;
+
+  for (; vec + AVX2_NB_WORDS <= end; vec += AVX2_NB_WORDS, vec1 += AVX2_NB_WORDS)
+    _mm256_storeu_si256((__m256i *) vec,
+			_mm256_loadu_si256((__m256i *) vec1));
+
+  for (; vec < end; vec++, vec1++)
+    *vec = *vec1;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * VECTOR_UNION_AVX2                                                       *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+__attribute__((target("avx2")))
+static void
+Vector_Union_Avx2(Vector vec, Vector vec1)
+{
+  Vector end = vec + pl_vec_size;
+  __m256i x, y;
+
+  for (; vec + AVX2_NB_WORDS <= end; vec += AVX2_NB_WORDS, vec1 += AVX2_NB_WORDS)
+    {
+      x = _mm256_loadu_si256((__m256i *) vec);
+      y = _mm256_loadu_si256((__m256i *) vec1);
+      _mm256_storeu_si256((__m256i *) vec, _mm256_or_si256(x, y));
+    }
+
+  for (; vec < end; vec++, vec1++)
+    *vec |= *vec1;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * VECTOR_INTER_AVX2                                                       *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+__attribute__((target("avx2")))
+static void
+Vector_Inter_Avx2(Vector vec, Vector vec1)
+{
+  Vector end = vec + pl_vec_size;
+  __m256i x, y;
+
+  for (; vec + AVX2_NB_WORDS <= end; vec += AVX2_NB_WORDS, vec1 += AVX2_NB_WORDS)
+    {
+      x = _mm256_loadu_si256((__m256i *) vec);
+      y = _mm256_loadu_si256((__m256i *) vec1);
+      _mm256_storeu_si256((__m256i *) vec, _mm256_and_si256(x, y));
+    }
+
+  for (; vec < end; vec++, vec1++)
+    *vec &= *vec1;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * VECTOR_COMPL_AVX2                                                       *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+__attribute__((target("avx2")))
+static void
+Vector_Compl_Avx2(Vector vec)
+{
+  Vector end = vec + pl_vec_size;
+  __m256i ones = _mm256_set1_epi32(-1);
+  __m256i x;
+
+  for (; vec + AVX2_NB_WORDS <= end; vec += AVX2_NB_WORDS)
+    {
+      x = _mm256_loadu_si256((__m256i *) vec);
+      _mm256_storeu_si256((__m256i *) vec, _mm256_xor_si256(x, ones));
+    }
+
+  for (; vec < end; vec++)
+    *vec = ~(*vec);
+}
+
+#endif /* VECTOR_X86_KERNELS */
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * VECTOR_PREFERRED                                                        *
+ *                                                                         *
+ * A sparse range in min..max is a vector if it fits in a (small) vector,  *
+ * else it is an interval list.                                            *
+ *-------------------------------------------------------------------------*/
+static Bool
+Vector_Preferred(PlLong min, PlLong max)
+{
+  return min >= 0 && max <= pl_vec_max_integer &&
+    pl_vec_size <= ILIST_VECTOR_MAX_SIZE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_PUSH                                                              *
+ *                                                                         *
+ * Appends min..max to il (merged with the last interval if possible).     *
+ * Intervals must be pushed by increasing min.                             *
+ *-------------------------------------------------------------------------*/
+static void
+IList_Push(PlLong *il, PlLong min, PlLong max)
+{
+  PlLong nb = IList_Nb_Interv(il);
+
+  if (nb > 0 && min <= IList_Max(il, nb - 1) + 1)
+    {
+      if (max > IList_Max(il, nb - 1))
+	IList_Max(il, nb - 1) = max;
+      return;
+    }
+
+  IList_Min(il, nb) = min;
+  IList_Max(il, nb) = max;
+  IList_Nb_Interv(il) = nb + 1;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_FROM_VECTOR                                                       *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static PlLong *
+IList_From_Vector(Vector vec)
+{
+  PlLong *il = (PlLong *) RANGE_TOP_STACK;
+  int vec_elem;
+
+  IList_Nb_Interv(il) = 0;
+
+  VECTOR_BEGIN_ENUM(vec, vec_elem);
+
+  IList_Push(il, vec_elem, vec_elem);
+
+  VECTOR_END_ENUM;
+
+  RANGE_TOP_STACK += IList_Size(IList_Nb_Interv(il));
+
+  return il;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_VIEW                                                              *
+ *                                                                         *
+ * Returns the interval list of any range (buff is used for intervals, a   *
+ * vector is converted on the top of the stack).                           *
+ *-------------------------------------------------------------------------*/
+static PlLong *
+IList_View(Range *range, PlLong *buff)
+{
+  if (Is_Empty(range))
+    {
+      IList_Nb_Interv(buff) = 0;
+      return buff;
+    }
+
+  if (Is_Interval(range))
+    {
+      IList_Nb_Interv(buff) = 1;
+      IList_Min(buff, 0) = range->min;
+      IList_Max(buff, 0) = range->max;
+      return buff;
+    }
+
+  if (Is_IList(range))
+    return IList_Of(range);
+
+  return IList_From_Vector(range->vec);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_TO_RANGE                                                          *
+ *                                                                         *
+ * il has been built on the top of the stack. Chooses the representation  *
+ * of range (interval, vector or interval list).                           *
+ *-------------------------------------------------------------------------*/
+static void
+IList_To_Range(Range *range, PlLong *il)
+{
+  int nb = (int) IList_Nb_Interv(il);
+  int i;
+  PlLong j;
+
+  if (nb <= 1)
+    {
+      range->vec = NULL;
+      if (nb == 0)
+	Set_To_Empty(range);
+      else
+	{
+	  range->min = IList_Min(il, 0);
+	  range->max = IList_Max(il, 0);
+	}
+      return;
+    }
+
+  RANGE_TOP_STACK += IList_Size(nb);
+
+  range->min = IList_Min(il, 0);
+  range->max = IList_Max(il, nb - 1);
+
+  if (!Vector_Preferred(range->min, range->max))
+    {
+      Set_IList(range, il);
+      return;
+    }
+
+  Vector_Allocate(range->vec);
+  Pl_Vector_Empty(range->vec);
+  for (i = 0; i < nb; i++)
+    for (j = IList_Min(il, i); j <= IList_Max(il, i); j++)
+      Vector_Set_Value(range->vec, j);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_SEARCH                                                            *
+ *                                                                         *
+ * Returns the index of the first interval whose max >= n (or nb_interv). *
+ *-------------------------------------------------------------------------*/
+static int
+IList_Search(PlLong *il, PlLong n)
+{
+  int lo = 0;
+  int hi = (int) IList_Nb_Interv(il);
+  int mid;
+
+  while (lo < hi)
+    {
+      mid = (lo + hi) / 2;
+      if (IList_Max(il, mid) < n)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+
+  return lo;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_CMP_INTERV                                                        *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static int
+IList_Cmp_Interv(const void *p1, const void *p2)
+{
+  PlLong min1 = *(PlLong *) p1;
+  PlLong min2 = *(PlLong *) p2;
+
+  return (min1 > min2) - (min1 < min2);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_UNION                                                             *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+IList_Union(Range *range, Range *range1)
+{
+  PlLong buff[3], buff1[3];
+  PlLong *il, *il1, *res;
+  int nb, nb1, i, i1;
+  Bool extra_cstr = range->extra_cstr | range1->extra_cstr;
+
+  il = IList_View(range, buff);
+  il1 = IList_View(range1, buff1);
+  nb = IList_Nb_Interv(il);
+  nb1 = IList_Nb_Interv(il1);
+
+  res = (PlLong *) RANGE_TOP_STACK;
+  IList_Nb_Interv(res) = 0;
+
+  for (i = i1 = 0; i < nb || i1 < nb1;)
+    if (i1 >= nb1 || (i < nb && IList_Min(il, i) <= IList_Min(il1, i1)))
+      {
+	IList_Push(res, IList_Min(il, i), IList_Max(il, i));
+	i++;
+      }
+    else
+      {
+	IList_Push(res, IList_Min(il1, i1), IList_Max(il1, i1));
+	i1++;
+      }
+
+  IList_To_Range(range, res);
+  range->extra_cstr = extra_cstr;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_INTER                                                             *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+IList_Inter(Range *range, Range *range1)
+{
+  PlLong buff[3], buff1[3];
+  PlLong *il, *il1, *res;
+  int nb, nb1, i, i1;
+  PlLong min, max;
+  Bool extra_cstr = range->extra_cstr & range1->extra_cstr;
 
-      if (word_no)
-	{
-	  i = 0;
-	  j = word_no;
+  il = IList_View(range, buff);
+  il1 = IList_View(range1, buff1);
+  nb = IList_Nb_Interv(il);
+  nb1 = IList_Nb_Interv(il1);
 
-	  while (j < pl_vec_size)
-	    vec[i++] = vec[j++];
+  res = (PlLong *) RANGE_TOP_STACK;
+  IList_Nb_Interv(res) = 0;
 
-	  while (i < pl_vec_size)
-	    vec[i++] = 0;
-	}
+  for (i = i1 = 0; i < nb && i1 < nb1;)
+    {
+      min = math_max(IList_Min(il, i), IList_Min(il1, i1));
+      max = math_min(IList_Max(il, i), IList_Max(il1, i1));
+      if (min <= max)
+	IList_Push(res, min, max);
 
-      if (bit_no)
-	{
-	  rem = 0;
-	  for (i = pl_vec_size - 1 - word_no; i >= 0; i--)
-	    {
-	      rem1 = vec[i] << (WORD_SIZE - bit_no);
-	      vec[i] = (vec[i] >> bit_no) | rem;
-	      rem = rem1;
-	    }
-	}
+      if (IList_Max(il, i) < IList_Max(il1, i1))
+	i++;
+      else
+	i1++;
     }
+
+  IList_To_Range(range, res);
+  range->extra_cstr = extra_cstr;
 }
 
 
 
 
 /*-------------------------------------------------------------------------*
- * PL_VECTOR_MUL_VALUE                                                     *
+ * ILIST_COMPL                                                             *
  *                                                                         *
+ * Complement in 0..INTERVAL_MAX_INTEGER.                                  *
  *-------------------------------------------------------------------------*/
-void
-Pl_Vector_Mul_Value(Vector vec, int n)
+static void
+IList_Compl(Range *range)
 {
-  Vector aux_vec;
-  int vec_elem;
-  int x;
+  PlLong buff[3];
+  PlLong *il, *res;
+  int nb, i;
+  PlLong next = 0;
 
-  Vector_Allocate(aux_vec);
-  Pl_Vector_Copy(aux_vec, vec);
-  Pl_Vector_Empty(vec);
+  il = IList_View(range, buff);
+  nb = IList_Nb_Interv(il);
 
-  VECTOR_BEGIN_ENUM(aux_vec, vec_elem);
+  res = (PlLong *) RANGE_TOP_STACK;
+  IList_Nb_Interv(res) = 0;
 
-  x = vec_elem * n;
+  for (i = 0; i < nb; i++)
+    {
+      if (IList_Min(il, i) > next)
+	IList_Push(res, next, IList_Min(il, i) - 1);
 
-  if ((unsigned) x > (unsigned) pl_vec_max_integer)
-    return;
+      if (IList_Max(il, i) >= next)
+	next = IList_Max(il, i) + 1;
+    }
 
-  Vector_Set_Value(vec, x);
+  if (next <= INTERVAL_MAX_INTEGER)
+    IList_Push(res, next, INTERVAL_MAX_INTEGER);
 
-  VECTOR_END_ENUM;
+  IList_To_Range(range, res);
 }
 
 
 
 
 /*-------------------------------------------------------------------------*
- * PL_VECTOR_DIV_VALUE                                                     *
+ * ILIST_RESET_VALUE                                                       *
  *                                                                         *
  *-------------------------------------------------------------------------*/
-void
-Pl_Vector_Div_Value(Vector vec, int n)
+static void
+IList_Reset_Value(Range *range, PlLong n)
 {
-  Vector aux_vec;
-  int vec_elem;
-  int x;
-
-  Vector_Allocate(aux_vec);
-  Pl_Vector_Copy(aux_vec, vec);
-  Pl_Vector_Empty(vec);
+  PlLong buff[3];
+  PlLong *il, *res;
+  int nb, i;
 
-  if (n == 0)
-    return;
+  il = IList_View(range, buff);
+  nb = IList_Nb_Interv(il);
 
-  VECTOR_BEGIN_ENUM(aux_vec, vec_elem);
+  res = (PlLong *) RANGE_TOP_STACK;
+  IList_Nb_Interv(res) = 0;
 
-  if (vec_elem % n == 0)
+  for (i = 0; i < nb; i++)
     {
-      x = vec_elem / n;
-      Vector_Set_Value(vec, x);
+      if (n < IList_Min(il, i) || n > IList_Max(il, i))
+	IList_Push(res, IList_Min(il, i), IList_Max(il, i));
+      else
+	{
+	  if (n > IList_Min(il, i))
+	    IList_Push(res, IList_Min(il, i), n - 1);
+
+	  if (n < IList_Max(il, i))
+	    IList_Push(res, n + 1, IList_Max(il, i));
+	}
     }
 
-  VECTOR_END_ENUM;
+  IList_To_Range(range, res);
 }
 
 
 
 
 /*-------------------------------------------------------------------------*
- * PL_VECTOR_MOD_VALUE                                                     *
+ * ILIST_ADD_VALUE                                                         *
  *                                                                         *
  *-------------------------------------------------------------------------*/
-void
-Pl_Vector_Mod_Value(Vector vec, int n)
+static void
+IList_Add_Value(Range *range, PlLong n)
 {
-  Vector aux_vec;
-  int vec_elem;
-  int x;
+  PlLong buff[3];
+  PlLong *il, *res;
+  int nb, i;
 
-  Vector_Allocate(aux_vec);
-  Pl_Vector_Copy(aux_vec, vec);
-  Pl_Vector_Empty(vec);
+  il = IList_View(range, buff);
+  nb = IList_Nb_Interv(il);
 
-  if (n == 0)
-    return;
+  res = (PlLong *) RANGE_TOP_STACK;
+  IList_Nb_Interv(res) = 0;
 
-  VECTOR_BEGIN_ENUM(aux_vec, vec_elem);
+  for (i = 0; i < nb; i++)
+    IList_Push(res, Range_Sat(IList_Min(il, i) + n),
+	       Range_Sat(IList_Max(il, i) + n));
 
-  x = vec_elem % n;
-  if ((unsigned) x <= (unsigned) pl_vec_max_integer)
-    Vector_Set_Value(vec, x);
+  IList_To_Range(range, res);
+}
 
-  VECTOR_END_ENUM;
+
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_ADD_RANGE                                                         *
+ *                                                                         *
+ * range + range1 (or range - range1 if sub is TRUE) as the union of the   *
+ * sums of each pair of intervals (the enclosing interval if there are too *
+ * many pairs).                                                            *
+ *-------------------------------------------------------------------------*/
+static void
+IList_Add_Range(Range *range, Range *range1, Bool sub)
+{
+  PlLong buff[3], buff1[3];
+  PlLong *il, *il1, *pairs, *res;
+  int nb, nb1, i, i1, k;
+  Bool extra_cstr = range->extra_cstr | range1->extra_cstr;
+
+  il = IList_View(range, buff);
+  il1 = IList_View(range1, buff1);
+  nb = IList_Nb_Interv(il);
+  nb1 = IList_Nb_Interv(il1);
+
+  if (nb * nb1 > ILIST_MAX_ADD_PAIRS)
+    {
+      if (sub)
+	Range_Init_Interval(range,
+			    Range_Sat(IList_Min(il, 0) - IList_Max(il1, nb1 - 1)),
+			    Range_Sat(IList_Max(il, nb - 1) - IList_Min(il1, 0)));
+      else
+	Range_Init_Interval(range,
+			    Range_Sat(IList_Min(il, 0) + IList_Min(il1, 0)),
+			    Range_Sat(IList_Max(il, nb - 1) + IList_Max(il1, nb1 - 1)));
+      range->extra_cstr = extra_cstr;
+      return;
+    }
+
+  pairs = (PlLong *) RANGE_TOP_STACK;
+  for (i = k = 0; i < nb; i++)
+    for (i1 = 0; i1 < nb1; i1++, k += 2)
+      if (sub)
+	{
+	  pairs[k] = Range_Sat(IList_Min(il, i) - IList_Max(il1, i1));
+	  pairs[k + 1] = Range_Sat(IList_Max(il, i) - IList_Min(il1, i1));
+	}
+      else
+	{
+	  pairs[k] = Range_Sat(IList_Min(il, i) + IList_Min(il1, i1));
+	  pairs[k + 1] = Range_Sat(IList_Max(il, i) + IList_Max(il1, i1));
+	}
+
+  qsort(pairs, k / 2, 2 * sizeof(PlLong), IList_Cmp_Interv);
+  RANGE_TOP_STACK += IList_Size(k / 2);
+
+  res = (PlLong *) RANGE_TOP_STACK;
+  IList_Nb_Interv(res) = 0;
+
+  for (i = 0; i < k; i += 2)
+    IList_Push(res, pairs[i], pairs[i + 1]);
+
+  IList_To_Range(range, res);
+  range->extra_cstr = extra_cstr;
 }
 
 
@@ -790,10 +1557,11 @@ Pl_Vector_Mod_Value(Vector vec, int n)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 Bool
-Pl_Range_Test_Value(Range *range, int n)
+Pl_Range_Test_Value(Range *range, PlLong n)
 {
-  int min = range->min;
-  int max = range->max;
+  PlLong min = range->min;
+  PlLong max = range->max;
+  PlLong *il;
 
   if (n < min || n > max)
     return FALSE;
@@ -801,6 +1569,12 @@ Pl_Range_Test_Value(Range *range, int n)
   if (Is_Interval(range) || n == min || n == max)
     return TRUE;
 
+  if (Is_IList(range))		/* here n is in min..max */
+    {
+      il = IList_Of(range);
+      return IList_Min(il, IList_Search(il, n)) <= n;
+    }
+
   return Vector_Test_Value(range->vec, n);
 }
 
@@ -814,7 +1588,11 @@ Pl_Range_Test_Value(Range *range, int n)
 Bool
 Pl_Range_Test_Null_Inter(Range *range, Range *range1)
 {
-  int swt, i;
+  int swt, i, i1;
+  PlLong buff[3], buff1[3];
+  PlLong *il, *il1;
+  PlLong x;
+  WamWord *save_top;
 
   if (range->min > range1->max || range1->min > range->max)
     return TRUE;
@@ -823,6 +1601,26 @@ Pl_Range_Test_Null_Inter(Range *range, Range *range1)
       range->max == range1->min || range->max == range1->max)
     return FALSE;
 
+  if (Is_IList(range) || Is_IList(range1))
+    {
+      save_top = RANGE_TOP_STACK;
+      il = IList_View(range, buff);
+      il1 = IList_View(range1, buff1);
+      RANGE_TOP_STACK = save_top;
+
+      for (i = i1 = 0; i < IList_Nb_Interv(il) && i1 < IList_Nb_Interv(il1);)
+	{
+	  if (IList_Max(il, i) < IList_Min(il1, i1))
+	    i++;
+	  else if (IList_Max(il1, i1) < IList_Min(il, i))
+	    i1++;
+	  else
+	    return FALSE;
+	}
+
+      return TRUE;
+    }
+
   swt = (Is_Sparse(range) << 1) + Is_Sparse(range1);
 
   if (swt == 3)			/* Sparse with Sparse */
@@ -844,8 +1642,8 @@ Pl_Range_Test_Null_Inter(Range *range, Range *range1)
   if (range->min <= range1->min)
     return FALSE;
 
-  for (i = range->min; i <= range->max; i++)
-    if (Vector_Test_Value(range1->vec, i))
+  for (x = range->min; x <= range->max; x++)
+    if (Vector_Test_Value(range1->vec, x))
       return FALSE;
 
   return TRUE;
@@ -861,15 +1659,27 @@ Pl_Range_Test_Null_Inter(Range *range, Range *range1)
 void
 Pl_Range_Copy(Range *range, Range *range1)
 {
+  PlLong *il;
+  int size;
+
   range->extra_cstr = range1->extra_cstr;
   range->min = range1->min;
   range->max = range1->max;
 
   if (Is_Interval(range1))
     range->vec = NULL;
+  else if (Is_IList(range1))	/* range1 can be above the top of the stack */
+    {
+      il = IList_Of(range1);
+      size = IList_Size(IList_Nb_Interv(il));
+      memmove(RANGE_TOP_STACK, il, size * sizeof(VecWord));
+      Set_IList(range, RANGE_TOP_STACK);
+      RANGE_TOP_STACK += size;
+    }
   else
     {
-      Vector_Allocate_If_Necessary(range->vec);
+      if (!Is_Vector(range))
+	Vector_Allocate(range->vec);
       Pl_Vector_Copy(range->vec, range1->vec);
     }
 }
@@ -881,12 +1691,24 @@ Pl_Range_Copy(Range *range, Range *range1)
  * PL_RANGE_NB_ELEM                                                        *
  *                                                                         *
  *-------------------------------------------------------------------------*/
-int
+PlLong
 Pl_Range_Nb_Elem(Range *range)
 {
+  PlLong *il;
+  PlLong n = 0;
+  int i;
+
   if (Is_Interval(range))	/* here range is not empty */
     return range->max - range->min + 1;
 
+  if (Is_IList(range))
+    {
+      il = IList_Of(range);
+      for (i = 0; i < IList_Nb_Interv(il); i++)
+	n += IList_Max(il, i) - IList_Min(il, i) + 1;
+
+      return n;
+    }
 
   return Pl_Vector_Nb_Elem(range->vec);
 }
@@ -898,10 +1720,12 @@ Pl_Range_Nb_Elem(Range *range)
  * PL_RANGE_ITH_ELEM                                                       *
  *                                                                         *
  *-------------------------------------------------------------------------*/
-int
-Pl_Range_Ith_Elem(Range *range, int i)
+PlLong
+Pl_Range_Ith_Elem(Range *range, PlLong i)
 {
-  int n;
+  PlLong n;
+  PlLong *il;
+  int j;
 
   if (Is_Empty(range))
     return -1;
@@ -913,8 +1737,24 @@ Pl_Range_Ith_Elem(Range *range, int i)
       return n < range->min || n > range->max ? -1 : n;
     }
 
+  if (Is_IList(range))
+    {
+      il = IList_Of(range);
+      for (j = 0; j < IList_Nb_Interv(il); j++)
+	{
+	  n = IList_Max(il, j) - IList_Min(il, j) + 1;
+	  if (i <= n)
+	    return (i >= 1) ? IList_Min(il, j) + i - 1 : -1;
+	  i -= n;
+	}
+
+      return -1;
+    }
+
+  if (i > pl_vec_max_integer + 1)
+    return -1;
 
-  return Pl_Vector_Ith_Elem(range->vec, i);
+  return Pl_Vector_Ith_Elem(range->vec, (int) i);
 }
 
 
@@ -924,9 +1764,12 @@ Pl_Range_Ith_Elem(Range *range, int i)
  * PL_RANGE_NEXT_AFTER                                                     *
  *                                                                         *
  *-------------------------------------------------------------------------*/
-int
-Pl_Range_Next_After(Range *range, int n)
+PlLong
+Pl_Range_Next_After(Range *range, PlLong n)
 {
+  PlLong *il;
+  int i;
+
   if (Is_Empty(range))
     return -1;
 
@@ -942,6 +1785,17 @@ Pl_Range_Next_After(Range *range, int n)
       return n;
     }
 
+  if (Is_IList(range))
+    {
+      if (n >= range->max)
+	return -1;
+
+      n++;
+      il = IList_Of(range);
+      i = IList_Search(il, n);
+
+      return math_max(n, IList_Min(il, i));
+    }
 
   return Pl_Vector_Next_After(range->vec, n);
 }
@@ -953,9 +1807,12 @@ Pl_Range_Next_After(Range *range, int n)
  * PL_RANGE_NEXT_BEFORE                                                    *
  *                                                                         *
  *-------------------------------------------------------------------------*/
-int
-Pl_Range_Next_Before(Range *range, int n)
+PlLong
+Pl_Range_Next_Before(Range *range, PlLong n)
 {
+  PlLong *il;
+  int i;
+
   if (Is_Empty(range))
     return -1;
 
@@ -971,6 +1828,19 @@ Pl_Range_Next_Before(Range *range, int n)
       return n;
     }
 
+  if (Is_IList(range))
+    {
+      if (n <= range->min)
+	return -1;
+
+      n--;
+      il = IList_Of(range);
+      i = IList_Search(il, n);
+      if (i < IList_Nb_Interv(il) && IList_Min(il, i) <= n)
+	return n;
+
+      return IList_Max(il, i - 1); /* i > 0 since n >= min */
+    }
 
   return Pl_Vector_Next_Before(range->vec, n);
 }
@@ -985,6 +1855,30 @@ Pl_Range_Next_Before(Range *range, int n)
 void
 Pl_Range_Becomes_Sparse(Range *range)
 {
+  PlLong *il;
+  PlLong j, max;
+  int i;
+
+  if (Is_IList(range))		/* values out of the vector are lost */
+    {
+      il = IList_Of(range);
+      Vector_Allocate(range->vec);
+      Pl_Vector_Empty(range->vec);
+      if (Is_Empty(range))
+	return;
+
+      for (i = 0; i < IList_Nb_Interv(il); i++)
+	{
+	  max = math_min(IList_Max(il, i), pl_vec_max_integer);
+	  for (j = math_max(IList_Min(il, i), 0); j <= max; j++)
+	    Vector_Set_Value(range->vec, j);
+	}
+
+      range->extra_cstr |= (range->max > pl_vec_max_integer);
+      Pl_Range_From_Vector(range);
+      return;
+    }
+
   Vector_Allocate_If_Necessary(range->vec);
 
   if (range->min < 0)
@@ -1037,13 +1931,42 @@ Pl_Range_From_Vector(Range *range)
 
 
 
+/*-------------------------------------------------------------------------*
+ * PL_RANGE_FROM_VALUES                                                    *
+ *                                                                         *
+ * Builds a range from an array of n values (the array is sorted).         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Range_From_Values(Range *range, PlLong *val, int n)
+{
+  PlLong *il;
+  int i;
+
+  range->extra_cstr = FALSE;
+
+  qsort(val, n, sizeof(PlLong), IList_Cmp_Interv);
+
+  il = (PlLong *) RANGE_TOP_STACK;
+  IList_Nb_Interv(il) = 0;
+
+  for (i = 0; i < n; i++)
+    IList_Push(il, val[i], val[i]);
+
+  IList_To_Range(range, il);
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * PL_RANGE_SET_VALUE                                                      *
  *                                                                         *
  *-------------------------------------------------------------------------*/
 void
-Pl_Range_Set_Value(Range *range, int n)
+Pl_Range_Set_Value(Range *range, PlLong n)
 {
+  Range r;
+
   if (Is_Empty(range))
     {
       Range_Init_Interval(range, n, n);
@@ -1067,8 +1990,16 @@ Pl_Range_Set_Value(Range *range, int n)
 	  return;
 	}
 
+      if (!Vector_Preferred(math_min(n, range->min), math_max(n, range->max)))
+	{
+	  Range_Init_Interval(&r, n, n);
+	  r.extra_cstr = range->extra_cstr;
+	  IList_Union(range, &r);
+	  return;
+	}
+
       Pl_Range_Becomes_Sparse(range);
-      if ((unsigned) n <= (unsigned) pl_vec_max_integer)
+      if ((PlULong) n <= (PlULong) pl_vec_max_integer)
 	{
 	  Vector_Set_Value(range->vec, n);
 	  Pl_Range_From_Vector(range);
@@ -1079,9 +2010,11 @@ Pl_Range_Set_Value(Range *range, int n)
       return;
     }
 
-  if ((unsigned) n > (unsigned) pl_vec_max_integer)
+  if (Is_IList(range) || (PlULong) n > (PlULong) pl_vec_max_integer)
     {
-      range->extra_cstr = TRUE;
+      Range_Init_Interval(&r, n, n);
+      r.extra_cstr = range->extra_cstr;
+      IList_Union(range, &r);
       return;
     }
 
@@ -1098,7 +2031,7 @@ Pl_Range_Set_Value(Range *range, int n)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 void
-Pl_Range_Reset_Value(Range *range, int n)
+Pl_Range_Reset_Value(Range *range, PlLong n)
 {
   if (Is_Empty(range) || n < range->min || n > range->max)
     return;
@@ -1123,15 +2056,26 @@ Pl_Range_Reset_Value(Range *range, int n)
 	  return;
 	}
 
+      if (!Vector_Preferred(range->min, range->max))
+	{
+	  IList_Reset_Value(range, n);
+	  return;
+	}
+
       Pl_Range_Becomes_Sparse(range);
-      if ((unsigned) n <= (unsigned) pl_vec_max_integer)
+      if ((PlULong) n <= (PlULong) pl_vec_max_integer)
 	Vector_Reset_Value(range->vec, n);
 
       return;
     }
 
+  if (Is_IList(range))
+    {
+      IList_Reset_Value(range, n);
+      return;
+    }
 
-  if ((unsigned) n > (unsigned) pl_vec_max_integer)
+  if ((PlULong) n > (PlULong) pl_vec_max_integer)
     return;
 
 
@@ -1165,6 +2109,29 @@ Pl_Range_Union(Range *range, Range *range1)
 	  return;
 	}
 
+      if (Is_Empty(range) || Is_Empty(range1))
+	{
+	  if (Is_Empty(range))
+	    {
+	      range->min = range1->min;
+	      range->max = range1->max;
+	    }
+	  range->extra_cstr |= range1->extra_cstr;
+	  return;
+	}
+    }
+
+  if (Is_IList(range) || Is_IList(range1) ||
+      (Is_Not_Empty(range) && Is_Not_Empty(range1) &&
+       !Vector_Preferred(math_min(range->min, range1->min),
+			 math_max(range->max, range1->max))))
+    {
+      IList_Union(range, range1);
+      return;
+    }
+
+  if (swt == 0)			/* Interval with Interval */
+    {
       Pl_Range_Becomes_Sparse(range);
       r.vec = NULL;
       Pl_Range_Copy(&r, range1);	/* we cannot modify range1 */
@@ -1223,6 +2190,28 @@ Pl_Range_Inter(Range *range, Range *range1)
       return;
     }
 
+  if (Is_IList(range) || Is_IList(range1))
+    {
+      if (!Is_Vector(range) && !Is_Vector(range1))
+	{
+	  IList_Inter(range, range1);
+	  return;
+	}
+				/* with a vector: the result is a vector */
+      if (Is_IList(range))
+	Pl_Range_Becomes_Sparse(range);
+
+      if (Is_IList(range1))
+	{
+	  r.vec = NULL;
+	  Pl_Range_Copy(&r, range1);	/* we cannot modify range1 */
+	  range1 = &r;
+	  Pl_Range_Becomes_Sparse(range1);
+	}
+
+      swt = 3;
+    }
+
   if (swt == 1)			/* Interval with Sparse */
     Pl_Range_Becomes_Sparse(range);
   else if (swt == 2)		/* Sparse with Interval */
@@ -1289,23 +2278,16 @@ Pl_Range_Compl(Range *range)
 
 	  return;
 	}
-
-      Pl_Range_Becomes_Sparse(range);
-    }
-  /* Sparse */
-  range->extra_cstr = TRUE;
-
-  if (Is_Empty(range))
-    {
-      range->min = 0;
-      range->max = pl_vec_max_integer;
-      Pl_Vector_Full(range->vec);
     }
-  else
-    {
+				/* exact complement (interval list) */
+  if (Is_Vector(range) && range->extra_cstr)
+    {				/* the values > pl_vec_max_integer are unknown */
       Pl_Vector_Compl(range->vec);
       Pl_Range_From_Vector(range);
+      return;
     }
+
+  IList_Compl(range);
 }
 
 
@@ -1333,11 +2315,19 @@ Pl_Range_Add_Range(Range *range, Range *range1)
   if (swt == 0)			/* Interval with Interval */
     {
 /*   range->extra_cstr=FALSE; */
-      range->min += range1->min;
-      range->max += range1->max;
+      range->min = Range_Sat(range->min + range1->min);
+      range->max = Range_Sat(range->max + range1->max);
       return;
     }
-  else if (swt == 1)		/* Interval with Sparse */
+
+  if (Is_IList(range) || Is_IList(range1) ||
+      range->max + range1->max > pl_vec_max_integer)
+    {
+      IList_Add_Range(range, range1, FALSE);
+      return;
+    }
+
+  if (swt == 1)		/* Interval with Sparse */
     Pl_Range_Becomes_Sparse(range);
   else if (swt == 2)		/* Sparse with Interval */
     {
@@ -1384,11 +2374,19 @@ Pl_Range_Sub_Range(Range *range, Range *range1)
   if (swt == 0)			/* Interval with Interval */
     {
 /*   range->extra_cstr=FALSE; */
-      range->min -= range1->max;
-      range->max -= range1->min;
+      range->min = Range_Sat(range->min - range1->max);
+      range->max = Range_Sat(range->max - range1->min);
       return;
     }
-  else if (swt == 1)		/* Interval with Sparse */
+
+  if (Is_IList(range) || Is_IList(range1) ||
+      range->max - range1->min > pl_vec_max_integer)
+    {
+      IList_Add_Range(range, range1, TRUE);
+      return;
+    }
+
+  if (swt == 1)		/* Interval with Sparse */
     Pl_Range_Becomes_Sparse(range);
   else if (swt == 2)		/* Sparse with Interval */
     {
@@ -1430,10 +2428,10 @@ Pl_Range_Mul_Range(Range *range, Range *range1)
       return;
     }
 
-  if (Is_Interval(range))
+  if (!Is_Vector(range))		/* an interval list is approximated */
     Pl_Range_Becomes_Sparse(range);
 
-  if (Is_Interval(range1))
+  if (!Is_Vector(range1))
     {
       r.vec = NULL;
       Pl_Range_Copy(&r, range1);	/* we cannot modify range1 */
@@ -1468,10 +2466,10 @@ Pl_Range_Div_Range(Range *range, Range *range1)
       return;
     }
 
-  if (Is_Interval(range))
+  if (!Is_Vector(range))		/* an interval list is approximated */
     Pl_Range_Becomes_Sparse(range);
 
-  if (Is_Interval(range1))
+  if (!Is_Vector(range1))
     {
       r.vec = NULL;
       Pl_Range_Copy(&r, range1);	/* we cannot modify range1 */
@@ -1506,10 +2504,10 @@ Pl_Range_Mod_Range(Range *range, Range *range1)
       return;
     }
 
-  if (Is_Interval(range))
+  if (!Is_Vector(range))		/* an interval list is approximated */
     Pl_Range_Becomes_Sparse(range);
 
-  if (Is_Interval(range1))
+  if (!Is_Vector(range1))
     {
       r.vec = NULL;
       Pl_Range_Copy(&r, range1);	/* we cannot modify range1 */
@@ -1532,16 +2530,24 @@ Pl_Range_Mod_Range(Range *range, Range *range1)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 void
-Pl_Range_Add_Value(Range *range, int n)
+Pl_Range_Add_Value(Range *range, PlLong n)
 {
   if (n == 0 || Is_Empty(range))
     return;
 
+  n = Range_Sat(n);
+
   if (Is_Interval(range))	/* Interval */
     {
-      range->min += n;
-      range->max += n;
+      range->min = Range_Sat(range->min + n);
+      range->max = Range_Sat(range->max + n);
+
+      return;
+    }
 
+  if (Is_IList(range) || range->max + n > pl_vec_max_integer)
+    {
+      IList_Add_Value(range, n);
       return;
     }
   /* Sparse */
@@ -1562,18 +2568,18 @@ Pl_Range_Add_Value(Range *range, int n)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 void
-Pl_Range_Mul_Value(Range *range, int n)
+Pl_Range_Mul_Value(Range *range, PlLong n)
 {
   if (n == 1 || Is_Empty(range))
     return;
 
-  if (Is_Interval(range))	/* Interval */
+  if (!Is_Vector(range))	/* an interval list is approximated */
     Pl_Range_Becomes_Sparse(range);
   /* Sparse */
   Pl_Vector_Mul_Value(range->vec, n);
 
-  range->min = range->min * n;
-  range->max = range->max * n;
+  range->min = Pl_Range_Mul_Sat(range->min, n);
+  range->max = Pl_Range_Mul_Sat(range->max, n);
 
   range->extra_cstr |= (range->max > pl_vec_max_integer);
   if (range->extra_cstr)
@@ -1588,12 +2594,12 @@ Pl_Range_Mul_Value(Range *range, int n)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 void
-Pl_Range_Div_Value(Range *range, int n)
+Pl_Range_Div_Value(Range *range, PlLong n)
 {
   if (n == 1 || Is_Empty(range))
     return;
 
-  if (Is_Interval(range))	/* Interval */
+  if (!Is_Vector(range))	/* an interval list is approximated */
     Pl_Range_Becomes_Sparse(range);
   /* Sparse */
   Pl_Vector_Div_Value(range->vec, n);
@@ -1614,7 +2620,7 @@ Pl_Range_Div_Value(Range *range, int n)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 void
-Pl_Range_Mod_Value(Range *range, int n)
+Pl_Range_Mod_Value(Range *range, PlLong n)
 {
   Range aux;
 
@@ -1680,6 +2686,9 @@ Pl_Range_Mod_Value(Range *range, int n)
       range->max = math_min(range->max, n - 1);
       return;
     }
+
+  if (Is_IList(range))		/* an interval list is approximated */
+    Pl_Range_Becomes_Sparse(range);
   /* Sparse */
   Pl_Vector_Mod_Value(range->vec, n);
 
@@ -1699,6 +2708,8 @@ Pl_Range_To_String(Range *range)
   int vec_elem;
   int limit1 = -1;
   int limit2;
+  PlLong *il;
+  int i;
   static char buff[100 * 1024];
 
 
@@ -1710,13 +2721,13 @@ Pl_Range_To_String(Range *range)
 
   if (range->min == range->max)
     {
-      sprintf(buff, "{%d}", range->min);
+      sprintf(buff, "{%" PL_FMT_d "}", range->min);
       return buff;
     }
 
   if (Is_Interval(range))
     {
-      sprintf(buff, "%s%d%s%d%s",
+      sprintf(buff, "%s%" PL_FMT_d "%s%" PL_FMT_d "%s",
 	      WRITE_BEGIN_RANGE,
 	      range->min, WRITE_LIMITS_SEPARATOR, range->max,
 	      WRITE_END_RANGE);
@@ -1725,6 +2736,34 @@ Pl_Range_To_String(Range *range)
 
   strcpy(buff, WRITE_BEGIN_RANGE);
 
+  if (Is_IList(range))
+    {
+      il = IList_Of(range);
+      for (i = 0; i < IList_Nb_Interv(il); i++)
+	{
+	  if (strlen(buff) > sizeof(buff) - 64)
+	    {
+	      strcat(buff, WRITE_TRUNCATED_SYMBOL);
+	      break;
+	    }
+
+	  if (i > 0)
+	    strcat(buff, WRITE_INTERVALS_SEPARATOR);
+
+	  if (IList_Min(il, i) == IList_Max(il, i))
+	    sprintf(buff + strlen(buff), "%" PL_FMT_d, IList_Min(il, i));
+	  else
+	    sprintf(buff + strlen(buff), "%" PL_FMT_d "%s%" PL_FMT_d, IList_Min(il, i),
+		    WRITE_LIMITS_SEPARATOR, IList_Max(il, i));
+	}
+
+      strcat(buff, WRITE_END_RANGE);
+      if (range->extra_cstr)
+	strcat(buff, WRITE_EXTRA_CSTR_SYMBOL);
+
+      return buff;
+    }
+
   VECTOR_BEGIN_ENUM(range->vec, vec_elem);
   if (limit1 == -1)
     limit1 = limit2 = vec_elem;
@@ -1757,3 +2796,31 @@ Pl_Range_To_String(Range *range)
 
   return buff;
 }
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_RANGE_MUL_SAT                                                        *
+ *                                                                         *
+ * Returns x * y saturated at +/- RANGE_SAT_MAX (see Range_Sat).           *
+ *-------------------------------------------------------------------------*/
+PlLong
+Pl_Range_Mul_Sat(PlLong x, PlLong y)
+{
+  PlLong z;
+
+#if defined(__GNUC__) && (__GNUC__ >= 5 || defined(__clang__))
+  if (__builtin_mul_overflow(x, y, &z))
+    return ((x < 0) == (y < 0)) ? RANGE_SAT_MAX : -RANGE_SAT_MAX;
+#else
+  PlULong ax = (x < 0) ? -(PlULong) x : (PlULong) x;
+  PlULong ay = (y < 0) ? -(PlULong) y : (PlULong) y;
+
+  if (ay != 0 && ax > (PlULong) RANGE_SAT_MAX / ay)
+    return ((x < 0) == (y < 0)) ? RANGE_SAT_MAX : -RANGE_SAT_MAX;
+  z = x * y;
+#endif
+
+  return Range_Sat(z);
+}
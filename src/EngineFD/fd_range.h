@@ -43,6 +43,12 @@
  * Constants                       *
  *---------------------------------*/
 
+			/* vector kernels (see pl_vec_kernel) */
+#define VEC_KERNEL_UNDEFINED       0
+#define VEC_KERNEL_PORTABLE        1 /* plain C word loops */
+#define VEC_KERNEL_POPCNT          2 /* + hardware popcount (SSE4.2) */
+#define VEC_KERNEL_AVX2            3 /* + 256-bit bitwise operations */
+
 /*---------------------------------*
  * Type Definitions                *
  *---------------------------------*/
@@ -54,9 +60,9 @@ typedef VecWord *Vector;
 typedef struct			/* Ranges are always handled through pointers */
 {
   Bool extra_cstr;
-  int min;
-  int max;
-  Vector vec;
+  PlLong min;
+  PlLong max;
+  Vector vec;			/* NULL: interval, else vector or interval list */
 }
 Range;
 
@@ -67,6 +73,16 @@ Range;
  * Global Variables                *
  *---------------------------------*/
 
+#ifdef FD_RANGE_FILE
+
+int pl_vec_kernel;		/* kernel selected by Pl_Define_Vector_Size */
+
+#else
+
+extern int pl_vec_kernel;
+
+#endif
+
 #include "fd_hook_range.h"
 
 	  /* Default definitions (if not defined in fd_hook_range.h) */
@@ -96,15 +112,17 @@ Range;
 
 void Pl_Define_Vector_Size(int max_val);
 
-void Pl_Vector_From_Interval(Vector vec, int min, int max);
+int Pl_Vector_Best_Kernel(void);
+
+void Pl_Vector_From_Interval(Vector vec, PlLong min, PlLong max);
 
 int Pl_Vector_Nb_Elem(Vector vec);
 
 int Pl_Vector_Ith_Elem(Vector vec, int n);
 
-int Pl_Vector_Next_After(Vector vec, int n);
+int Pl_Vector_Next_After(Vector vec, PlLong n);
 
-int Pl_Vector_Next_Before(Vector vec, int n);
+int Pl_Vector_Next_Before(Vector vec, PlLong n);
 
 void Pl_Vector_Empty(Vector vec);
 
@@ -130,34 +148,36 @@ void Pl_Vector_Div_Vector(Vector vec, Vector vec1);
 
 void Pl_Vector_Mod_Vector(Vector vec, Vector vec1);
 
-void Pl_Vector_Add_Value(Vector vec, int n);
+void Pl_Vector_Add_Value(Vector vec, PlLong n);
 
-void Pl_Vector_Mul_Value(Vector vec, int n);
+void Pl_Vector_Mul_Value(Vector vec, PlLong n);
 
-void Pl_Vector_Div_Value(Vector vec, int n);
+void Pl_Vector_Div_Value(Vector vec, PlLong n);
 
-void Pl_Vector_Mod_Value(Vector vec, int n);
+void Pl_Vector_Mod_Value(Vector vec, PlLong n);
 
-Bool Pl_Range_Test_Value(Range *range, int n);
+Bool Pl_Range_Test_Value(Range *range, PlLong n);
 
 Bool Pl_Range_Test_Null_Inter(Range *range, Range *range1);
 
 void Pl_Range_Copy(Range *range, Range *range1);
 
-int Pl_Range_Nb_Elem(Range *range);
+PlLong Pl_Range_Nb_Elem(Range *range);
 
-int Pl_Range_Ith_Elem(Range *range, int n);
+PlLong Pl_Range_Ith_Elem(Range *range, PlLong n);
 
-int Pl_Range_Next_After(Range *range, int n);
+PlLong Pl_Range_Next_After(Range *range, PlLong n);
 
-int Pl_Range_Next_Before(Range *range, int n);
+PlLong Pl_Range_Next_Before(Range *range, PlLong n);
 
-void Pl_Range_Set_Value(Range *range, int n);
+void Pl_Range_Set_Value(Range *range, PlLong n);
 
-void Pl_Range_Reset_Value(Range *range, int n);
+void Pl_Range_Reset_Value(Range *range, PlLong n);
 
 void Pl_Range_Becomes_Sparse(Range *range);
 
+void Pl_Range_From_Values(Range *range, PlLong *val, int n);
+
 void Pl_Range_From_Vector(Range *range);
 
 void Pl_Range_Union(Range *range, Range *range1);
@@ -176,16 +196,18 @@ void Pl_Range_Div_Range(Range *range, Range *range1);
 
 void Pl_Range_Mod_Range(Range *range, Range *range1);
 
-void Pl_Range_Add_Value(Range *range, int n);
+void Pl_Range_Add_Value(Range *range, PlLong n);
 
-void Pl_Range_Mul_Value(Range *range, int n);
+void Pl_Range_Mul_Value(Range *range, PlLong n);
 
-void Pl_Range_Div_Value(Range *range, int n);
+void Pl_Range_Div_Value(Range *range, PlLong n);
 
-void Pl_Range_Mod_Value(Range *range, int n);
+void Pl_Range_Mod_Value(Range *range, PlLong n);
 
 char *Pl_Range_To_String(Range *range);
 
+PlLong Pl_Range_Mul_Sat(PlLong x, PlLong y);
+
 
 
 
@@ -275,11 +297,35 @@ char *Pl_Range_To_String(Range *range);
 
 #define Is_Interval(range)         ((range)->vec == NULL)
 #define Is_Sparse(range)           ((range)->vec != NULL)
+#define Is_Vector(range)           (Is_Sparse(range) && !Is_IList(range))
+#define Is_IList(range)            (((PlULong) (range)->vec & RANGE_ILIST_TAG) != 0)
 #define Is_Empty(range)            ((range)->min >  (range)->max)
 #define Is_Not_Empty(range)        ((range)->max >= (range)->min)
 
 
-#define Set_To_Empty(range) (range)->max = (int)(1 << (sizeof(int) * 8 - 1))
+#define RANGE_EMPTY_MAX            ((PlLong) ((PlULong) 1 << (sizeof(PlLong) * 8 - 1)))
+
+#define Set_To_Empty(range)        (range)->max = RANGE_EMPTY_MAX
+
+
+	  /* A sparse range is either a bit-vector (0..pl_vec_max_integer) or *
+	   * an interval list: a sorted array of disjoint (and not adjacent)  *
+	   * intervals [nb_interv, min1, max1, ..., minN, maxN] (PlLong). An  *
+	   * interval list is never modified (a new one is allocated), its    *
+	   * address is stored in vec tagged with RANGE_ILIST_TAG.            */
+
+#define RANGE_ILIST_TAG            1
+
+#define IList_Of(range)            ((PlLong *) ((PlULong) (range)->vec & ~(PlULong) RANGE_ILIST_TAG))
+#define Set_IList(range, il)       ((range)->vec = (Vector) ((PlULong) (il) | RANGE_ILIST_TAG))
+
+#define IList_Nb_Interv(il)        ((il)[0])
+#define IList_Min(il, i)           ((il)[2 * (i) + 1])
+#define IList_Max(il, i)           ((il)[2 * (i) + 2])
+
+#define IList_Size(nb_interv)      (((2 * (nb_interv) + 1) * sizeof(PlLong) + sizeof(VecWord) - 1) / sizeof(VecWord))
+
+
 
 
 #define Range_Init_Interval(range, r_min, r_max)	\
@@ -292,3 +338,17 @@ char *Pl_Range_To_String(Range *range);
     }							\
   while (0)
 
+
+
+
+	  /* Overflow-safe arithmetic: the bounds of ranges and the values  *
+	   * computed by constraints are saturated at +/- RANGE_SAT_MAX.    *
+	   * A saturated value is thus never in a domain (it is greater     *
+	   * than INTERVAL_MAX_INTEGER) and adding a few of them cannot     *
+	   * overflow a PlLong.                                             */
+
+#define RANGE_SAT_MAX              (2 * (PlLong) INTERVAL_MAX_INTEGER + 1)
+
+#define Range_Sat(x)               ((x) > RANGE_SAT_MAX ? RANGE_SAT_MAX : \
+				    (x) < -RANGE_SAT_MAX ? -RANGE_SAT_MAX : (x))
+
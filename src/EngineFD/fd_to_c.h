@@ -59,7 +59,7 @@
 
 #define Frame_Variable(fv)         ((WamWord *)(AF[fv]))
 #define Frame_Range_Parameter(fp)  ((Range *)  (AF[fp]))
-#define Frame_Term_Parameter(fp)   ((int)      (AF[fp]))
+#define Frame_Term_Parameter(fp)   ((PlLong)   (AF[fp]))
 #define Frame_Any_Parameter(fp)    ((WamWord)  (AF[fp]))
 #define Frame_List_Parameter(fp)   ((WamWord *)(AF[fp]))
 
@@ -94,6 +94,7 @@
 
 #define DivDn(x, y)                ((x) / (y))
 #define DivUp(x, y)                (((x) + (y) - 1) / (y))
+#define MulSat(x, y)               Pl_Range_Mul_Sat(x, y)	/* no overflow */
 
 
 #define R(r_no)                    rr##r_no
@@ -228,10 +229,10 @@
 
 	  /* Install instructions */
 
-#define fd_create_c_frame(fct_name, tell_fv, optim2)			      \
+#define fd_create_c_frame(fct_name, tell_fv, optim2, prio_info)		      \
   CF = Pl_Fd_Create_C_Frame(fct_name, AF, 				      \
 			    (tell_fv == -1) ? NULL : Frame_Variable(tell_fv), \
-			    optim2);
+			    optim2, prio_info);
 
 
 
@@ -250,6 +251,12 @@
 
 	  /* Constraint instructions */
 
+#define fd_cstr_type(name)			\
+  Fd_Cstr_Type(name);
+
+
+
+
 #define fd_before_add_constraint		\
   Pl_Fd_Before_Add_Cstr();
 
@@ -651,7 +658,7 @@ fct_name(WamWord *AF)				\
 
 
 #define fd_local_value_var(var_name)		\
-  int var_name;
+  PlLong var_name;
 
 
 
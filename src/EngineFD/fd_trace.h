@@ -0,0 +1,101 @@
+/*-------------------------------------------------------------------------*
+ * GNU Prolog                                                              *
+ *                                                                         *
+ * Part  : FD constraint solver                                            *
+ * File  : fd_trace.h                                                      *
+ * Descr.: FD propagation trace - binary format                            *
+ * Author: Daniel Diaz                                                     *
+ *                                                                         *
+ * Copyright (C) 1999-2023 Daniel Diaz                                     *
+ *                                                                         *
+ * This file is part of GNU Prolog                                         *
+ *                                                                         *
+ * GNU Prolog is free software: you can redistribute it and/or             *
+ * modify it under the terms of either:                                    *
+ *                                                                         *
+ *   - the GNU Lesser General Public License as published by the Free      *
+ *     Software Foundation; either version 3 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or                                                                      *
+ *                                                                         *
+ *   - the GNU General Public License as published by the Free             *
+ *     Software Foundation; either version 2 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or both in parallel, as here.                                           *
+ *                                                                         *
+ * GNU Prolog is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ * General Public License for more details.                                *
+ *                                                                         *
+ * You should have received copies of the GNU General Public License and   *
+ * the GNU Lesser General Public License along with this program.  If      *
+ * not, see http://www.gnu.org/licenses/.                                  *
+ *-------------------------------------------------------------------------*/
+
+#ifndef _FD_TRACE_H
+#define _FD_TRACE_H
+
+#include <stdint.h>
+
+/*
+ * The propagation trace (see fd_trace_start/1) is recorded in a ring
+ * buffer of fixed size records: when it is full the oldest records are
+ * overwritten. fd_trace_dump/1 writes it in a binary file (native byte
+ * order) which is decoded by the fdtrace tool:
+ *
+ *   FdTraceHeader
+ *   nb_type names (each one: a uint32_t length followed by the chars)
+ *   nb_rec FdTraceRec (from the oldest to the most recent)
+ *
+ * The type of a record is the index of a constraint type (the name of an
+ * FD user constraint or of a C constraint, 0 is "other", e.g. labeling).
+ * Constraints and variables are identified by their offset (in words) in
+ * the constraint stack.
+ */
+
+/*---------------------------------*
+ * Constants                       *
+ *---------------------------------*/
+
+#define FD_TRACE_MAGIC             "GPFDTRC3"
+
+#define FD_TRACE_POST              0 /* obj: constraint frame created           */
+#define FD_TRACE_PROPAG            1 /* obj: constraint executed                */
+#define FD_TRACE_FAIL              2 /* obj: constraint failed (0: a tell)      */
+#define FD_TRACE_REDUC             3 /* obj: var reduced, value: its new size   */
+#define FD_TRACE_BCKT              4 /* obj: var labeled, value: value tried    */
+
+#define FD_TRACE_NB_EVENT          5
+
+
+
+
+/*---------------------------------*
+ * Type Definitions                *
+ *---------------------------------*/
+
+typedef struct			/* file header */
+{
+  char magic[8];
+  uint32_t rec_size;		/* sizeof(FdTraceRec) */
+  uint32_t nb_type;		/* number of constraint type names */
+  uint32_t nb_rec;		/* number of records in the file */
+  uint32_t buff_size;		/* capacity of the ring buffer */
+  uint64_t nb_event;		/* number of recorded events (incl. lost ones) */
+}
+FdTraceHeader;
+
+
+typedef struct			/* a trace record */
+{
+  uint16_t event;
+  uint16_t type;
+  uint32_t obj;
+  uint64_t value;		/* FD bounds are 64 bits (see fd_hook_range.h) */
+}
+FdTraceRec;
+
+#endif /* !_FD_TRACE_H */
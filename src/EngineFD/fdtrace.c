@@ -0,0 +1,225 @@
+/*-------------------------------------------------------------------------*
+ * GNU Prolog                                                              *
+ *                                                                         *
+ * Part  : FD constraint solver                                            *
+ * File  : fdtrace.c                                                       *
+ * Descr.: FD propagation trace decoder                                    *
+ * Author: Daniel Diaz                                                     *
+ *                                                                         *
+ * Copyright (C) 1999-2023 Daniel Diaz                                     *
+ *                                                                         *
+ * This file is part of GNU Prolog                                         *
+ *                                                                         *
+ * GNU Prolog is free software: you can redistribute it and/or             *
+ * modify it under the terms of either:                                    *
+ *                                                                         *
+ *   - the GNU Lesser General Public License as published by the Free      *
+ *     Software Foundation; either version 3 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or                                                                      *
+ *                                                                         *
+ *   - the GNU General Public License as published by the Free             *
+ *     Software Foundation; either version 2 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or both in parallel, as here.                                           *
+ *                                                                         *
+ * GNU Prolog is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ * General Public License for more details.                                *
+ *                                                                         *
+ * You should have received copies of the GNU General Public License and   *
+ * the GNU Lesser General Public License along with this program.  If      *
+ * not, see http://www.gnu.org/licenses/.                                  *
+ *-------------------------------------------------------------------------*/
+
+/* Usage: fdtrace [-s] file
+ *
+ * Decodes a propagation trace written by fd_trace_dump/1 (see fd_trace.h).
+ * Each record is displayed on a line, from the oldest one. With -s only a
+ * summary is displayed: the number of events of each kind per constraint
+ * type (sorted by decreasing number of propagations).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fd_trace.h"
+
+
+
+
+/*---------------------------------*
+ * Constants                       *
+ *---------------------------------*/
+
+/*---------------------------------*
+ * Type Definitions                *
+ *---------------------------------*/
+
+typedef struct
+{
+  char *name;
+  unsigned long count[FD_TRACE_NB_EVENT];
+}
+TypeInfo;
+
+
+
+
+/*---------------------------------*
+ * Global Variables                *
+ *---------------------------------*/
+
+static char *event_name[FD_TRACE_NB_EVENT] =
+  { "post", "propag", "fail", "reduc", "bckt" };
+
+static char *obj_name[FD_TRACE_NB_EVENT] =
+  { "cstr", "cstr", "cstr", "var", "var" };
+
+static TypeInfo *type_info;
+
+
+
+
+/*---------------------------------*
+ * Function Prototypes             *
+ *---------------------------------*/
+
+static int Compare_Types(const void *t1, const void *t2);
+
+static void Fatal(char *msg, char *arg);
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * MAIN                                                                    *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+int
+main(int argc, char *argv[])
+{
+  FILE *f;
+  FdTraceHeader h;
+  FdTraceRec rec;
+  uint32_t len, i;
+  int summary = 0;
+  char *file;
+  unsigned long nb_lost, *c;
+
+  if (argc == 3 && strcmp(argv[1], "-s") == 0)
+    summary = 1;
+  else if (argc != 2)
+    Fatal("usage: fdtrace [-s] file", NULL);
+
+  file = argv[argc - 1];
+  if ((f = fopen(file, "rb")) == NULL)
+    Fatal("cannot open %s", file);
+
+  if (fread(&h, sizeof(h), 1, f) != 1 ||
+      memcmp(h.magic, FD_TRACE_MAGIC, sizeof(h.magic)) != 0)
+    Fatal("%s: not an FD trace file", file);
+
+  if (h.rec_size != sizeof(FdTraceRec))
+    Fatal("%s: incompatible record size", file);
+
+  type_info = (TypeInfo *) calloc(h.nb_type + 1, sizeof(TypeInfo));
+  if (type_info == NULL)
+    Fatal("%s: out of memory", file);
+
+  for (i = 0; i < h.nb_type; i++)
+    {
+      if (fread(&len, sizeof(len), 1, f) != 1 ||
+	  (type_info[i].name = (char *) malloc(len + 1)) == NULL ||
+	  fread(type_info[i].name, 1, len, f) != len)
+	Fatal("%s: truncated file", file);
+      type_info[i].name[len] = '\0';
+    }
+  type_info[h.nb_type].name = "?";	/* for unknown types */
+
+  nb_lost = (unsigned long) (h.nb_event - h.nb_rec);
+  if (!summary)
+    printf("%% %lu events, %lu lost (ring buffer of %lu records)\n",
+	   (unsigned long) h.nb_event, nb_lost, (unsigned long) h.buff_size);
+
+  for (i = 0; i < h.nb_rec; i++)
+    {
+      if (fread(&rec, sizeof(rec), 1, f) != 1)
+	Fatal("%s: truncated file", file);
+
+      if (rec.event >= FD_TRACE_NB_EVENT)
+	Fatal("%s: invalid record", file);
+
+      if (rec.type > h.nb_type)
+	rec.type = h.nb_type;
+
+      type_info[rec.type].count[rec.event]++;
+
+      if (summary)
+	continue;
+
+      printf("%lu\t%-6s\t%-24s\t%s:%lu", nb_lost + i, event_name[rec.event],
+	     type_info[rec.type].name, obj_name[rec.event],
+	     (unsigned long) rec.obj);
+      if (rec.event == FD_TRACE_REDUC || rec.event == FD_TRACE_BCKT)
+	printf("\t%llu", (unsigned long long) rec.value);
+      printf("\n");
+    }
+
+  fclose(f);
+
+  if (!summary)
+    return 0;
+
+  qsort(type_info, h.nb_type + 1, sizeof(TypeInfo), Compare_Types);
+  printf("%-24s %12s %12s %12s %12s %12s\n", "constraint type",
+	 "frames", "propag", "fail", "reduc", "bckt");
+  for (i = 0; i <= h.nb_type; i++)
+    {
+      c = type_info[i].count;
+      if (c[0] + c[1] + c[2] + c[3] + c[4] == 0)
+	continue;
+
+      printf("%-24s %12lu %12lu %12lu %12lu %12lu\n", type_info[i].name,
+	     c[FD_TRACE_POST], c[FD_TRACE_PROPAG], c[FD_TRACE_FAIL],
+	     c[FD_TRACE_REDUC], c[FD_TRACE_BCKT]);
+    }
+
+  return 0;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * COMPARE_TYPES                                                           *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static int
+Compare_Types(const void *t1, const void *t2)
+{
+  unsigned long n1 = ((TypeInfo *) t1)->count[FD_TRACE_PROPAG];
+  unsigned long n2 = ((TypeInfo *) t2)->count[FD_TRACE_PROPAG];
+
+  return (n1 < n2) ? 1 : (n1 > n2) ? -1 : 0;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * FATAL                                                                   *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Fatal(char *msg, char *arg)
+{
+  fprintf(stderr, "fdtrace: ");
+  fprintf(stderr, msg, arg);
+  fprintf(stderr, "\n");
+  exit(1);
+}
@@ -176,7 +176,7 @@ bloc_lst([]) -->
 
 
 
-bloc_one(bl(BNo, LDep, LUse, LWInst, TellFdv, Always)) -->
+bloc_one(bl(BNo, LDep, LUse, LWInst, TellFdv, Always, Prio)) -->
 	{ clause(hvar(LVar), _) },
 	foreach(LVar, LUse, LWInst1, LWInst, HasForEach),
 	terminal(start),
@@ -196,6 +196,7 @@ bloc_one(bl(BNo, LDep, LUse, LWInst, TellFdv, Always)) -->
 	},
 	trig(LVar, LUse, LDep),
 	always(Always),
+	priority(Prio),
 	{ close_list(LDep), close_list(LUse) }.
 
 
@@ -280,6 +281,37 @@ always(optimized) -->
 
 
 
+priority(Prio) -->
+	terminal(priority), !,
+	ident_check(Class),
+	(   { priority_class(Class, Prio0) } ->
+	    []
+	;   sem_error('unknown priority class "~a"', [Class])
+	),
+	idempotent(Prio0, Prio).
+
+priority(Prio) -->
+	idempotent(0, Prio).
+
+
+			% see FD_PRIO_xxx and FD_CSTR_IDEMPOTENT in fd_inst.h
+priority_class(cheap, 0).
+priority_class(linear, 1).
+priority_class(expensive, 2).
+
+
+
+
+idempotent(Prio0, Prio) -->
+	terminal(idempotent), !,
+	{ Prio is Prio0 + 4 }.
+
+idempotent(Prio, Prio) -->
+	[].
+
+
+
+
 elem_lst(LVar, LUse, LWNext, LWInst) -->
 	elem_one(LVar, LUse, LWInst1, LWInst),
 	elem_lst(LVar, LUse, LWNext, LWInst1).
@@ -821,6 +853,7 @@ make_term(T1, Op, T2, T3) :-
 
 
 
+convert(*, 'MulSat').
 convert(/<, 'DivDn').
 convert(/>, 'DivUp').
 convert(mod, '%').
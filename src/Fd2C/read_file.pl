@@ -189,6 +189,8 @@ keyword(trigger).
 keyword(also).
 keyword(on).
 keyword(always).
+keyword(priority).
+keyword(idempotent).
 keyword(fail).
 keyword(exit).
 keyword(if).
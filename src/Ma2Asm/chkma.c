@@ -207,6 +207,12 @@ void ma_test_move_ret_fd(void);
 void test_switch_ret(void);
 void ma_test_switch_ret(void);
 
+void test_peephole_move(void);
+void ma_test_peephole_move(void);
+
+void test_peephole_jump(void);
+void ma_test_peephole_jump(void);
+
 
 void (*tbl[]) () =
 {
@@ -239,6 +245,8 @@ void (*tbl[]) () =
   test_move_ret_fl,
   test_move_ret_fd,
   test_switch_ret,
+  test_peephole_move,
+  test_peephole_jump,
  #endif
   NULL
 };
@@ -1093,6 +1101,73 @@ test_switch_ret2(PlLong k)
   CHECK_RESULT_LONG(k, i);
 }
 
+
+
+
+void
+test_peephole_move(void)
+{
+  int k;
+
+  printf("peephole: move...\n");
+  for (k = 0; k <= 12; k++)
+    X(k) = 1000 + k;
+  YY(2) = -1;
+
+  Call_Pl(ma_test_peephole_move, 1);
+
+  CHECK_RESULT_LONG(X(0), 1000);
+  CHECK_RESULT_LONG(X(1), 1001);
+  CHECK_RESULT_LONG(X(2), 1002);
+  CHECK_RESULT_LONG(X(3), 1004);
+  CHECK_RESULT_LONG(X(4), 1004);
+  CHECK_RESULT_LONG(X(5), 1002);
+  CHECK_RESULT_LONG(X(6), 1003);
+  CHECK_RESULT_LONG(X(7), 1003);
+  CHECK_RESULT_LONG(X(8), 1008);
+  CHECK_RESULT_LONG(X(9), 1008);
+  CHECK_RESULT_LONG(YY(2), 1008);
+  CHECK_RESULT_LONG(X(10), 1011);
+  CHECK_RESULT_LONG(X(11), 1010);
+  CHECK_RESULT_LONG(X(12), 1010);
+}
+
+
+
+
+void
+test_peephole_jump(void)
+{
+  printf("peephole: jump...\n");
+  x = 0;
+
+  Call_Pl(ma_test_peephole_jump, 1);
+
+  CHECK_RESULT_LONG(x, 3);
+}
+
+
+void FC
+test_peephole_jump1(void)
+{
+  x++;
+}
+
+
+PlLong FC
+test_peephole_jump2(void)
+{
+  return 2;
+}
+
+
+void FC
+test_peephole_error(void)
+{
+  printf("*** unreachable code executed\n");
+  error();
+}
+
 #endif
 
 
@@ -78,6 +78,13 @@
 #define MAP_RE_INCLUDE
 #include "../Tools/map_rbtree.h"
 
+#undef MAP_VALUE_TYPE
+#undef MAP_NAME
+#define MAP_VALUE_TYPE char *
+#define MAP_NAME map_jmp
+#define MAP_RE_INCLUDE
+#include "../Tools/map_rbtree.h"
+
 
 #if 0
 #define DEBUG
@@ -90,6 +97,10 @@
 
 #define DEFAULT_OUTPUT_SUFFIX      ASM_SUFFIX
 
+#define MAX_PEEP_MOVES             256
+#define MAX_PEEP_LABELS            16
+#define MAX_JUMP_CHAIN             32
+
 
 
 
@@ -97,6 +108,19 @@
  * Type Definitions                *
  *---------------------------------*/
 
+typedef struct
+{
+  int src_reg;			/* X_REG or Y_REG */
+  int src_index;
+  int dst_reg;			/* X_REG or Y_REG */
+  int dst_index;
+  Bool keep;			/* FALSE if removed by the peephole */
+}
+PeepMove;
+
+
+
+
 /*---------------------------------*
  * Global Variables                *
  *---------------------------------*/
@@ -107,6 +131,7 @@ char *file_name_out;
 Bool comment;
 Bool pic_code;
 Bool ignore_fc;
+Bool peephole;
 
 MapperInf mi;
 
@@ -118,12 +143,29 @@ struct map_rbt map_code = MAP_INIT;	/* only filled if pre-pass is activated */
 struct map_rbt map_long = MAP_INIT;
 struct map_rbt map_string = MAP_INIT;
 struct map_rbt map_double = MAP_INIT;	/* only filled used if needed */
+struct map_rbt map_jump = MAP_INIT;	/* only filled if pre-pass is activated */
 
 char *initializer_fct = NULL;
 
 char local_label[64];
 int local_label_count = 0;
 
+	  /* peephole optimizer */
+
+PeepMove peep_move[MAX_PEEP_MOVES];	/* pending run of moves */
+int nb_peep_move = 0;
+char *peep_jump = NULL;			/* pending jump (waits for next label) */
+
+char *peep_label[MAX_PEEP_LABELS];	/* labels waiting for their 1st inst (pre-pass) */
+int nb_peep_label = 0;
+
+int peep_val_key[2 * MAX_PEEP_MOVES];	/* register -> register of its initial value */
+int peep_val_org[2 * MAX_PEEP_MOVES];
+int nb_peep_val;
+
+int peep_dead_key[2 * MAX_PEEP_MOVES];	/* registers overwritten before being read */
+int nb_peep_dead;
+
 
 
 /*---------------------------------*
@@ -136,6 +178,14 @@ DoubleInf *Record_Double(char *ma_str, double dbl_val);
 
 void Switch_Rec(int start, int stop, SwtInf swt[]);
 
+void Peep_Flush_Moves(void);
+
+int Peep_Value(int key);
+
+void Peep_Set_Value(int key, int org);
+
+Bool Peep_Is_Dead(int key, Bool del);
+
 void Switch_Equal(SwtInf *c);
 
 int Switch_Cmp_Int(SwtInf *c1, SwtInf *c2);
@@ -156,6 +206,10 @@ void Display_Help(void);
 
 #define Check_Arg(i, str)      (strncmp(argv[i], str, strlen(argv[i])) == 0)
 
+	  /* a register is encoded as an int key: X(i) as i and Y(i) as -i-1 */
+
+#define Peep_Key(reg, index)   ((reg) == X_REG ? (index) : -(index) - 1)
+
 
 
 
@@ -730,6 +784,353 @@ Switch_Cmp_Int(SwtInf *c1, SwtInf *c2)
 
 
 
+/* The peephole optimizer works on the MA instruction stream before it is
+ * given to the mapper (so it is target independent). It handles:
+ * - runs of consecutive move instructions: moves which do not change the
+ *   destination (e.g. move X(1),X(1) or move X(1),Y(0) + move Y(0),X(1))
+ *   are removed, as are dead stores (destination overwritten later in the
+ *   run before being read). A source is not reloaded if the transfer
+ *   register already contains its value (mappers ensure Move_To_Reg_X/Y
+ *   do not modify the transfer register loaded by Move_From_Reg_X/Y).
+ * - jumps: a jump to a label whose 1st inst is a jump is redirected to the
+ *   final target (also for switch_ret), a jump to the label immediately
+ *   following is removed (needs the pre-pass).
+ * - unreachable code: instructions following an unconditional transfer
+ *   (pl_jump, pl_ret, pl_fail, jump, jump_ret, c_ret) up to the next label
+ *   (or here_cp, code start) are not emitted (see ma_parser.c).
+ */
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PEEP_RECORD_LABEL                                                       *
+ *                                                                         *
+ * Called in the pre-pass for each label definition.                       *
+ *-------------------------------------------------------------------------*/
+void
+Peep_Record_Label(char *label)
+{
+  if (peephole && nb_peep_label < MAX_PEEP_LABELS)
+    peep_label[nb_peep_label++] = strdup(label);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PEEP_RECORD_JUMP                                                        *
+ *                                                                         *
+ * Called in the pre-pass for each jump: the labels just before it are     *
+ * aliases of its target.                                                  *
+ *-------------------------------------------------------------------------*/
+void
+Peep_Record_Jump(char *label)
+{
+  int i;
+
+  for (i = 0; i < nb_peep_label; i++)
+    map_jmp_put(&map_jump, peep_label[i], NULL)->value = strdup(label);
+
+  nb_peep_label = 0;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PEEP_RECORD_OTHER                                                       *
+ *                                                                         *
+ * Called in the pre-pass for any other instruction/declaration.           *
+ *-------------------------------------------------------------------------*/
+void
+Peep_Record_Other(void)
+{
+  int i;
+
+  for (i = 0; i < nb_peep_label; i++)
+    free(peep_label[i]);
+
+  nb_peep_label = 0;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PEEP_JUMP_TARGET                                                        *
+ *                                                                         *
+ * Return the final target of a jump to label (follows chains of jumps).   *
+ *-------------------------------------------------------------------------*/
+char *
+Peep_Jump_Target(char *label)
+{
+  struct map_jmp_entry *entry;
+  int n = MAX_JUMP_CHAIN;	/* also protects against cycles */
+
+  if (peephole)
+    while (n-- && (entry = map_jmp_get(&map_jump, label)) != NULL)
+      label = entry->value;
+
+  return label;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PEEP_MOVE                                                               *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Peep_Move(int src_reg, int src_index, int dst_reg, int dst_index)
+{
+  PeepMove *m;
+
+  if (!peephole)
+    {
+      if (src_reg == X_REG)
+	Move_From_Reg_X(src_index);
+      else
+	Move_From_Reg_Y(src_index);
+
+      if (dst_reg == X_REG)
+	Move_To_Reg_X(dst_index);
+      else
+	Move_To_Reg_Y(dst_index);
+      return;
+    }
+
+  if (nb_peep_move == MAX_PEEP_MOVES)
+    Peep_Flush_Moves();
+
+  m = peep_move + nb_peep_move++;
+  m->src_reg = src_reg;
+  m->src_index = src_index;
+  m->dst_reg = dst_reg;
+  m->dst_index = dst_index;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PEEP_JUMP                                                               *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Peep_Jump(char *label)
+{
+  label = Peep_Jump_Target(label);
+
+  if (!peephole)
+    {
+      Jump(label);
+      return;
+    }
+
+  Peep_Flush();
+  peep_jump = strdup(label);	/* emitted unless the next label is the target */
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PEEP_LABEL                                                              *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Peep_Label(char *label)
+{
+  if (peep_jump && strcmp(peep_jump, label) == 0)
+    {
+      free(peep_jump);
+      peep_jump = NULL;
+    }
+
+  Peep_Flush();
+  Label(label);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PEEP_FLUSH                                                              *
+ *                                                                         *
+ * Emit the pending instructions (called before any other instruction).    *
+ *-------------------------------------------------------------------------*/
+void
+Peep_Flush(void)
+{
+  if (nb_peep_move > 0)
+    Peep_Flush_Moves();
+
+  if (peep_jump)
+    {
+      Jump(peep_jump);
+      free(peep_jump);
+      peep_jump = NULL;
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PEEP_FLUSH_MOVES                                                        *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Peep_Flush_Moves(void)
+{
+  PeepMove *m;
+  PeepMove *end = peep_move + nb_peep_move;
+  int src, dst, org;
+  int tmp_org = 0;
+  Bool tmp_loaded = FALSE;
+
+  /* 1: remove moves which do not change the value of the destination */
+  nb_peep_val = 0;
+  for (m = peep_move; m < end; m++)
+    {
+      src = Peep_Key(m->src_reg, m->src_index);
+      dst = Peep_Key(m->dst_reg, m->dst_index);
+      org = Peep_Value(src);
+      m->keep = (Peep_Value(dst) != org);
+      if (m->keep)
+	Peep_Set_Value(dst, org);
+    }
+
+  /* 2: remove dead stores (backward) */
+  nb_peep_dead = 0;
+  for (m = end - 1; m >= peep_move; m--)
+    {
+      if (!m->keep)
+	continue;
+
+      src = Peep_Key(m->src_reg, m->src_index);
+      dst = Peep_Key(m->dst_reg, m->dst_index);
+      if (Peep_Is_Dead(dst, FALSE))
+	{
+	  m->keep = FALSE;
+	  continue;
+	}
+      peep_dead_key[nb_peep_dead++] = dst;
+      Peep_Is_Dead(src, TRUE);	/* src is read here: no longer dead */
+    }
+
+  /* 3: emit (do not reload the transfer register if useless) */
+  nb_peep_val = 0;
+  for (m = peep_move; m < end; m++)
+    {
+      if (!m->keep)
+	{
+	  if (comment)
+	    Inst_Printf("", "%s peephole: move %c(%d),%c(%d) removed", mi.comment_prefix,
+			(m->src_reg == X_REG) ? 'X' : 'Y', m->src_index,
+			(m->dst_reg == X_REG) ? 'X' : 'Y', m->dst_index);
+	  continue;
+	}
+
+      src = Peep_Key(m->src_reg, m->src_index);
+      dst = Peep_Key(m->dst_reg, m->dst_index);
+      org = Peep_Value(src);
+      if (!tmp_loaded || tmp_org != org)
+	{
+	  if (m->src_reg == X_REG)
+	    Move_From_Reg_X(m->src_index);
+	  else
+	    Move_From_Reg_Y(m->src_index);
+	  tmp_org = org;
+	  tmp_loaded = TRUE;
+	}
+
+      if (m->dst_reg == X_REG)
+	Move_To_Reg_X(m->dst_index);
+      else
+	Move_To_Reg_Y(m->dst_index);
+      Peep_Set_Value(dst, org);
+    }
+
+  nb_peep_move = 0;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PEEP_VALUE                                                              *
+ *                                                                         *
+ * Return the register whose initial (at the beginning of the run) value   *
+ * is currently stored in register key.                                    *
+ *-------------------------------------------------------------------------*/
+int
+Peep_Value(int key)
+{
+  int i;
+
+  for (i = 0; i < nb_peep_val; i++)
+    if (peep_val_key[i] == key)
+      return peep_val_org[i];
+
+  return key;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PEEP_SET_VALUE                                                          *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Peep_Set_Value(int key, int org)
+{
+  int i;
+
+  for (i = 0; i < nb_peep_val; i++)
+    if (peep_val_key[i] == key)
+      break;
+
+  if (i == nb_peep_val)
+    {
+      peep_val_key[i] = key;
+      nb_peep_val++;
+    }
+
+  peep_val_org[i] = org;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PEEP_IS_DEAD                                                            *
+ *                                                                         *
+ * Is register key overwritten later (before being read) ?                 *
+ * If del is TRUE, the register is removed from this set.                  *
+ *-------------------------------------------------------------------------*/
+Bool
+Peep_Is_Dead(int key, Bool del)
+{
+  int i;
+
+  for (i = 0; i < nb_peep_dead; i++)
+    if (peep_dead_key[i] == key)
+      {
+	if (del)
+	  peep_dead_key[i] = peep_dead_key[--nb_peep_dead];
+	return TRUE;
+      }
+
+  return FALSE;
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * LABEL_GEN_INIT                                                          *
  *                                                                         *
@@ -896,6 +1297,7 @@ Parse_Arguments(int argc, char *argv[])
   comment = FALSE;
   pic_code = FALSE;
   ignore_fc = FALSE;
+  peephole = TRUE;
 
   for (i = 1; i < argc; i++)
     {
@@ -934,6 +1336,12 @@ Parse_Arguments(int argc, char *argv[])
 	      continue;
 	    }
 
+	  if (Check_Arg(i, "--no-peephole"))
+	    {
+	      peephole = FALSE;
+	      continue;
+	    }
+
 	  if (Check_Arg(i, "--version"))
 	    {
 	      Display_Copying("Mini-Assembly to Assembly Compiler");
@@ -995,6 +1403,7 @@ Display_Help(void)
   L("  --pic, -fPIC, --dynamic     produce position independent code (PIC)");
   L("  --ignore-fast               ignore fast call (FC) declarations");
   L("  --comment                   include comments in the output file");
+  L("  --no-peephole               do not apply the peephole optimizer");
   L("  -h, --help                  print this help and exit");
   L("  --version                   print version number and exit");
   L("");
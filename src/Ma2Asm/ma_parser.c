@@ -193,7 +193,7 @@ Bool
 Parse_Ma_File(char *file_name_in, int comment)
 {
   int ret_val;
-  int i, nb_passes = mi.needs_pre_pass + 1; /* pre-pass is to discover all defined symbols */
+  int i, nb_passes;
 
 
   if (file_name_in == NULL)
@@ -207,6 +207,10 @@ Parse_Ma_File(char *file_name_in, int comment)
       return FALSE;
     }
 
+  /* pre-pass is to discover all defined symbols (also used by the peephole
+   * to find jumps to jumps, only if the input can be read twice) */
+  nb_passes = (mi.needs_pre_pass || (peephole && file_in != stdin)) + 1;
+
   for(i = 1; i <= nb_passes; i++)
     {
       if (i == 2)
@@ -248,6 +252,7 @@ Parse_Ma_File(char *file_name_in, int comment)
 {						\
   if (!Pre_Pass() && inside_code)		\
     {						\
+      Peep_Flush();				\
       Code_Stop(&cur_code);			\
       inside_code = FALSE;			\
     }						\
@@ -259,10 +264,11 @@ Parser(int pass_no, int nb_passes)
 {
   Bool inside_code = FALSE;
   Bool initializer_defined = FALSE;
+  Bool unreachable = FALSE;	/* only set if the peephole is activated */
   CodeInf cur_code;
   LongInf l;
   char **in;
-  int k, i;
+  int k, i, k1, i1;
 
   if (Pre_Pass())
     keep_source_lines = FALSE;
@@ -291,6 +297,15 @@ Parser(int pass_no, int nb_passes)
       cur_approx_inst_line++; /* count 1 for each MA inst (could be more precise, e.g. 0 for label, ...) */
       if (Pre_Pass())
 	{			/* special case in in pre-pass */
+	  if (k == JUMP)
+	    {
+	      Read_Token(IDENTIFIER);
+	      Peep_Record_Jump(str_val);
+	      goto ignore_eol;
+	    }
+	  if (k != LABEL)
+	    Peep_Record_Other();
+
 	  if (k != PL_CODE && k != C_CODE && k != LONG && k != SWITCH_RET && k != LABEL)
 	    {
 	    ignore_eol:
@@ -298,10 +313,18 @@ Parser(int pass_no, int nb_passes)
 	      continue;
 	    }
 	}
-      else if (pass_no > 1)		/* special case in second pass */
+      else
 	{
-	  if (k == LONG)		/* ignore long decl (treated in pre-pass)  */
+	  if (pass_no > 1 && k == LONG)	/* ignore long decl (treated in pre-pass)  */
 	    goto ignore_eol;
+
+	  if (k == PL_CODE || k == C_CODE || k == LONG || k == LABEL || k == HERE_CP)
+	    unreachable = FALSE;
+	  else if (unreachable && k != SWITCH_RET) /* dead code: not emitted */
+	    goto ignore_eol;
+
+	  if (k != MOVE && k != JUMP && k != LABEL)
+	    Peep_Flush();
 	}
 
       switch (k)
@@ -351,6 +374,7 @@ Parser(int pass_no, int nb_passes)
 	  Read_Token(IDENTIFIER);
 	  Pl_Jump(str_val);
 	  reload_e = TRUE;
+	  unreachable = peephole;
 	  break;
 
 	case PREP_CP:
@@ -370,35 +394,29 @@ Parser(int pass_no, int nb_passes)
 	case PL_FAIL:
 	  Pl_Fail(TRUE);
 	  reload_e = TRUE;
+	  unreachable = peephole;
 	  break;
 
 	case PL_RET:
 	  Pl_Ret();
 	  reload_e = TRUE;
+	  unreachable = peephole;
 	  break;
 
 	case JUMP:
 	  Read_Token(IDENTIFIER);
-	  Jump(str_val);
+	  Peep_Jump(str_val);
 	  reload_e = TRUE;
+	  unreachable = peephole;
 	  break;
 
 	case MOVE:
 	  k = Read_Token(X_REG);
 	  i = Read_Index();
-	  if (k == X_REG)
-	    Move_From_Reg_X(i);
-	  else
-	    Move_From_Reg_Y(i);
-
 	  Read_Token(',');
-
-	  k = Read_Token(X_REG);
-	  i = Read_Index();
-	  if (k == X_REG)
-	    Move_To_Reg_X(i);
-	  else
-	    Move_To_Reg_Y(i);
+	  k1 = Read_Token(X_REG);
+	  i1 = Read_Index();
+	  Peep_Move(k, i, k1, i1);
 	  break;
 
 	case CALL_C:
@@ -409,6 +427,7 @@ Parser(int pass_no, int nb_passes)
 	case JUMP_RET:
 	  Jump_Ret();
 	  reload_e = TRUE;
+	  unreachable = peephole;
 	  break;
 
 	case FAIL_RET:
@@ -448,12 +467,17 @@ Parser(int pass_no, int nb_passes)
 	case SWITCH_RET:
 	  Read_Switch();
 	  if (!Pre_Pass())
-	    Switch_Ret(nb_swt, swt);
+	    {
+	      for (i = 0; i < nb_swt; i++)
+		swt[i].label = Peep_Jump_Target(swt[i].label);
+	      Switch_Ret(nb_swt, swt);
+	    }
 	  cur_approx_inst_line += nb_swt;/* count separately each pair (value=label) */
 	  break;
 
 	case C_RET:
 	  C_Ret();
+	  unreachable = peephole;
 	  break;
 
 	case LONG:
@@ -489,9 +513,12 @@ Parser(int pass_no, int nb_passes)
 	case LABEL:		/* label: */
 	  Read_Token(':');
 	  if (Pre_Pass())
-	    Decl_Label(str_val, cur_approx_inst_line); /* record label */
+	    {
+	      Decl_Label(str_val, cur_approx_inst_line); /* record label */
+	      Peep_Record_Label(str_val);
+	    }
 	  else
-	    Label(str_val);
+	    Peep_Label(str_val);
 	  break;
 
 	default:		/* should never occurs */
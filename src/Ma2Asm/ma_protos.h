@@ -178,6 +178,7 @@ extern int nb_appox_inst_line;	 /* total (at end of first pass) */
 
 extern Bool comment;
 extern Bool pic_code;
+extern Bool peephole;
 extern MapperInf mi;
 extern LabelGen lg_cont;	/* used by macros Label_Cont_XXX() below */
 
@@ -207,6 +208,22 @@ void Call_C(char *fct_name, Bool fc, int nb_args, int nb_args_in_words, ArgInf a
 
 void Switch_Ret(int nb_swt, SwtInf swt[]);
 
+void Peep_Record_Label(char *label);
+
+void Peep_Record_Jump(char *label);
+
+void Peep_Record_Other(void);
+
+char *Peep_Jump_Target(char *label);
+
+void Peep_Move(int src_reg, int src_index, int dst_reg, int dst_index);
+
+void Peep_Jump(char *label);
+
+void Peep_Label(char *label);
+
+void Peep_Flush(void);
+
 
 
 
@@ -252,6 +269,9 @@ void Int_Out(int d);
 
 	  /* defined in each mappers used by parser and ma2asm */
 
+	  /* NB: Move_To_Reg_X/Y must not modify the transfer register loaded
+	   * by Move_From_Reg_X/Y (the peephole optimizer relies on this). */
+
 void Init_Mapper(void);
 
 void Asm_Start(void);
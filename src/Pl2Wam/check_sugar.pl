@@ -0,0 +1,83 @@
+/*-------------------------------------------------------------------------*
+ * GNU Prolog                                                              *
+ *                                                                         *
+ * Part  : Prolog to WAM compiler                                          *
+ * File  : check_sugar.pl                                                  *
+ * Descr.: regression checks (run by make check)                           *
+ *                                                                         *
+ * Copyright (C) 1999-2023 Daniel Diaz                                     *
+ *                                                                         *
+ * This file is part of GNU Prolog                                         *
+ *                                                                         *
+ * GNU Prolog is free software: you can redistribute it and/or             *
+ * modify it under the terms of either:                                    *
+ *                                                                         *
+ *   - the GNU Lesser General Public License as published by the Free      *
+ *     Software Foundation; either version 3 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or                                                                      *
+ *                                                                         *
+ *   - the GNU General Public License as published by the Free             *
+ *     Software Foundation; either version 2 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or both in parallel, as here.                                           *
+ *                                                                         *
+ * GNU Prolog is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ * General Public License for more details.                                *
+ *                                                                         *
+ * You should have received copies of the GNU General Public License and   *
+ * the GNU Lesser General Public License along with this program.  If      *
+ * not, see http://www.gnu.org/licenses/.                                  *
+ *-------------------------------------------------------------------------*/
+
+/* Each check/1 clause must succeed (once). The program must also link:
+ * rewritings must not introduce direct calls to undefined predicates.
+ */
+
+:-	initialization(main).
+
+
+
+
+main :-
+	findall(Name, (clause(check(Name), _), \+ run(Name)), Failed),
+	(   Failed = [] ->
+	    halt
+	;   write('pl2wam checks failed: '),
+	    write(Failed),
+	    nl,
+	    halt(1)
+	).
+
+
+run(Name) :-
+	catch(check(Name), E, (write(Name = E), nl, fail)), !.
+
+
+
+
+:-	dynamic(check/1).
+
+	% maplist/N with a closure known at compile-time (see syn_sugar.pl)
+
+double(X, Y) :-
+	Y is X * 2.
+
+maplist_defined(L1, L2) :-
+	maplist(double, L1, L2).
+
+maplist_undefined :-
+	maplist(undefined_q, [1]).
+
+check(maplist_bip) :-
+	maplist(succ, [1, 2], [2, 3]).
+
+check(maplist_defined) :-
+	maplist_defined([1, 2], [2, 4]).
+
+check(maplist_undefined) :-
+	catch(maplist_undefined, error(existence_error(procedure, undefined_q / 1), _), true).
@@ -39,9 +39,185 @@
 code_generation(Head, Body, NbChunk, NbY, WamHead) :-
 	g_assign(last_pred, f),
 	g_assign(treat_body, f),
+	infer_int_types(Head, Body, Body1),
 	generate_head(Head, NbChunk, NbY, WamBody, WamHead),
 	g_assign(treat_body, t),
-	generate_body(Body, NbChunk, WamBody).
+	generate_body(Body1, NbChunk, WamBody).
+
+
+
+
+	% Integer type inference: a (forward) analysis of the body to detect
+	% the variables which are bound to an integer. Sources of information:
+	%    - +integer arguments of the head (from a mode/1 declaration)
+	%    - X is E (if E only involves integers and integer operations)
+	%    - integer(X), X = N (N integer)
+	%    - -integer arguments of a called predicate (mode/1 declaration)
+	% Once known, an integer remains an integer (the body is a conjunction).
+	% In arithmetic inlines, each maximal sub-expression only involving
+	% integers is wrapped as fast(E) and compiled as in --fast-math mode
+	% (the fast functions are the integer cases of the general ones).
+	% Known variables are recorded as var(VarName, Info) terms (compared
+	% with ==, as they are shared by all occurrences of a variable).
+
+infer_int_types(_, Body, Body) :-
+	g_read(fast_math, t), !.
+
+infer_int_types(p(_, _, Pred / N, LArg), Body, Body1) :-
+	(   clause(pred_mode(Pred, N, LMode), true) ->
+	    mode_int_vars(LArg, LMode, +, [], LIntVar)
+	;   LIntVar = []
+	),
+	infer_int_body(Body, LIntVar, Body1).
+
+
+
+
+mode_int_vars([], [], _, LIntVar, LIntVar).
+
+mode_int_vars([Arg|LArg], [Mode|LMode], Dir, LIntVar, LIntVar2) :-
+	(   Mode = Dir - integer,
+	    Arg = var(_, _) ->
+	    LIntVar1 = [Arg|LIntVar]
+	;   LIntVar1 = LIntVar
+	),
+	mode_int_vars(LArg, LMode, Dir, LIntVar1, LIntVar2).
+
+
+
+
+infer_int_body([], _, []).
+
+infer_int_body([p(NoPred, Module, Pred / N, LArg)|Body], LIntVar, [p(NoPred, Module, Pred / N, LArg1)|Body1]) :-
+	infer_int_pred(Pred, N, LArg, LIntVar, LArg1, LIntVar1),
+	infer_int_body(Body, LIntVar1, Body1).
+
+
+
+
+infer_int_pred(is, 2, [Arg1, Exp], LIntVar, [Arg1, Exp1], LIntVar1) :-
+	inline_predicate(is, 2), !,
+	infer_int_math_exp(Exp, LIntVar, Exp1, IsInt),
+	(   IsInt = t,
+	    Arg1 = var(_, _) ->
+	    LIntVar1 = [Arg1|LIntVar]
+	;   LIntVar1 = LIntVar
+	).
+
+infer_int_pred(F, 2, [Exp1, Exp2], LIntVar, [Exp3, Exp4], LIntVar) :-
+	math_cmp_functor_name(F, _),
+	inline_predicate(F, 2), !,
+	infer_int_math_exp(Exp1, LIntVar, Exp5, IsInt1),
+	infer_int_math_exp(Exp2, LIntVar, Exp6, IsInt2),
+	(   IsInt1 = t,		% fast(_) also on integers for a fast comparison
+	    IsInt2 = t ->
+	    wrap_fast(Exp5, Exp3),
+	    wrap_fast(Exp6, Exp4)
+	;   Exp3 = Exp5,
+	    Exp4 = Exp6
+	).
+
+infer_int_pred(integer, 1, [Arg], LIntVar, [Arg], [Arg|LIntVar]) :-
+	Arg = var(_, _), !.
+
+infer_int_pred(=, 2, [Arg1, Arg2], LIntVar, [Arg1, Arg2], [Var|LIntVar]) :-
+	(   Arg1 = var(_, _),
+	    Arg2 = int(_),
+	    Var = Arg1
+	;   Arg2 = var(_, _),
+	    Arg1 = int(_),
+	    Var = Arg2
+	), !.
+
+infer_int_pred(Pred, N, LArg, LIntVar, LArg, LIntVar1) :-
+	clause(pred_mode(Pred, N, LMode), true), !,
+	mode_int_vars(LArg, LMode, -, LIntVar, LIntVar1).
+
+infer_int_pred(_, _, LArg, LIntVar, LArg, LIntVar).
+
+
+
+
+infer_int_math_exp(Exp, LIntVar, Exp1, IsInt) :-
+	infer_int_exp(Exp, LIntVar, Exp2, IsInt),
+	wrap_int_exp(IsInt, Exp2, Exp1).
+
+
+
+
+infer_int_exp(var(VarName, Info), LIntVar, var(VarName, Info), IsInt) :-
+	!,
+	(   is_int_var(LIntVar, var(VarName, Info)) ->
+	    IsInt = t
+	;   IsInt = f
+	).
+
+infer_int_exp(int(N), _, int(N), t) :-
+	!.
+
+infer_int_exp(stc('.', 2, [Arg, nil]), LIntVar, stc('.', 2, [Arg1, nil]), IsInt) :-
+	!,
+	infer_int_exp(Arg, LIntVar, Arg1, IsInt).
+
+infer_int_exp(stc(+, 1, [Arg]), LIntVar, stc(+, 1, [Arg1]), IsInt) :-
+	!,
+	infer_int_exp(Arg, LIntVar, Arg1, IsInt).
+
+infer_int_exp(stc(F, N, LArg), LIntVar, stc(F, N, LArg1), IsInt) :-
+	!,
+	infer_int_exp_lst(LArg, LIntVar, LArg2, LIsInt),
+	(   fast_exp_functor_name(F, N, _),
+	    \+ memberchk(f, LIsInt) ->
+	    IsInt = t,
+	    LArg1 = LArg2
+	;   IsInt = f,
+	    wrap_int_exp_lst(LIsInt, LArg2, LArg1)
+	).
+
+infer_int_exp(Exp, _, Exp, f).
+
+
+
+
+infer_int_exp_lst([], _, [], []).
+
+infer_int_exp_lst([Arg|LArg], LIntVar, [Arg1|LArg1], [IsInt|LIsInt]) :-
+	infer_int_exp(Arg, LIntVar, Arg1, IsInt),
+	infer_int_exp_lst(LArg, LIntVar, LArg1, LIsInt).
+
+
+
+
+wrap_int_exp_lst([], [], []).
+
+wrap_int_exp_lst([IsInt|LIsInt], [Arg|LArg], [Arg1|LArg1]) :-
+	wrap_int_exp(IsInt, Arg, Arg1),
+	wrap_int_exp_lst(LIsInt, LArg, LArg1).
+
+
+
+
+wrap_int_exp(t, Exp, fast(Exp)) :-
+	Exp \= int(_), !.
+
+wrap_int_exp(_, Exp, Exp).
+
+
+
+
+wrap_fast(fast(Exp), fast(Exp)) :-
+	!.
+
+wrap_fast(Exp, fast(Exp)).
+
+
+
+
+is_int_var([Var1|_], Var) :-
+	Var1 == Var, !.
+
+is_int_var([_|LIntVar], Var) :-
+	is_int_var(LIntVar, Var).
 
 
 
@@ -598,74 +774,136 @@ gen_inline_pred(is, 2, [var(VN1, Info1), stc(+, 2, [var(VN2, Info2), int(1)])],
 	WamMath = [call_c('Math_X_Is_Inc_Y', [fast], [&,VN1, VN2])|WamNext].
 */
 gen_inline_pred(is, 2, [Arg1, Arg2], WamNext, WamMath) :-
-	load_math_expr(Arg2, Reg, WamUnif, WamMath), !,
+	load_math_expr(Arg2, Reg, WamBox, WamMath), !,
+	(   math_expr_can_be_tmp_float(Arg2) ->
+	    WamBox = [call_c('Pl_Math_Box_Float', [fast_call, x(Reg)], [x(Reg)])|WamUnif]
+	;
+	    WamBox = WamUnif
+	),
 	gen_unif_arg(Arg1, Reg, WamNext, WamUnif).
 
 
 
-load_math_expr(var(VarName, Info), Reg, WamNext, WamMath) :-
+
+	% intermediate floats are not stored in the heap (see arith_inl_c.c)
+	% if the result of is/2 can be such a float it must be boxed.
+
+math_expr_can_be_tmp_float(_) :-
+	g_read(fast_math, t), !,
+	fail.
+
+math_expr_can_be_tmp_float(var(_, _)).
+
+math_expr_can_be_tmp_float(atm(_)).
+
+math_expr_can_be_tmp_float(stc('.', 2, [Arg, nil])) :-
+	!,
+	math_expr_can_be_tmp_float(Arg).
+
+math_expr_can_be_tmp_float(stc(+, 1, [Arg])) :-
+	!,
+	math_expr_can_be_tmp_float(Arg).
+
+math_expr_can_be_tmp_float(stc(F, N, _)) :-
+	\+ math_exp_int_result(F, N).
+
+
+
+
+math_exp_int_result(//, 2).
+math_exp_int_result(div, 2).
+math_exp_int_result(rem, 2).
+math_exp_int_result(mod, 2).
+math_exp_int_result(/\, 2).
+math_exp_int_result(\/, 2).
+math_exp_int_result(xor, 2).
+math_exp_int_result(\, 1).
+math_exp_int_result(<<, 2).
+math_exp_int_result(>>, 2).
+math_exp_int_result(lsb, 1).
+math_exp_int_result(msb, 1).
+math_exp_int_result(popcount, 1).
+math_exp_int_result(gcd, 2).
+math_exp_int_result(ceiling, 1).
+math_exp_int_result(floor, 1).
+math_exp_int_result(round, 1).
+math_exp_int_result(truncate, 1).
+
+
+
+load_math_expr(Arg, Reg, WamNext, WamMath) :-
+	g_read(fast_math, Fast),
+	load_math_expr(Arg, Fast, Reg, WamNext, WamMath).
+
+
+	% Fast = t if integer only expression (--fast-math or fast(E) markers)
+
+load_math_expr(fast(Arg), _, Reg, WamNext, WamMath) :-
+	load_math_expr(Arg, t, Reg, WamNext, WamMath).
+
+load_math_expr(var(VarName, Info), Fast, Reg, WamNext, WamMath) :-
 	(   var(Info) ->
 	    error('unbound variable in arithmetic expression', [])
 	;   true
 	),
-	(   g_read(fast_math, t) ->
+	(   Fast = t ->
 	    WamMath = [math_fast_load_value(VarName, Reg)|WamNext]
 	;
 	    WamMath = [math_load_value(VarName, Reg)|WamNext]
 	).
 
-load_math_expr(int(N), Reg, WamNext, WamMath) :-
+load_math_expr(int(N), _, Reg, WamNext, WamMath) :-
 	gen_load_arg(int(N), Reg, WamNext, WamMath).
 
-load_math_expr(flt(N), Reg, WamNext, WamMath) :-
+load_math_expr(flt(N), _, Reg, WamNext, WamMath) :-
 	gen_load_arg(flt(N), Reg, WamNext, WamMath).
 
-load_math_expr(stc(F, N, LArg), Reg, WamNext, WamMath) :-
-	load_math_expr1(F, N, LArg, Reg, WamNext, WamMath).
+load_math_expr(stc(F, N, LArg), Fast, Reg, WamNext, WamMath) :-
+	load_math_expr1(F, N, LArg, Fast, Reg, WamNext, WamMath).
 
-load_math_expr(atm(F), Reg, WamNext, WamMath) :-
-	load_math_expr1(F, 0, [], Reg, WamNext, WamMath).
+load_math_expr(atm(F), Fast, Reg, WamNext, WamMath) :-
+	load_math_expr1(F, 0, [], Fast, Reg, WamNext, WamMath).
 
-load_math_expr(X, _, _, _) :-
+load_math_expr(X, _, _, _, _) :-
 	error('unknown expression in arithmetic expression (~q)', [X]).
 
 
-load_math_expr1('.', 2, [Arg, nil], Reg, WamNext, WamMath) :-
-	load_math_expr(Arg, Reg, WamNext, WamMath).
+load_math_expr1('.', 2, [Arg, nil], Fast, Reg, WamNext, WamMath) :-
+	load_math_expr(Arg, Fast, Reg, WamNext, WamMath).
 
-load_math_expr1(+, 1, [Arg], Reg, WamNext, WamMath) :-
-	load_math_expr(Arg, Reg, WamNext, WamMath).
+load_math_expr1(+, 1, [Arg], Fast, Reg, WamNext, WamMath) :-
+	load_math_expr(Arg, Fast, Reg, WamNext, WamMath).
 
-load_math_expr1(+, 2, [Arg1, int(1)], Reg, WamNext, WamMath) :-
-	load_math_expr1(inc, 1, [Arg1], Reg, WamNext, WamMath).
+load_math_expr1(+, 2, [Arg1, int(1)], Fast, Reg, WamNext, WamMath) :-
+	load_math_expr1(inc, 1, [Arg1], Fast, Reg, WamNext, WamMath).
 
-load_math_expr1(-, 2, [Arg1, int(1)], Reg, WamNext, WamMath) :-
-	load_math_expr1(dec, 1, [Arg1], Reg, WamNext, WamMath).
+load_math_expr1(-, 2, [Arg1, int(1)], Fast, Reg, WamNext, WamMath) :-
+	load_math_expr1(dec, 1, [Arg1], Fast, Reg, WamNext, WamMath).
 
-load_math_expr1(F, N, LArg, Reg, WamNext, WamMath) :-
-	(   g_read(fast_math, t) ->
+load_math_expr1(F, N, LArg, Fast, Reg, WamNext, WamMath) :-
+	(   Fast = t ->
 	    fast_exp_functor_name(F, N, Name)
 	;
 	    math_exp_functor_name(F, N, Name)
 	),
-	load_math_arg_lst(LArg, LValue, WamInst, WamMath),
+	load_math_arg_lst(LArg, Fast, LValue, WamInst, WamMath),
 	WamInst = [call_c(Name, [fast_call,x(Reg)], LValue)|WamNext].
 
-load_math_expr1(F, N, _, _, _, _) :-
+load_math_expr1(F, N, _, _, _, _, _) :-
 	math_exp_functor_name(F, N, _),
 	error('arithmetic operation not allowed in fast math (~q)', [F / N]).
 
-load_math_expr1(F, N, _, _, _, _) :-
+load_math_expr1(F, N, _, _, _, _, _) :-
 	error('unknown operation in arithmetic expression (~q)', [F / N]).
 
 
 
 
-load_math_arg_lst([], [], WamNext, WamNext).
+load_math_arg_lst([], _, [], WamNext, WamNext).
 
-load_math_arg_lst([Arg|LArg], [x(Reg)|LReg], WamNext, WamMath) :-
-	load_math_expr(Arg, Reg, WamLArg, WamMath),
-	load_math_arg_lst(LArg, LReg, WamNext, WamLArg).
+load_math_arg_lst([Arg|LArg], Fast, [x(Reg)|LReg], WamNext, WamMath) :-
+	load_math_expr(Arg, Fast, Reg, WamLArg, WamMath),
+	load_math_arg_lst(LArg, Fast, LReg, WamNext, WamLArg).
 
 
 
@@ -755,12 +993,15 @@ math_exp_functor_name(float_integer_part, 1, 'Pl_Fct_Float_Integ_Part').
 
 
 gen_inline_pred(F, 2, LArg, WamNext, WamMath) :-
-	(   g_read(fast_math, t) ->
+	g_read(fast_math, Fast),
+	(   (   Fast = t
+	    ;   LArg = [fast(_), fast(_)]
+	    ) ->
 	    fast_cmp_functor_name(F, Name)
 	;
 	    math_cmp_functor_name(F, Name)
 	),
-	load_math_arg_lst(LArg, LValue, WamInst, WamMath),
+	load_math_arg_lst(LArg, Fast, LValue, WamInst, WamMath),
 	WamInst = [call_c(Name, [fast_call, boolean], LValue)|WamNext].
 
 
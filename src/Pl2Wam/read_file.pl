@@ -101,6 +101,10 @@
  * meta_pred(Pred,N,MetaDecl):                                             *
  *    asserted for each meta_predicate declaration.                        *
  *                                                                         *
+ * pred_mode(Pred,N,LMode):                                                *
+ *    asserted for each mode declaration. LMode is a list of Dir-Type      *
+ *    (Dir is +, - or ?, Type is integer, atom, atomic, list or any).      *
+ *                                                                         *
  * Buffers for executable directive management (with assert/retract):      *
  *                                                                         *
  * buff_exe_system(SrcDirec)                                               *
@@ -147,6 +151,7 @@ read_file_init :-
 	retractall(pred_info(_, _, _)),
 	retractall(module_export(_, _, _)),
 	retractall(meta_pred(_, _, _)),
+	retractall(pred_mode(_, _, _)),
 	g_assign(module, user),
 	g_assign(module_already_seen, f),
 	g_assign(default_kind, user),
@@ -796,6 +801,10 @@ handle_directive(meta_predicate, [MetaDecl], Where) :-
 	    error('invalide directive meta_predicate/1 ~q', [MetaDecl])
 	).
 
+handle_directive(mode, DLst, _) :-
+	!,
+	add_pred_mode_lst(DLst).
+
 handle_directive(foreign, [Template], Where) :-
 	!,
 	handle_directive(foreign, [Template, []], Where).
@@ -1055,6 +1064,71 @@ add_module_export_info(Pred / N, Module) :-
 
 
 
+add_pred_mode_lst([]) :-
+	!.
+
+add_pred_mode_lst([D1|D2]) :-
+	!,
+	add_pred_mode_lst(D1),
+	add_pred_mode_lst(D2).
+
+add_pred_mode_lst((D1, D2)) :-
+	!,
+	add_pred_mode_lst(D1),
+	add_pred_mode_lst(D2).
+
+add_pred_mode_lst(ModeDecl) :-
+	callable(ModeDecl),
+	ModeDecl =.. [Pred|LSpec],
+	mode_spec_lst(LSpec, LMode), !,
+	length(LMode, N),
+	retractall(pred_mode(Pred, N, _)),
+	assertz(pred_mode(Pred, N, LMode)).
+
+add_pred_mode_lst(ModeDecl) :-
+	error('invalid mode declaration ~q', [ModeDecl]).
+
+
+
+
+mode_spec_lst([], []).
+
+mode_spec_lst([Spec|LSpec], [Mode|LMode]) :-
+	nonvar(Spec),
+	mode_spec(Spec, Mode),
+	mode_spec_lst(LSpec, LMode).
+
+
+
+
+mode_spec(Dir, Dir - any) :-
+	mode_dir(Dir), !.
+
+mode_spec(Spec, Dir - Type) :-
+	Spec =.. [Dir, Type],
+	mode_dir(Dir),
+	atom(Type),
+	mode_type(Type), !.
+
+
+
+
+mode_dir(+).
+mode_dir(-).
+mode_dir(?).
+
+
+
+
+mode_type(integer).
+mode_type(atom).
+mode_type(atomic).
+mode_type(list).
+mode_type(any).
+
+
+
+
 	% check_pi_list(DLst, EmptyOK)
 check_pi_list(DLst, _) :-
 	var(DLst), !,
@@ -414,6 +414,56 @@ pred_rewriting(term_hash(Term, Depth, Range, Hash), Pred1) :-
 	pred_rewriting('$call_c'('Pl_Un_Integer_Check'(Hash1, Hash), [boolean, by_value]), T2),
 	Pred1 = (T, T2).
 
+	/* maplist/N with a closure known at compile-time: a specialized
+	 * auxiliary predicate is generated to avoid a call/N (and thus a
+	 * predicate lookup) for each element. E.g. maplist(succ, L1, L2)
+	 * gives rise to:
+	 *
+	 *   'p/n_$auxK'([], []).
+	 *   'p/n_$auxK'([X1|L1], [X2|L2]) :-
+	 *           succ(X1, X2),
+	 *           'p/n_$auxK'(L1, L2).
+	 *
+	 * The variables of the closure are passed as additional arguments.
+	 * Only done if maplist/N is the built-in (cannot be redefined) and
+	 * if the closure names a built-in or a (static) predicate already
+	 * defined in the file: the direct call must not create a link
+	 * dependency (the closure can be undefined or defined at run-time,
+	 * in which case call/N raises the error at run-time).
+	 */
+
+pred_rewriting(Pred, AuxPred) :-
+	g_read(inline, t),      % also if byte code since implies --no-inline
+	g_read(redef_error, t),
+	functor(Pred, maplist, N),
+	N >= 2,
+	bip(maplist, N),
+	Pred =.. [_, Closure|LLst],
+	NbLst is N - 1,
+	length(LX, NbLst),
+	maplist_closure_goal(Closure, LX, Goal), !,
+	lst_var(Closure, [], V),
+	length(V, NbV),
+	AuxN is NbLst + NbV,
+	g_read(head_functor, Pred0),
+	g_read(head_arity, N0),
+	init_aux_pred_name(Pred0, N0, AuxName, AuxN),
+	append(LLst, V, LArg),
+	AuxPred =.. [AuxName|LArg],
+	length(LNil, NbLst),
+	maplist_aux_lists(LNil, LX, LT, LCons),
+	length(V1, NbV),
+	append(LNil, V1, LArg1),
+	Head1 =.. [AuxName|LArg1],
+	append(LCons, V, LArg2),
+	Head2 =.. [AuxName|LArg2],
+	append(LT, V, LArg3),
+	Rec =.. [AuxName|LArg3],
+	g_read(where, Where),
+	copy_term(Head1, AuxCl1),
+	copy_term((Head2 :- Goal, Rec), AuxCl2),
+	asserta(buff_aux_pred(AuxName, AuxN, [Where + AuxCl1, Where + AuxCl2])).
+
 	/* The user should use: '$call_c'(F) or '$call_c'(F, LCOpt)
 	 * LCOpt is a list possibly containing:
 	 *   a Ret: either void, jump, boolean or ret(RetVar)
@@ -448,6 +498,48 @@ pred_rewriting(P, P).
 
 
 
+maplist_closure_goal(Closure, LX, Goal) :-
+	nonvar(Closure),
+	callable(Closure),
+	Closure =.. [F|LA],
+	append(LA, LX, LA1),
+	Goal =.. [F|LA1],
+	functor(Goal, F, N),
+	\+ control_construct(F, N),
+	\+ maplist_closure_excluded(F),
+	maplist_closure_defined(F, N).
+
+
+maplist_closure_excluded(call).
+maplist_closure_excluded(:).
+maplist_closure_excluded(*->).
+maplist_closure_excluded(fd_tell).
+maplist_closure_excluded('$call_c').
+maplist_closure_excluded('$call_c_test').
+maplist_closure_excluded('$call_c_jump').
+
+
+
+
+maplist_closure_defined(F, N) :-
+	bip(F, N), !.
+
+maplist_closure_defined(F, N) :-
+	test_pred_flag(def, F, N),
+	test_not_pred_flag(dyn, F, N),
+	test_not_pred_flag(multi, F, N).
+
+
+
+
+maplist_aux_lists([], [], [], []).
+
+maplist_aux_lists([[]|LNil], [X|LX], [T|LT], [[X|T]|LCons]) :-
+	maplist_aux_lists(LNil, LX, LT, LCons).
+
+
+
+
 test_c_call_allowed(_) :-
 	g_read(call_c, t), !.
 
@@ -1102,6 +1102,12 @@ Parse_Arguments(int argc, char *argv[])
 	      continue;
 	    }
 
+	  if (Check_Arg(i, "--no-peephole"))
+	    {
+	      Add_Last_Option(cmd_ma2asm.opt);
+	      continue;
+	    }
+
 	  if (Check_Arg(i, "--temp-dir"))
 	    {
 	      if (++i >= argc)
@@ -1533,6 +1539,7 @@ Display_Help(void)
   L("Mini-assembly to assembly translator options:");
   L("  --comment                   include comments in the output file");
   L("  --pic, -fPIC, --dynamic     produce position independent code (PIC)");
+  L("  --no-peephole               do not apply the peephole optimizer");
   L(" ");
   L("C Compiler options:");
   L("  --c-compiler FILE           use FILE as C compiler/linker");